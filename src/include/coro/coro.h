@@ -39,6 +39,9 @@ namespace futils {
             static void coro_sub(C*);
 
             bool construct_platform(size_t max_running, size_t max_idle, Resource res);
+            bool construct_platform_mt(size_t n_thread, size_t max_running, size_t max_idle, Resource res);
+            // per worker thread context slot if this runs on M:N scheduler worker. otherwise nullptr
+            void** thread_context_slot() const;
             void destruct_platform();
             void suspend_platform();
             bool run_platform();
@@ -52,6 +55,8 @@ namespace futils {
             }
 
             friend C make_coro(size_t max_concurrent, size_t max_idle, Resource res);
+            friend C make_coro_mt(size_t n_thread, size_t max_concurrent, size_t max_idle, Resource res);
+            friend struct MultiThreadScheduler;
 
             constexpr void exchange(C & in) {
                 user = std::exchange(in.user, nullptr);
@@ -70,7 +75,11 @@ namespace futils {
 
             void* set_thread_context(void* v) {
                 void* prev = nullptr;
-                if (is_main()) {
+                if (auto slot = thread_context_slot()) {
+                    prev = get_thread_context();
+                    *slot = v;
+                }
+                else if (is_main()) {
                     prev = user;
                     user = v;
                 }
@@ -82,6 +91,9 @@ namespace futils {
             }
 
             void* get_thread_context() const {
+                if (auto slot = thread_context_slot(); slot && *slot) {
+                    return *slot;
+                }
                 if (is_main()) {
                     return user;
                 }
@@ -139,6 +151,20 @@ namespace futils {
             return c;
         }
 
+        // M:N scheduler. coroutines run on n_thread worker threads (0 means hardware concurrency)
+        // each worker has own run queue of max_running + max_idle and idle workers steal from others
+        // run() waits progress of workers and returns false when no coroutine remains
+        // set_thread_context called on worker sets context of that worker
+        // (context set from non-worker thread is used by workers which have not set their own)
+        // coroutine may resume on other worker after suspend
+        inline C make_coro_mt(size_t n_thread, size_t max_running = 10, size_t max_idle = 10, Resource res = {}) {
+            C c;
+            if (!c.construct_platform_mt(n_thread, max_running, max_idle, res)) {
+                return {};
+            }
+            return c;
+        }
+
         // thread local state
         coro_DLL_EXPORT(C*) get_current();
         inline void* get_thread_context() {
@@ -93,6 +93,7 @@ namespace futils {
                     stolen[i] = std::exchange(que[top], nullptr);
                     incr_top();
                     block_by_pop = false;
+                    stored_size--;
                     i++;
                 }
                 return i;
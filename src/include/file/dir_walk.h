@@ -0,0 +1,77 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+// dir_walk - parallel recursive directory walker
+// need to link libfutils
+#pragma once
+#include "file.h"
+
+namespace futils::file {
+
+    struct DirEntry {
+        // entry name
+        view::basic_rvec<wrap::path_char> name;
+        // path relative to root of walk (separated by '/', '\\' on windows)
+        view::basic_rvec<wrap::path_char> path;
+        // type from directory entry (d_type on linux) or stat if needed
+        FileType type = FileType::unknown;
+        // depth from root (direct children of root is 0)
+        std::size_t depth = 0;
+        // nullptr unless WalkOption::stat is true
+        const Stat* stat = nullptr;
+    };
+
+    struct WalkOption {
+        // number of worker threads. 0 means hardware concurrency
+        std::size_t threads = 0;
+        // stat every entry (fstatat on linux)
+        // if false, entry type comes from d_type and stat is only called when d_type is unknown
+        bool stat = false;
+        // descend into symbolic link to directory
+        // NOTE: no cycle detection
+        bool follow_symlink = false;
+        // stop walk and return error when subdirectory cannot be opened or read
+        // otherwise such directory is skipped
+        bool stop_on_error = false;
+        std::size_t max_depth = ~std::size_t(0);
+    };
+
+    // walk directory tree under root in parallel
+    // filter(ctx, entry) returns false to skip entry (not reported and not descended). filter may be nullptr
+    // callback(ctx, entry) is called for each entry passed filter
+    // both filter and callback are called concurrently from worker threads
+    // entry is valid only while the call
+    futils_DLL_EXPORT file_result<void> STDCALL walk_directory(const wrap::path_char* root, const WalkOption& opt,
+                                                                void* ctx,
+                                                                bool (*filter)(void* ctx, const DirEntry& entry),
+                                                                void (*callback)(void* ctx, const DirEntry& entry));
+
+    template <class T>
+        requires internal::has_c_str_for_path<T>
+    file_result<void> walk_directory(T&& root, const WalkOption& opt, auto&& filter, auto&& callback) {
+        struct Ctx {
+            decltype(filter)& f;
+            decltype(callback)& cb;
+        } c{filter, callback};
+        return walk_directory(
+            static_cast<const wrap::path_char*>(root.c_str()), opt, &c,
+            [](void* ctx, const DirEntry& e) -> bool {
+                return static_cast<Ctx*>(ctx)->f(e);
+            },
+            [](void* ctx, const DirEntry& e) {
+                static_cast<Ctx*>(ctx)->cb(e);
+            });
+    }
+
+    template <class T>
+        requires internal::has_c_str_for_path<T>
+    file_result<void> walk_directory(T&& root, const WalkOption& opt, auto&& callback) {
+        return walk_directory(
+            root, opt, [](const DirEntry&) { return true; }, callback);
+    }
+
+}  // namespace futils::file
@@ -344,15 +344,46 @@ namespace futils::file {
     template <class T>
     using file_result = helper::either::expected<T, FileError>;
 
+    // access pattern hint for MMap
+    // on linux, mapped to madvise
+    // on windows, only will_need (PrefetchVirtualMemory) is effective and others are ignored
+    enum class MMapAdvice {
+        normal,
+        sequential,
+        random,
+        will_need,
+        dont_need,
+        huge_page,
+        no_huge_page,
+    };
+
+    struct MMapOption {
+        // offset of file to map
+        // must be multiple of mmap_granularity()
+        std::uint64_t offset = 0;
+        // 0 means until end of file
+        std::size_t length = 0;
+        MMapAdvice advice = MMapAdvice::normal;
+        // pre-fault all pages on map (MAP_POPULATE on linux)
+        bool populate = false;
+        // request transparent huge page (ignored if not supported)
+        bool huge_page = false;
+    };
+
+    // alignment required for MMapOption::offset
+    // page size on linux, allocation granularity on windows
+    futils_DLL_EXPORT std::size_t STDCALL mmap_granularity();
+
     struct futils_DLL_EXPORT MMap {
        private:
         byte* ptr = nullptr;
         std::uintptr_t os_spec = 0;
         std::size_t file_len = 0;
+        std::uint64_t file_offset = 0;
         Mode mode;
         friend struct futils_DLL_EXPORT File;
-        constexpr MMap(byte* ptr, std::uintptr_t spec, std::size_t f_len, Mode m)
-            : ptr(ptr), os_spec(spec), file_len(f_len), mode(m) {}
+        constexpr MMap(byte* ptr, std::uintptr_t spec, std::size_t f_len, std::uint64_t f_offset, Mode m)
+            : ptr(ptr), os_spec(spec), file_len(f_len), file_offset(f_offset), mode(m) {}
 
        public:
         constexpr MMap() = default;
@@ -361,6 +392,7 @@ namespace futils::file {
             : ptr(std::exchange(other.ptr, nullptr)),
               os_spec(std::exchange(other.os_spec, 0)),
               file_len(std::exchange(other.file_len, 0)),
+              file_offset(std::exchange(other.file_offset, 0)),
               mode(std::exchange(other.mode, Mode())) {}
 
         constexpr MMap& operator=(MMap&& other) {
@@ -371,12 +403,33 @@ namespace futils::file {
             ptr = std::exchange(other.ptr, nullptr);
             os_spec = std::exchange(other.os_spec, 0);
             file_len = std::exchange(other.file_len, 0);
+            file_offset = std::exchange(other.file_offset, 0);
             mode = std::exchange(other.mode, Mode());
             return *this;
         }
 
         file_result<void> unmap();
 
+        // give access pattern hint for [offset, offset+len) of this mapping
+        // offset and len are relative to mapping and clamped to mapped range
+        // len == ~0 means until end of mapping
+        file_result<void> advise(MMapAdvice advice, std::size_t offset = 0, std::size_t len = ~std::size_t(0)) const;
+
+        // start reading [offset, offset+len) of this mapping ahead of access
+        file_result<void> prefetch(std::size_t offset, std::size_t len) const {
+            return advise(MMapAdvice::will_need, offset, len);
+        }
+
+        // offset of file which this mapping starts at
+        constexpr std::uint64_t offset() const {
+            return file_offset;
+        }
+
+        // mapped file length
+        constexpr std::size_t size() const {
+            return file_len;
+        }
+
         ~MMap() {
             unmap();  // ignore result
         }
@@ -501,6 +554,12 @@ namespace futils::file {
             return handle != ~0;
         }
 
+        // native handle (fd on linux, HANDLE on windows) for passing to other APIs
+        // ownership is not transferred
+        constexpr std::uintptr_t native_handle() const {
+            return handle;
+        }
+
         static file_result<File> open(const wrap::path_char* filename, Flag flag = O_READ_DEFAULT, Mode mode = r_perm);
 
         template <class T>
@@ -545,7 +604,11 @@ namespace futils::file {
         size_t size() const;
 
         // use m.temporary() as private mapping flag
-        file_result<MMap> mmap(Mode m) const;
+        file_result<MMap> mmap(Mode m) const {
+            return mmap(m, MMapOption{});
+        }
+
+        file_result<MMap> mmap(Mode m, const MMapOption& opt) const;
 
         // returns remaining bytes
         file_result<view::rvec> write_file(view::rvec w, NonBlockContext* n = nullptr) const;
@@ -581,6 +644,75 @@ namespace futils::file {
             return {};
         }
 
+       private:
+        file_result<void> write_vec_all_impl(const view::rvec* vec, size_t count, auto&& write) const {
+            constexpr size_t window = 16;
+            view::rvec buf[window];
+            size_t i = 0;
+            view::rvec head = count ? vec[0] : view::rvec();
+            while (i < count) {
+                if (head.empty()) {
+                    i++;
+                    head = i < count ? vec[i] : view::rvec();
+                    continue;
+                }
+                size_t n = 0;
+                buf[n++] = head;
+                for (size_t j = i + 1; j < count && n < window; j++) {
+                    buf[n++] = vec[j];
+                }
+                auto res = write(buf, n);
+                if (!res) {
+                    const auto eintr = map_os_error_code(ErrorCode::interrupted);
+                    if (res.error().code() == eintr) {
+                        continue;
+                    }
+                    return res.transform([](auto&&) {});
+                }
+                auto written = *res;
+                while (written) {
+                    if (written >= head.size()) {
+                        written -= head.size();
+                        i++;
+                        head = i < count ? vec[i] : view::rvec();
+                    }
+                    else {
+                        head = head.substr(written);
+                        written = 0;
+                    }
+                }
+            }
+            return {};
+        }
+
+       public:
+        // gather write. returns written bytes
+        // count larger than system limit (IOV_MAX) is truncated so check returned bytes
+        file_result<size_t> write_vec(const view::rvec* vec, size_t count) const;
+        // gather write at offset without changing file position (pwritev)
+        file_result<size_t> write_vec_at(const view::rvec* vec, size_t count, std::uint64_t offset) const;
+        // scatter read. returns read bytes
+        file_result<size_t> read_vec(const view::wvec* vec, size_t count) const;
+        // scatter read at offset without changing file position (preadv)
+        file_result<size_t> read_vec_at(const view::wvec* vec, size_t count, std::uint64_t offset) const;
+
+        // write all of vec. partial write and EINTR are handled like write_file_all
+        file_result<void> write_vec_all(const view::rvec* vec, size_t count) const {
+            return write_vec_all_impl(vec, count, [&](const view::rvec* v, size_t c) {
+                return write_vec(v, c);
+            });
+        }
+
+        file_result<void> write_vec_at_all(const view::rvec* vec, size_t count, std::uint64_t offset) const {
+            return write_vec_all_impl(vec, count, [&](const view::rvec* v, size_t c) {
+                auto res = write_vec_at(v, c, offset);
+                if (res) {
+                    offset += *res;
+                }
+                return res;
+            });
+        }
+
         // returns read bytes
         file_result<view::wvec> read_file(view::wvec w, NonBlockContext* n = nullptr) const;
 
@@ -23,7 +23,7 @@ namespace futils {
             View(const View&) = delete;
             View(View&&) = default;
 
-            file_result<void> open(auto&& path) {
+            file_result<void> open(auto&& path, const MMapOption& opt = {}) {
                 if (f) {
                     return helper::either::unexpected(FileError{.method = "View::open", .err_code = map_os_error_code(ErrorCode::already_open)});
                 }
@@ -37,7 +37,7 @@ namespace futils {
                     return helper::either::unexpected(s.error());
                 }
                 info = std::move(s.value());
-                auto m = f.mmap(r_perm);
+                auto m = f.mmap(r_perm, opt);
                 if (!m) {
                     return {};  // ignore and fallback
                 }
@@ -45,6 +45,18 @@ namespace futils {
                 return {};
             }
 
+            // access pattern hint. no effect if mmap fallback
+            file_result<void> advise(MMapAdvice advice, size_t offset = 0, size_t len = ~size_t(0)) const {
+                if (!mmap) {
+                    return {};
+                }
+                return mmap.advise(advice, offset, len);
+            }
+
+            file_result<void> prefetch(size_t offset, size_t len) const {
+                return advise(MMapAdvice::will_need, offset, len);
+            }
+
             bool is_open() const {
                 return f.is_open();
             }
@@ -96,5 +108,133 @@ namespace futils {
                 close();
             }
         };
+
+        // WindowView - view of file through sliding mmap window
+        // for files larger than address space budget
+        // only window_size bytes (rounded up to mmap_granularity()) are mapped at once
+        // and window is remapped when accessed position is out of current window
+        class WindowView {
+            File f;
+            Stat info;
+            MMap window;
+            size_t window_size = 0;
+            MMapAdvice advice = MMapAdvice::sequential;
+
+            file_result<void> slide(size_t position) {
+                const auto gran = mmap_granularity();
+                auto begin = position / gran * gran;
+                // map so that [position, position+window_size) fits in window
+                auto len = (position - begin) + window_size;
+                if (window) {
+                    // release pages of old window before mapping new one
+                    window.advise(MMapAdvice::dont_need);  // ignore result
+                    auto res = window.unmap();
+                    if (!res) {
+                        return res;
+                    }
+                }
+                auto m = f.mmap(r_perm, MMapOption{.offset = begin, .length = len, .advice = advice});
+                if (!m) {
+                    return helper::either::unexpected(m.error());
+                }
+                window = std::move(*m);
+                return {};
+            }
+
+            bool in_window(size_t position, size_t len) const {
+                return window &&
+                       window.offset() <= position &&
+                       position + len <= window.offset() + window.size();
+            }
+
+           public:
+            constexpr WindowView() {}
+            WindowView(const WindowView&) = delete;
+            WindowView(WindowView&&) = default;
+
+            file_result<void> open(auto&& path, size_t window_size = 64 * 1024 * 1024, MMapAdvice advice = MMapAdvice::sequential) {
+                if (f) {
+                    return helper::either::unexpected(FileError{.method = "WindowView::open", .err_code = map_os_error_code(ErrorCode::already_open)});
+                }
+                auto p = File::open(path, O_READ | O_SHARE_READ | O_CLOSE_ON_EXEC);
+                if (!p) {
+                    return helper::either::unexpected(p.error());
+                }
+                f = std::move(p.value());
+                auto s = f.stat();
+                if (!s) {
+                    return helper::either::unexpected(s.error());
+                }
+                info = std::move(s.value());
+                const auto gran = mmap_granularity();
+                if (window_size < gran) {
+                    window_size = gran;
+                }
+                this->window_size = (window_size + gran - 1) / gran * gran;
+                this->advice = advice;
+                return {};
+            }
+
+            bool is_open() const {
+                return f.is_open();
+            }
+
+            size_t size() const {
+                return info.size;
+            }
+
+            // returns view of [position, position+len)
+            // len is truncated to window size and end of file
+            // returned view is valid until next call of range() or operator[]
+            file_result<view::rvec> range(size_t position, size_t len) {
+                if (position >= size()) {
+                    return view::rvec();
+                }
+                if (len > size() - position) {
+                    len = size() - position;
+                }
+                if (len > window_size) {
+                    len = window_size;
+                }
+                if (!in_window(position, len)) {
+                    auto res = slide(position);
+                    if (!res) {
+                        return helper::either::unexpected(res.error());
+                    }
+                }
+                return window.read_view().substr(position - window.offset(), len);
+            }
+
+            std::uint8_t operator[](size_t position) {
+                auto r = range(position, 1);
+                if (!r || r->empty()) {
+                    return 0;
+                }
+                return (*r)[0];
+            }
+
+            // release pages of [0, position) of current window
+            // useful for one pass scan
+            file_result<void> discard_before(size_t position) {
+                if (!window || position <= window.offset()) {
+                    return {};
+                }
+                return window.advise(MMapAdvice::dont_need, 0, position - window.offset());
+            }
+
+            file_result<void> close() {
+                if (window) {
+                    auto res = window.unmap();
+                    if (!res) {
+                        return helper::either::unexpected(res.error());
+                    }
+                }
+                return f.close();
+            }
+
+            ~WindowView() {
+                close();
+            }
+        };
     }  // namespace file
 }  // namespace futils
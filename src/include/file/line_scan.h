@@ -0,0 +1,130 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+// line_scan - parallel line scanner over memory mapped file
+// need to link libfutils and thread library
+#pragma once
+#include "file.h"
+#include <view/iovec.h>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace futils::file {
+
+    // split data into at most n chunks
+    // each chunk ends with '\n' (except the last one) so that no line crosses chunks
+    template <class Vec = std::vector<view::rvec>>
+    Vec split_line_chunks(view::rvec data, size_t n) {
+        Vec chunks;
+        if (n == 0) {
+            n = 1;
+        }
+        size_t begin = 0;
+        for (size_t i = 0; i < n && begin < data.size(); i++) {
+            size_t end = i == n - 1 ? data.size() : data.size() / n * (i + 1);
+            if (end < begin) {
+                end = begin;
+            }
+            if (end < data.size()) {
+                auto p = static_cast<const byte*>(std::memchr(data.data() + end, '\n', data.size() - end));
+                end = p ? p - data.data() + 1 : data.size();
+            }
+            chunks.push_back(data.substr(begin, end - begin));
+            begin = end;
+        }
+        return chunks;
+    }
+
+    // call fn(line) for each line in chunk
+    // line does not contain "\n" or "\r\n"
+    inline void for_each_line(view::rvec chunk, auto&& fn) {
+        while (chunk.size()) {
+            auto p = static_cast<const byte*>(std::memchr(chunk.data(), '\n', chunk.size()));
+            size_t len = p ? p - chunk.data() : chunk.size();
+            auto line = chunk.substr(0, len);
+            if (line.size() && line[line.size() - 1] == '\r') {
+                line = line.substr(0, line.size() - 1);
+            }
+            fn(line);
+            chunk = chunk.substr(p ? len + 1 : len);
+        }
+    }
+
+    // scan lines of data with n_thread threads
+    // fn(Result& local, view::rvec line) is called on each worker with per-chunk Result
+    // returns per-chunk results in chunk order (so caller can merge them in file order)
+    // calling thread also works as one of workers
+    template <class Result, class Vec = std::vector<Result>>
+    Vec scan_lines(view::rvec data, size_t n_thread, auto&& fn) {
+        if (n_thread == 0) {
+            n_thread = std::thread::hardware_concurrency();
+        }
+        auto chunks = split_line_chunks(data, n_thread);
+        Vec results(chunks.size());
+        // accumulate on worker's stack and store once
+        // because adjacent elements of results share cache line
+        auto scan = [&](size_t i) {
+            Result local{};
+            for_each_line(chunks[i], [&](view::rvec line) {
+                fn(local, line);
+            });
+            results[i] = std::move(local);
+        };
+        std::vector<std::thread> workers;
+        workers.reserve(chunks.size());
+        for (size_t i = 1; i < chunks.size(); i++) {
+            workers.emplace_back(scan, i);
+        }
+        if (chunks.size()) {
+            scan(0);
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        return results;
+    }
+
+    // scan lines and merge per-chunk results in file order
+    // merge(Result& acc, Result&& chunk_result)
+    template <class Result>
+    Result scan_lines(view::rvec data, size_t n_thread, auto&& fn, auto&& merge) {
+        auto results = scan_lines<Result>(data, n_thread, fn);
+        Result acc{};
+        for (auto& r : results) {
+            merge(acc, std::move(r));
+        }
+        return acc;
+    }
+
+    // mmap file and scan lines with n_thread threads
+    // see also scan_lines
+    template <class Result, class Vec = std::vector<Result>>
+    file_result<Vec> scan_file_lines(const File& f, size_t n_thread, auto&& fn) {
+        if (f.size() == 0) {
+            return Vec{};
+        }
+        auto m = f.mmap(r_perm, MMapOption{.advice = MMapAdvice::sequential});
+        if (!m) {
+            return helper::either::unexpected(m.error());
+        }
+        return scan_lines<Result, Vec>(m->read_view(), n_thread, fn);
+    }
+
+    template <class Result>
+    file_result<Result> scan_file_lines(const File& f, size_t n_thread, auto&& fn, auto&& merge) {
+        if (f.size() == 0) {
+            return Result{};
+        }
+        auto m = f.mmap(r_perm, MMapOption{.advice = MMapAdvice::sequential});
+        if (!m) {
+            return helper::either::unexpected(m.error());
+        }
+        return scan_lines<Result>(m->read_view(), n_thread, fn, merge);
+    }
+
+}  // namespace futils::file
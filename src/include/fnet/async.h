@@ -21,6 +21,15 @@ namespace futils::fnet {
         View control;
     };
 
+    // Datagram is element of Socket::readfrom_many/writeto_many
+    // control is ancillary data (cmsg) to send or buffer to receive. it is used only on linux
+    template <class View>
+    struct Datagram {
+        View data;
+        NetAddrPort addr;
+        View control;
+    };
+
     enum class NotifyState {
         wait,  // waiting notification, callback will be called
         done,  // operation done, callback will not be called
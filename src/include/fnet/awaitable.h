@@ -0,0 +1,481 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+// awaitable - C++20 coroutine wrapper of async socket operations
+// unlike async_then family, no callback object is allocated per operation.
+// awaiter object lives in the coroutine frame and its pointer is passed to *_async as user data,
+// and the coroutine is resumed from completion handler (i.e. on the thread calling wait_io_event)
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <new>
+#include <optional>
+#include "socket.h"
+#include "dll/allocator.h"
+
+namespace futils::fnet {
+
+    template <class T = void>
+    struct Task;
+
+    namespace internal {
+        // coroutine frame is allocated through glheap_allocator
+        struct GlheapFrame {
+            using unit = std::max_align_t;
+
+            static constexpr size_t units(size_t size) {
+                return (size + sizeof(unit) - 1) / sizeof(unit);
+            }
+
+            // glheap_allocator returns nullptr on failure but coroutine frame allocation must not
+            static void* operator new(size_t size) {
+                auto p = glheap_allocator<unit>::allocate(units(size));
+                if (!p) {
+                    throw std::bad_alloc();
+                }
+                return p;
+            }
+
+            static void operator delete(void* p, size_t size) {
+                glheap_allocator<unit>::deallocate(static_cast<unit*>(p), units(size));
+            }
+        };
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept {
+                return false;
+            }
+
+            // symmetric transfer to awaiting coroutine
+            template <class P>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+                if (auto c = h.promise().continuation) {
+                    return c;
+                }
+                return std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        struct PromiseBase : GlheapFrame {
+            std::coroutine_handle<> continuation;
+            std::exception_ptr except;
+
+            std::suspend_always initial_suspend() noexcept {
+                return {};
+            }
+
+            FinalAwaiter final_suspend() noexcept {
+                return {};
+            }
+
+            void unhandled_exception() noexcept {
+                except = std::current_exception();
+            }
+
+            void rethrow() {
+                if (except) {
+                    std::rethrow_exception(except);
+                }
+            }
+        };
+
+        template <class T>
+        struct Promise : PromiseBase {
+            std::optional<T> value;
+
+            template <class V = T>
+            void return_value(V&& v) {
+                value.emplace(std::forward<V>(v));
+            }
+
+            T get() {
+                rethrow();
+                return std::move(*value);
+            }
+        };
+
+        template <>
+        struct Promise<void> : PromiseBase {
+            void return_void() noexcept {}
+
+            void get() {
+                rethrow();
+            }
+        };
+
+        // Detached starts immediately and frees its frame at completion
+        struct Detached {
+            struct promise_type : GlheapFrame {
+                Detached get_return_object() noexcept {
+                    return {};
+                }
+
+                std::suspend_never initial_suspend() noexcept {
+                    return {};
+                }
+
+                std::suspend_never final_suspend() noexcept {
+                    return {};
+                }
+
+                void return_void() noexcept {}
+
+                void unhandled_exception() noexcept {
+                    std::terminate();
+                }
+            };
+        };
+    }  // namespace internal
+
+    // Task is lazy started coroutine
+    // it starts when awaited or passed to spawn()
+    template <class T>
+    struct [[nodiscard]] Task {
+        struct promise_type : internal::Promise<T> {
+            Task get_return_object() noexcept {
+                return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+        };
+
+       private:
+        std::coroutine_handle<promise_type> handle;
+
+        explicit Task(std::coroutine_handle<promise_type> h)
+            : handle(h) {}
+
+       public:
+        constexpr Task() = default;
+
+        Task(Task&& t) noexcept
+            : handle(std::exchange(t.handle, nullptr)) {}
+
+        Task& operator=(Task&& t) noexcept {
+            if (this == &t) {
+                return *this;
+            }
+            this->~Task();
+            handle = std::exchange(t.handle, nullptr);
+            return *this;
+        }
+
+        ~Task() {
+            if (handle) {
+                handle.destroy();
+            }
+        }
+
+        constexpr explicit operator bool() const noexcept {
+            return handle != nullptr;
+        }
+
+        bool done() const noexcept {
+            return handle && handle.done();
+        }
+
+        bool await_ready() const noexcept {
+            return !handle || handle.done();
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) noexcept {
+            handle.promise().continuation = c;
+            return handle;
+        }
+
+        T await_resume() {
+            return handle.promise().get();
+        }
+    };
+
+    namespace internal {
+        inline Detached run_detached(Task<void> task) {
+            co_await task;
+        }
+    }  // namespace internal
+
+    // spawn runs task on the caller until its first suspension
+    // and after that, on the thread that handles the completion
+    // exception escaped from task terminates the program
+    inline void spawn(Task<void>&& task) {
+        internal::run_detached(std::move(task));
+    }
+
+    // awaiters
+    // await_suspend must not touch *this after *_async returned NotifyState::wait
+    // because completion may be already running on the other thread
+
+    struct ReadAwaiter {
+        Socket& sock;
+        view::wvec buffer;
+        std::uint32_t flag = 0;
+        std::coroutine_handle<> handle;
+        expected<view::wvec> result;
+
+        // returns true if completion is pending
+        bool arm(Socket& s) {
+            auto r = s.read_async(buffer, this, on_notify, flag);
+            if (!r) {
+                result = unexpect(r.error());
+                return false;
+            }
+            if (r->state == NotifyState::wait) {
+                return true;
+            }
+            if (r->processed_bytes == 0) {
+                result = unexpect(error::eof);
+            }
+            else {
+                result = buffer.substr(0, r->processed_bytes);
+            }
+            return false;
+        }
+
+        static void on_notify(Socket&& s, void* c, NotifyResult&& r) {
+            auto self = static_cast<ReadAwaiter*>(c);
+            auto res = r.read_unwrap(self->buffer, [&](view::wvec w) {
+                return s.read(w, self->flag);
+            });
+            if (!res && isSysBlock(res.error())) {
+                if (self->arm(s)) {
+                    return;  // spurious wakeup
+                }
+            }
+            else {
+                self->result = std::move(res);
+            }
+            self->handle.resume();
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            return arm(sock);
+        }
+
+        expected<view::wvec> await_resume() {
+            return std::move(result);
+        }
+    };
+
+    // WriteAwaiter writes whole buffer
+    struct WriteAwaiter {
+        Socket& sock;
+        view::rvec buffer;
+        std::uint32_t flag = 0;
+        std::coroutine_handle<> handle;
+        expected<void> result;
+
+        bool arm(Socket& s) {
+            while (buffer.size()) {
+                auto r = s.write_async(buffer, this, on_notify, flag);
+                if (!r) {
+                    result = unexpect(r.error());
+                    return false;
+                }
+                if (r->state == NotifyState::wait) {
+                    return true;
+                }
+                buffer = buffer.substr(r->processed_bytes);
+            }
+            return false;
+        }
+
+        static void on_notify(Socket&& s, void* c, NotifyResult&& r) {
+            auto self = static_cast<WriteAwaiter*>(c);
+            auto res = r.write_unwrap(self->buffer, [&](view::rvec w) {
+                return s.write(w, self->flag);
+            });
+            if (!res && !isSysBlock(res.error())) {
+                self->result = unexpect(res.error());
+            }
+            else {
+                if (res) {
+                    self->buffer = *res;
+                }
+                if (self->arm(s)) {
+                    return;
+                }
+            }
+            self->handle.resume();
+        }
+
+        bool await_ready() const noexcept {
+            return buffer.empty();
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            return arm(sock);
+        }
+
+        expected<void> await_resume() {
+            return std::move(result);
+        }
+    };
+
+    struct ReadFromAwaiter {
+        Socket& sock;
+        view::wvec buffer;
+        std::uint32_t flag = 0;
+        std::coroutine_handle<> handle;
+        NetAddrPort addr;
+        expected<std::pair<view::wvec, NetAddrPort>> result;
+
+        bool arm(Socket& s) {
+            auto r = s.readfrom_async(buffer, addr, this, on_notify, flag);
+            if (!r) {
+                result = unexpect(r.error());
+                return false;
+            }
+            if (r->state == NotifyState::wait) {
+                return true;
+            }
+            result = std::make_pair(buffer.substr(0, r->processed_bytes), std::move(addr));
+            return false;
+        }
+
+        static void on_notify(Socket&& s, NetAddrPort&& a, void* c, NotifyResult&& r) {
+            auto self = static_cast<ReadFromAwaiter*>(c);
+            auto res = r.readfrom_unwrap(self->buffer, a, [&](view::wvec w) {
+                return s.readfrom(w, self->flag);
+            });
+            if (!res && isSysBlock(res.error())) {
+                if (self->arm(s)) {
+                    return;
+                }
+            }
+            else {
+                self->result = std::move(res);
+            }
+            self->handle.resume();
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            return arm(sock);
+        }
+
+        expected<std::pair<view::wvec, NetAddrPort>> await_resume() {
+            return std::move(result);
+        }
+    };
+
+    struct AcceptAwaiter {
+        Socket& sock;
+        std::uint32_t flag = 0;
+        std::coroutine_handle<> handle;
+        NetAddrPort addr;
+        expected<std::pair<Socket, NetAddrPort>> result;
+
+        bool arm(Socket& s) {
+            auto r = s.accept_async(addr, this, on_notify, flag);
+            if (!r) {
+                result = unexpect(r.error());
+                return false;
+            }
+            if (r->state == NotifyState::wait) {
+                return true;
+            }
+            result = std::make_pair(std::move(r->socket), std::move(addr));
+            return false;
+        }
+
+        static void on_notify(Socket&& listener, Socket&& accepted, NetAddrPort&& a, void* c, NotifyResult&& r) {
+            auto self = static_cast<AcceptAwaiter*>(c);
+            auto& res = r.value();
+            if (res) {
+                self->result = std::make_pair(std::move(accepted), std::move(a));
+            }
+            else if (!isSysBlock(res.error())) {
+                self->result = unexpect(res.error());
+            }
+            else if (self->arm(listener)) {
+                return;
+            }
+            self->handle.resume();
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            return arm(sock);
+        }
+
+        expected<std::pair<Socket, NetAddrPort>> await_resume() {
+            return std::move(result);
+        }
+    };
+
+    struct ConnectAwaiter {
+        Socket& sock;
+        const NetAddrPort& addr;
+        std::uint32_t flag = 0;
+        std::coroutine_handle<> handle;
+        expected<void> result;
+
+        static void on_notify(Socket&&, void* c, NotifyResult&& r) {
+            auto self = static_cast<ConnectAwaiter*>(c);
+            if (auto& res = r.value(); !res) {
+                self->result = unexpect(res.error());
+            }
+            self->handle.resume();
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            auto r = sock.connect_async(addr, this, on_notify, flag);
+            if (!r) {
+                result = unexpect(r.error());
+                return false;
+            }
+            return r->state == NotifyState::wait;
+        }
+
+        expected<void> await_resume() {
+            return std::move(result);
+        }
+    };
+
+    // co_await async_read(sock, buf) returns read bytes or error::eof at end of stream
+    inline ReadAwaiter async_read(Socket& sock, view::wvec buffer, std::uint32_t flag = 0) {
+        return ReadAwaiter{sock, buffer, flag};
+    }
+
+    // co_await async_write(sock, buf) returns when whole buffer is written
+    inline WriteAwaiter async_write(Socket& sock, view::rvec buffer, std::uint32_t flag = 0) {
+        return WriteAwaiter{sock, buffer, flag};
+    }
+
+    inline ReadFromAwaiter async_readfrom(Socket& sock, view::wvec buffer, std::uint32_t flag = 0) {
+        return ReadFromAwaiter{sock, buffer, flag};
+    }
+
+    inline AcceptAwaiter async_accept(Socket& listener, std::uint32_t flag = 0) {
+        return AcceptAwaiter{listener, flag};
+    }
+
+    // addr must be alive until co_await completes
+    inline ConnectAwaiter async_connect(Socket& sock, const NetAddrPort& addr, std::uint32_t flag = 0) {
+        return ConnectAwaiter{sock, addr, flag};
+    }
+
+}  // namespace futils::fnet
@@ -54,7 +54,7 @@ namespace futils {
 
             constexpr glheap_objpool_allocator() = default;
 
-            constexpr bool operator==(const glheap_objpool_allocator&) {
+            constexpr friend bool operator==(const glheap_objpool_allocator&, const glheap_objpool_allocator&) {
                 return true;
             }
         };
@@ -74,6 +74,7 @@ namespace futils {
         LAZY(CancelIoEx)
         LAZY(GetQueuedCompletionStatusEx)
         LAZY(SetFileCompletionNotificationModes)
+        LAZY(PostQueuedCompletionStatus)
 
 #else
         LAZY(socket)
@@ -87,6 +88,12 @@ namespace futils {
         LAZY(epoll_create1)
         LAZY(epoll_ctl)
         LAZY(epoll_pwait)
+        LAZY(sendmmsg)
+        LAZY(recvmmsg)
+        LAZY(accept4)
+        LAZY(eventfd)
+        LAZY(eventfd_write)
+        LAZY(sendfile)
 #endif
 #undef LAZY
 
@@ -71,11 +71,18 @@ namespace futils {
 
             LAZY(SSL_alert_desc_string_long)
             LAZY(SSL_CTX_set_keylog_callback)
+            LAZY(SSL_CTX_set_msg_callback)
+            LAZY(SSL_is_server)
 
             namespace ossl {
                 LAZY_BIND(libssl, ssl_import::bc::open_ssl::ssl::SSL_CTX_set_alpn_protos, SSL_CTX_set_alpn_protos)
                 LAZY_BIND(libssl, ssl_import::bc::open_ssl::ssl::SSL_set_alpn_protos, SSL_set_alpn_protos)
                 LAZY_BIND(libssl, ssl_import::bc::open_ssl::ssl::SSL_set_quic_method, SSL_set_quic_method)
+                // specific
+                namespace sp {
+                    LAZY_BIND(libssl, ssl_import::ls::open_ssl::ssl::SSL_CTX_set_ciphersuites, SSL_CTX_set_ciphersuites)
+                    LAZY_BIND(libssl, ssl_import::ls::open_ssl::ssl::SSL_set_ciphersuites, SSL_set_ciphersuites)
+                }  // namespace sp
             }  // namespace ossl
 
             namespace bssl {
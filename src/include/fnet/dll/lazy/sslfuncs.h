@@ -66,6 +66,10 @@ namespace ssl_import {
     constexpr auto SSL_SESS_CACHE_CLIENT_ = 0x0001;
     constexpr auto SSL_SESS_CACHE_SERVER_ = 0x0002;
 
+    // message callback content type
+    constexpr auto SSL3_RT_HANDSHAKE_ = 22;
+    constexpr auto SSL3_RT_HEADER_ = 0x100;
+
     // OpenSSL specific
     constexpr auto CRYPTO_EX_INDEX_SSL_CTX_ = 1;
 
@@ -192,6 +196,11 @@ namespace ssl_import {
 
             void SSL_CTX_set_keylog_callback(SSL_CTX* ctx, SSL_CTX_keylog_cb_func cb);
 
+            // for kTLS (record sequence tracking)
+            typedef void (*SSL_CTX_msg_cb_func)(int write_p, int version, int content_type, const void* buf, size_t len, SSL* ssl, void* arg);
+            void SSL_CTX_set_msg_callback(SSL_CTX* ctx, SSL_CTX_msg_cb_func cb);
+            int SSL_is_server(const SSL* ssl);
+
         }  // namespace ssl
 
         namespace crypto {
@@ -288,7 +297,8 @@ namespace ssl_import {
     namespace ls {
         namespace open_ssl {
             namespace ssl {
-
+                int SSL_CTX_set_ciphersuites(SSL_CTX* ctx, const char* str);
+                int SSL_set_ciphersuites(SSL* s, const char* str);
             }  // namespace ssl
             namespace crypto {
                 int CRYPTO_get_ex_new_index(int class_index, long argl, void* argp,
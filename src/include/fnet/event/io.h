@@ -38,23 +38,51 @@ namespace futils::fnet {
         // program that uses Socket async operation must call this function finally if it uses Completion object
         fnet_dll_export(void) fnet_handle_completion_via_Completion(Completion c);
 
+        // IOBackend selects the notification mechanism of IOEvent
+        enum class IOBackend {
+            // IOCP on windows
+            // on linux, io_uring if environment variable FNET_IO_BACKEND=io_uring is set, otherwise epoll
+            platform_default,
+            epoll,     // linux only. readiness based
+            io_uring,  // linux only. completion based. falls back to epoll if kernel does not support it
+            iocp,      // windows only
+        };
+
         struct fnet_class_export IOEvent {
            private:
             std::uintptr_t handle = invalid_handle;
             void* rt = nullptr;
             void (*f)(void* ptr, void* rt) = nullptr;
-            friend fnet_dll_export(expected<IOEvent>) make_io_event(void (*)(void*, void*), void*);
+            void* uring = nullptr;                  // ring of io_uring backend (see uring.cpp)
+            std::uintptr_t wake = invalid_handle;  // eventfd of epoll backend for notify
+            friend fnet_dll_export(expected<IOEvent>) make_io_event(void (*)(void*, void*), void*, IOBackend);
 
-            constexpr IOEvent(std::uintptr_t h, void (*s)(void*, void*), void* r)
-                : handle(h), f(s), rt(r) {}
+            constexpr IOEvent(std::uintptr_t h, void (*s)(void*, void*), void* r, void* u = nullptr, std::uintptr_t w = invalid_handle)
+                : handle(h), f(s), rt(r), uring(u), wake(w) {}
 
            public:
             constexpr IOEvent() = default;
             constexpr IOEvent(IOEvent&& o)
-                : handle(std::exchange(o.handle, invalid_handle)), f(std::exchange(o.f, nullptr)), rt(std::exchange(o.rt, nullptr)) {}
+                : handle(std::exchange(o.handle, invalid_handle)), f(std::exchange(o.f, nullptr)), rt(std::exchange(o.rt, nullptr)), uring(std::exchange(o.uring, nullptr)), wake(std::exchange(o.wake, invalid_handle)) {}
 
             expected<void> register_handle(std::uintptr_t handle, void* ptr);
             expected<size_t> wait(std::uint32_t timeout);
+
+            // notify wakes up one thread blocking on wait (or next call of wait if nobody is waiting)
+            // so that one thread can block on both io completion and user defined queue
+            // wake up is consumed by wait and never passed to completion handler
+            // this is thread safe
+            expected<void> notify();
+
+            // backend returns actually selected backend
+            // this is never IOBackend::platform_default
+            IOBackend backend() const noexcept;
+
+            // for internal use
+            constexpr void* uring_ring() const noexcept {
+                return uring;
+            }
+
             ~IOEvent();
         };
 
@@ -79,10 +107,17 @@ namespace futils::fnet {
          * @param rt An optional pointer to the runtime context, which can
          *        be specified if needed.
          *
+         * @param backend Notification mechanism. On Linux, `IOBackend::io_uring`
+         *        makes Socket async operations completion based (NotifyResult
+         *        has transferred bytes like Windows) and `ptr` still points to
+         *        an `epoll_event` synthesized from the completion queue entry.
+         *        If io_uring is not available, epoll is used instead.
+         *        Use `IOEvent::backend` to check the selected backend.
+         *
          * @return An expected `IOEvent` object, which contains the initialized
          *         I/O event for further operations.
          */
-        fnet_dll_export(expected<IOEvent>) make_io_event(void (*)(void* ptr, void* rt), void* rt);
+        fnet_dll_export(expected<IOEvent>) make_io_event(void (*)(void* ptr, void* rt), void* rt, IOBackend backend = IOBackend::platform_default);
     }  // namespace event
 
     // wait_event waits io completion until time passed
@@ -93,4 +128,8 @@ namespace futils::fnet {
     // this is based on default IOEvent
     // so if you uses custom IOEvent, use it's wait method instead
     fnet_dll_export(expected<size_t>) wait_io_event(std::uint32_t time);
+
+    // notify_io_event wakes up one thread blocking on wait_io_event
+    // this is based on default IOEvent
+    fnet_dll_export(expected<void>) notify_io_event();
 }  // namespace futils::fnet
@@ -0,0 +1,107 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+// gso - UDP GSO (UDP_SEGMENT) and GRO (UDP_GRO) control message helpers
+// see also https://www.kernel.org/doc/html/latest/networking/segmentation-offloads.html
+#pragma once
+#include <bit>
+#include <optional>
+#include "cmsg.h"
+
+namespace futils::fnet::gso {
+    constexpr std::uint32_t sol_udp = 17;       // SOL_UDP
+    constexpr std::uint32_t udp_segment = 103;  // UDP_SEGMENT
+    constexpr std::uint32_t udp_gro = 104;      // UDP_GRO
+
+    // kernel limit of segments in one send (UDP_MAX_SEGMENTS)
+    constexpr size_t max_segments = 64;
+    // whole segments are sent as one IP datagram in kernel so total size is limited
+    // this is lower than 65535 - ipv6 header - udp header
+    constexpr size_t max_total_size = 65000;
+
+    // CMsg has same layout as cmsghdr of 64 bit little endian linux (size_t len, int level, int type)
+    // on other platform, helpers return empty and caller should send without offload
+    constexpr bool cmsg_compatible = std::endian::native == std::endian::little && sizeof(void*) == 8;
+
+    constexpr size_t cmsg_space(size_t data_len) {
+        return (CMsg::fixed_header_size + data_len + 7) & ~size_t(7);  // CMSG_SPACE
+    }
+
+    // control buffer size for encode_segment_size
+    constexpr size_t segment_cmsg_space = cmsg_space(sizeof(std::uint16_t));
+    // control buffer size to receive UDP_GRO
+    constexpr size_t gro_cmsg_space = cmsg_space(sizeof(int));
+
+    // encode_segment_size encodes UDP_SEGMENT cmsg into buf
+    // returns encoded control or empty if not supported or buf is too small
+    constexpr view::rvec encode_segment_size(view::wvec buf, std::uint16_t size) {
+        if (!cmsg_compatible || buf.size() < segment_cmsg_space) {
+            return {};
+        }
+        byte data[2]{};
+        binary::writer dw{view::wvec(data, 2)};
+        binary::write_num(dw, size, false);
+        CMsg msg;
+        msg.len = CMsg::fixed_header_size + 2;
+        msg.level = sol_udp;
+        msg.type = udp_segment;
+        msg.msg = view::rvec(data, 2);
+        binary::writer w{buf.substr(0, segment_cmsg_space)};
+        if (!msg.encode(w)) {
+            return {};
+        }
+        w.write(0, w.remain().size());  // padding
+        return w.written();
+    }
+
+    namespace internal {
+        constexpr std::optional<std::uint16_t> find_udp_cmsg(view::rvec control, std::uint32_t type) {
+            if (!cmsg_compatible) {
+                return std::nullopt;
+            }
+            binary::reader r{control};
+            while (r.remain().size() >= CMsg::fixed_header_size) {
+                CMsg msg;
+                if (!msg.decode(r)) {
+                    return std::nullopt;
+                }
+                if (msg.level == sol_udp && msg.type == type && msg.msg.size() >= sizeof(std::uint16_t)) {
+                    // UDP_SEGMENT is u16 and UDP_GRO is int but both are little endian
+                    binary::reader mr{msg.msg};
+                    std::uint16_t size = 0;
+                    binary::read_num(mr, size, false);
+                    return size;
+                }
+                r.offset(cmsg_space(msg.msg.size()) - msg.len);  // padding (clamped at end)
+            }
+            return std::nullopt;
+        }
+    }  // namespace internal
+
+    // find_gro_size returns segment size of received GRO datagram
+    // returns nullopt if control has no UDP_GRO cmsg (datagram is not coalesced)
+    constexpr std::optional<std::uint16_t> find_gro_size(view::rvec control) {
+        return internal::find_udp_cmsg(control, udp_gro);
+    }
+
+    // find_segment_size returns segment size encoded by encode_segment_size
+    constexpr std::optional<std::uint16_t> find_segment_size(view::rvec control) {
+        return internal::find_udp_cmsg(control, udp_segment);
+    }
+
+    // split_segments calls cb(view::rvec or view::wvec) for each segment of coalesced datagram
+    // every segment has segment_size except last one
+    constexpr void split_segments(auto data, size_t segment_size, auto&& cb) {
+        if (segment_size == 0) {
+            cb(data);
+            return;
+        }
+        for (size_t i = 0; i < data.size(); i += segment_size) {
+            cb(data.substr(i, segment_size));
+        }
+    }
+}  // namespace futils::fnet::gso
@@ -32,6 +32,22 @@ namespace futils {
         };
 
         fnet_dll_export(void) set_normal_allocs(Allocs alloc);
+        // if alloc is not set, objpool uses slab allocator with size classes and per-thread caches
         fnet_dll_export(void) set_objpool_allocs(Allocs alloc);
+
+        struct ObjpoolClassStats {
+            size_t object_size = 0;    // max object size of size class
+            size_t magazine_size = 0;  // objects exchanged between thread cache and depot at once
+            size_t slabs = 0;          // slabs carved by this class
+            size_t objects = 0;        // objects carved from slabs
+            size_t depot_objects = 0;  // free objects in depot. others are used or cached by threads
+            size_t refills = 0;        // magazines passed from depot to thread cache
+            size_t returns = 0;        // magazines returned from thread cache to depot
+        };
+
+        // get_objpool_stats stores statistics of default objpool size classes to stats up to n
+        // and returns number of size classes
+        // if objpool allocator is replaced by set_objpool_allocs, it is not updated
+        fnet_dll_export(size_t) get_objpool_stats(ObjpoolClassStats* stats, size_t n);
     }  // namespace fnet
 }  // namespace futils
@@ -276,7 +276,7 @@ namespace futils::fnet::http {
         error::Error write_body(Body&& body, bool fin = true) {
             switch (version()) {
                 case HTTPVersion::http1: {
-                    auto err = http1()->write_body(std::forward<Body>(body), fin);
+                    auto err = http1()->write_body(std::forward<Body>(body));
                     if (err) {
                         return err;
                     }
@@ -50,6 +50,18 @@ namespace futils::fnet::http1 {
         };
     }
 
+    // same as above but key and value are constructed with alloc
+    // (e.g. request scoped arena)
+    template <class String, class F, class Alloc>
+    constexpr auto field_range_to_string(F&& f, const Alloc& alloc) {
+        return [=](auto& seq, FieldRange range) {
+            String key{alloc}, value{alloc};
+            range_to_string(seq, key, range.key);
+            range_to_string(seq, value, range.value);
+            return apply_call_or_emplace(f, std::move(key), std::move(value));
+        };
+    }
+
     template <class H, class F>
     constexpr header::HeaderErr apply_call_or_iter(H&& h, F&& f) {
         if constexpr (std::invocable<decltype(h), decltype(std::move(f))>) {
@@ -71,4 +83,12 @@ namespace futils::fnet::http1 {
             return apply_call_or_emplace(header, std::move(key), std::move(value));
         });
     }
+
+    template <class String>
+    auto default_header_callback(auto&& header, const auto& alloc) {
+        auto emplace = [&](auto&& key, auto&& value) {
+            return apply_call_or_emplace(header, std::move(key), std::move(value));
+        };
+        return field_range_to_string<String>(emplace, alloc);
+    }
 }  // namespace futils::fnet::http1
@@ -7,6 +7,8 @@
 
 #pragma once
 #include <cstddef>
+#include <cstdint>
+#include <string_view>
 
 namespace futils::fnet::http1 {
     struct Range {
@@ -18,4 +20,137 @@ namespace futils::fnet::http1 {
         Range key;
         Range value;
     };
-}  // namespace futils::fnet::http1
\ No newline at end of file
+
+    // ByteRange is [offset, offset+length) of representation selected by Range header
+    struct ByteRange {
+        std::uint64_t offset = 0;
+        std::uint64_t length = 0;
+    };
+
+    enum class ByteRangeResult {
+        full,           // no (or ignored) Range header. send whole representation with 200
+        partial,        // send range with 206 and Content-Range: bytes first-last/size
+        unsatisfiable,  // send 416 with Content-Range: bytes */size
+    };
+
+    namespace internal {
+        constexpr bool parse_range_number(std::string_view& s, std::uint64_t& n) {
+            size_t i = 0;
+            n = 0;
+            for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; i++) {
+                auto d = std::uint64_t(s[i] - '0');
+                if (n > (~std::uint64_t(0) - d) / 10) {
+                    return false;  // overflow
+                }
+                n = n * 10 + d;
+            }
+            if (i == 0) {
+                return false;
+            }
+            s = s.substr(i);
+            return true;
+        }
+
+        constexpr std::string_view trim_ows(std::string_view s) {
+            while (s.size() && (s.front() == ' ' || s.front() == '\t')) {
+                s = s.substr(1);
+            }
+            while (s.size() && (s.back() == ' ' || s.back() == '\t')) {
+                s = s.substr(0, s.size() - 1);
+            }
+            return s;
+        }
+    }  // namespace internal
+
+    // parse_byte_range resolves value of Range header against representation size (RFC 9110 14.1.2, 14.2)
+    // only single byte range (bytes=first-last, bytes=first-, bytes=-suffix) is supported
+    // multiple ranges, other units and invalid syntax are ignored and result is full
+    // as RFC 9110 allows server to ignore Range header
+    constexpr ByteRangeResult parse_byte_range(std::string_view value, std::uint64_t size, ByteRange& range) {
+        range = ByteRange{0, size};
+        value = internal::trim_ows(value);
+        constexpr std::string_view unit = "bytes=";
+        if (value.size() < unit.size()) {
+            return ByteRangeResult::full;
+        }
+        for (size_t i = 0; i < unit.size(); i++) {
+            auto c = value[i];
+            if (c >= 'A' && c <= 'Z') {
+                c += 'a' - 'A';
+            }
+            if (c != unit[i]) {
+                return ByteRangeResult::full;
+            }
+        }
+        value = internal::trim_ows(value.substr(unit.size()));
+        if (value.find(',') != value.npos) {
+            return ByteRangeResult::full;
+        }
+        std::uint64_t first = 0, last = 0;
+        if (value.size() && value[0] == '-') {
+            value = value.substr(1);
+            if (!internal::parse_range_number(value, last) || value.size()) {
+                return ByteRangeResult::full;
+            }
+            if (last == 0 || size == 0) {
+                return ByteRangeResult::unsatisfiable;
+            }
+            if (last > size) {
+                last = size;
+            }
+            range = ByteRange{size - last, last};
+            return ByteRangeResult::partial;
+        }
+        if (!internal::parse_range_number(value, first) || value.empty() || value[0] != '-') {
+            return ByteRangeResult::full;
+        }
+        value = value.substr(1);
+        if (value.empty()) {
+            last = size ? size - 1 : 0;
+        }
+        else if (!internal::parse_range_number(value, last) || value.size() || last < first) {
+            return ByteRangeResult::full;
+        }
+        if (first >= size) {
+            return ByteRangeResult::unsatisfiable;
+        }
+        if (last >= size) {
+            last = size - 1;
+        }
+        range = ByteRange{first, last - first + 1};
+        return ByteRangeResult::partial;
+    }
+
+    namespace test {
+        constexpr bool test_parse_byte_range() {
+            auto check = [](std::string_view value, std::uint64_t size, ByteRangeResult expect, std::uint64_t offset, std::uint64_t length) {
+                ByteRange r;
+                if (parse_byte_range(value, size, r) != expect) {
+                    throw "Result not equal";
+                }
+                if (expect != ByteRangeResult::unsatisfiable && (r.offset != offset || r.length != length)) {
+                    throw "Range not equal";
+                }
+            };
+            check("bytes=0-499", 1000, ByteRangeResult::partial, 0, 500);
+            check("bytes=500-", 1000, ByteRangeResult::partial, 500, 500);
+            check("bytes=-100", 1000, ByteRangeResult::partial, 900, 100);
+            check("bytes=-2000", 1000, ByteRangeResult::partial, 0, 1000);
+            check("bytes=900-2000", 1000, ByteRangeResult::partial, 900, 100);
+            check(" Bytes=1-1 ", 1000, ByteRangeResult::partial, 1, 1);
+            check("bytes=1000-", 1000, ByteRangeResult::unsatisfiable, 0, 0);
+            check("bytes=-0", 1000, ByteRangeResult::unsatisfiable, 0, 0);
+            check("bytes=0-", 0, ByteRangeResult::unsatisfiable, 0, 0);
+            // ignored
+            check("", 1000, ByteRangeResult::full, 0, 1000);
+            check("bytes=5-1", 1000, ByteRangeResult::full, 0, 1000);
+            check("bytes=0-1,5-6", 1000, ByteRangeResult::full, 0, 1000);
+            check("items=0-1", 1000, ByteRangeResult::full, 0, 1000);
+            check("bytes=a-b", 1000, ByteRangeResult::full, 0, 1000);
+            check("bytes=99999999999999999999-", 1000, ByteRangeResult::full, 0, 1000);
+            return true;
+        }
+
+        static_assert(test_parse_byte_range());
+    }  // namespace test
+}  // namespace futils::fnet::http1
@@ -59,7 +59,7 @@ namespace futils {
                 }
                 auto self = shared_from_this();
                 auto conn_ptr = std::shared_ptr<stream::Conn>(self, &conn);
-                auto s = std::allocate_shared<stream::Stream>(glheap_allocator<stream::Stream>{}, id, std::move(conn_ptr), conn.state.local_settings().max_header_table_size);
+                auto s = std::allocate_shared<stream::Stream>(glheap_objpool_allocator<stream::Stream>{}, id, std::move(conn_ptr), conn.state.local_settings().max_header_table_size);
                 streams.emplace(id, s);
                 return s;
             }
@@ -82,7 +82,7 @@ namespace futils {
                 if (found == streams.end()) {
                     auto self = shared_from_this();
                     auto conn_ptr = std::shared_ptr<stream::Conn>(self, &conn);
-                    s = std::allocate_shared<stream::Stream>(glheap_allocator<stream::Stream>{}, f.id, std::move(conn_ptr), conn.state.local_settings().max_header_table_size);
+                    s = std::allocate_shared<stream::Stream>(glheap_objpool_allocator<stream::Stream>{}, f.id, std::move(conn_ptr), conn.state.local_settings().max_header_table_size);
                     streams.emplace(f.id, s);
                 }
                 else {
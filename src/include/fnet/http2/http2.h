@@ -195,16 +195,7 @@ namespace futils::fnet::http2 {
             if (!handler) {
                 return Error{H2Error::internal, false, "handler is not set"};
             }
-            auto ok = handler->send_data(std::forward<decltype(body)>(body), fin);
-            if (!ok) {
-                return Error{
-                    .code = H2Error::internal,
-                    .stream = true,
-                    .debug = "failed to write data",
-                    .is_resumable = ok == http1::body::BodyResult::incomplete,
-                };
-            }
-            return no_error;
+            return handler->send_data(std::forward<decltype(body)>(body), fin);
         }
 
         template <class Body>
@@ -28,6 +28,12 @@
 #include <sys/un.h>
 #ifdef FUTILS_PLATFORM_LINUX
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <linux/tls.h>
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
 #include <linux/if.h>
 #include <netpacket/packet.h>
 #include <net/ethernet.h>
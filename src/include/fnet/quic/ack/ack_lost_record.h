@@ -49,7 +49,7 @@ namespace futils {
         };
 
         inline std::shared_ptr<ACKLostRecord> make_ack_wait() {
-            return std::allocate_shared<ACKLostRecord>(glheap_allocator<ACKLostRecord>{});
+            return std::allocate_shared<ACKLostRecord>(glheap_objpool_allocator<ACKLostRecord>{});
         }
 
         struct ACKRecorder {
@@ -1348,7 +1348,7 @@ namespace futils {
 
                 // setup datagram handler
                 using DgramT = datagram::DatagramManager<Lock, DatagramDrop>;
-                datagrams = std::allocate_shared<DgramT>(glheap_allocator<DgramT>{});
+                datagrams = std::allocate_shared<DgramT>(glheap_objpool_allocator<DgramT>{});
                 datagrams->reset(config.transport_parameters.max_datagram_frame_size, config.datagram_parameters,
                                  get_outer_self_ptr().lock(),  // for server
                                  std::move(udconfig.dgram_drop));
@@ -51,7 +51,7 @@ namespace futils {
 
         template <class TConfig>
         std::shared_ptr<Context<TConfig>> use_default_context(tls::TLSConfig&& c, log::ConnLogger log = {}) {
-            auto alc = std::allocate_shared<Context<TConfig>>(glheap_allocator<Context<TConfig>>{});
+            auto alc = std::allocate_shared<Context<TConfig>>(glheap_objpool_allocator<Context<TConfig>>{});
             auto conf = use_default_config(std::move(c), log);
             if (!alc->init(std::move(conf))) {
                 return nullptr;
@@ -163,7 +163,7 @@ namespace futils {
                 slib::vector<connid::CloseID> ids;
                 ctx.expose_closed_context(c, ids);
                 discard = true;
-                auto next = std::allocate_shared<Closed<Lock>>(glheap_allocator<Closed<Lock>>{});
+                auto next = std::allocate_shared<Closed<Lock>>(glheap_objpool_allocator<Closed<Lock>>{});
                 next->ids = std::move(ids);
                 next->ctx = std::move(c);
                 if (auto mux = this->ctx.get_multiplexer_ptr().lock()) {
@@ -180,7 +180,7 @@ namespace futils {
             }
 
             static std::shared_ptr<Opened> create() {
-                return std::allocate_shared<Opened<TConfig>>(glheap_allocator<Opened<TConfig>>{});
+                return std::allocate_shared<Opened<TConfig>>(glheap_objpool_allocator<Opened<TConfig>>{});
             }
         };
 
@@ -22,7 +22,7 @@ namespace futils {
         namespace internal {
             template <class T, class... Args>
             std::shared_ptr<T> make_ptr(Args&&... arg) {
-                return std::allocate_shared<T>(glheap_allocator<T>{}, std::forward<Args>(arg)...);
+                return std::allocate_shared<T>(glheap_objpool_allocator<T>{}, std::forward<Args>(arg)...);
             }
         }  // namespace internal
 
@@ -126,7 +126,7 @@ namespace futils {
                         return;
                     }
                     s = std::allocate_shared<BidiStream<TConfig>>(
-                        glheap_allocator<BidiStream<TConfig>>{},
+                        glheap_objpool_allocator<BidiStream<TConfig>>{},
                         id, borrow_control());
                     local_bidi.emplace(id, s);
                     handler.bidi_open(s);
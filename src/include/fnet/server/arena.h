@@ -0,0 +1,173 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+// arena - request scoped monotonic allocator
+#pragma once
+#include "../dll/glheap.h"
+#include "../../core/byte.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <scoped_allocator>
+#include <string>
+#include <utility>
+
+namespace futils {
+    namespace fnet {
+        namespace server {
+
+            // Arena is monotonic allocator
+            // deallocation is no-op and reset releases all allocations at once
+            // chunks grow by doubling and the last (largest) chunk is kept by reset
+            // so steady state request allocates nothing from heap
+            // objects allocated from arena must be destroyed before reset
+            // this is not thread safe
+            struct Arena {
+               private:
+                struct alignas(std::max_align_t) Chunk {
+                    Chunk* prev = nullptr;
+                    size_t size = 0;  // size of data following this header
+                };
+
+                Chunk* head = nullptr;
+                byte* cur = nullptr;
+                byte* end = nullptr;
+                size_t allocations = 0;  // since last reset
+                size_t bytes = 0;        // since last reset
+                size_t chunks = 0;
+
+                static constexpr size_t first_chunk_size = 4096 - sizeof(Chunk);
+
+                static byte* data(Chunk* c) {
+                    return reinterpret_cast<byte*>(c + 1);
+                }
+
+                static byte* align_up(byte* p, size_t align) {
+                    return reinterpret_cast<byte*>((std::uintptr_t(p) + align - 1) & ~(std::uintptr_t(align) - 1));
+                }
+
+                static void free_chunk(Chunk* c) {
+                    free_objpool(c, DNET_DEBUG_MEMORY_LOCINFO(true, sizeof(Chunk) + c->size, alignof(Chunk)));
+                }
+
+                byte* grow(size_t size, size_t align) {
+                    auto next = head ? head->size * 2 : first_chunk_size;
+                    while (next < size + align) {
+                        next *= 2;
+                    }
+                    auto c = static_cast<Chunk*>(alloc_objpool(sizeof(Chunk) + next, alignof(Chunk), DNET_DEBUG_MEMORY_LOCINFO(true, sizeof(Chunk) + next, alignof(Chunk))));
+                    if (!c) {
+                        return nullptr;
+                    }
+                    c->prev = head;
+                    c->size = next;
+                    head = c;
+                    chunks++;
+                    end = data(c) + next;
+                    return align_up(data(c), align);
+                }
+
+               public:
+                constexpr Arena() = default;
+                Arena(const Arena&) = delete;
+                Arena& operator=(const Arena&) = delete;
+
+                void* allocate(size_t size, size_t align) {
+                    auto p = cur ? align_up(cur, align) : nullptr;
+                    if (!p || p + size > end) {
+                        p = grow(size, align);
+                        if (!p) {
+                            return nullptr;
+                        }
+                    }
+                    cur = p + size;
+                    allocations++;
+                    bytes += size;
+                    return p;
+                }
+
+                // reset releases all allocations
+                // chunks except the largest one are returned to heap
+                void reset() {
+                    if (!head) {
+                        return;
+                    }
+                    for (auto c = head->prev; c;) {
+                        auto prev = c->prev;
+                        free_chunk(c);
+                        chunks--;
+                        c = prev;
+                    }
+                    head->prev = nullptr;
+                    cur = data(head);
+                    allocations = 0;
+                    bytes = 0;
+                }
+
+                // allocation count since last reset
+                size_t allocation_count() const {
+                    return allocations;
+                }
+
+                // allocated bytes since last reset (without padding)
+                size_t allocated_bytes() const {
+                    return bytes;
+                }
+
+                // chunks held by arena (heap allocations)
+                size_t chunk_count() const {
+                    return chunks;
+                }
+
+                ~Arena() {
+                    for (auto c = head; c;) {
+                        auto prev = c->prev;
+                        free_chunk(c);
+                        c = prev;
+                    }
+                }
+            };
+
+            // ArenaAllocator is STL allocator allocating from Arena
+            template <class T>
+            struct ArenaAllocator {
+                using value_type = T;
+                Arena* arena = nullptr;
+
+                constexpr ArenaAllocator(Arena* a)
+                    : arena(a) {}
+
+                template <class U>
+                constexpr ArenaAllocator(const ArenaAllocator<U>& o)
+                    : arena(o.arena) {}
+
+                T* allocate(size_t n) {
+                    auto a = static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+                    if (!a) {
+                        return static_cast<T*>(memory_exhausted_traits(DNET_DEBUG_MEMORY_LOCINFO(true, n * sizeof(T), alignof(T))));
+                    }
+                    return a;
+                }
+
+                void deallocate(T*, size_t) {}
+
+                constexpr friend bool operator==(const ArenaAllocator& a, const ArenaAllocator& b) {
+                    return a.arena == b.arena;
+                }
+            };
+
+            using arena_string = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+            // arena_map passes allocator to keys and values
+            // so that emplace("key", "value") constructs arena_string in same arena
+            template <class K, class V>
+            using arena_map = std::map<K, V, std::less<>, std::scoped_allocator_adaptor<ArenaAllocator<std::pair<const K, V>>>>;
+
+        }  // namespace server
+    }  // namespace fnet
+}  // namespace futils
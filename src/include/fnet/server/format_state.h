@@ -18,8 +18,11 @@ namespace futils {
             {
                 auto field = w.object();
                 field("current_acceptor_thread", servstate.current_acceptor_thread.load());
+                field("current_shard_thread", servstate.current_shard_thread.load());
                 field("current_handler_thread", servstate.current_handler_thread.load());
                 field("current_handling_handler_thread", servstate.current_handling_handler_thread.load());
+                field("sleeping_handler_thread", servstate.sleeping_handler_thread.load());
+                field("current_waiting_client", servstate.current_waiting_client.load());
                 field("waiting_async_read", servstate.waiting_async_read.load());
                 field("waiting_async_write", servstate.waiting_async_write.load());
                 field("total_async_read_invocation", servstate.total_async_read_invocation.load());
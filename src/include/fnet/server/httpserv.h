@@ -12,7 +12,10 @@
 #include "client.h"
 #include "../http/http.h"
 #include "state.h"
+#include "arena.h"
 #include "../tls/tls.h"
+#include "../http1/range.h"
+#include <file/file.h>
 
 namespace futils {
     namespace fnet {
@@ -23,6 +26,61 @@ namespace futils {
 
             struct Requester;
 
+            // chunk size of file body read on tls connection (max tls record size)
+            constexpr size_t file_body_chunk_size = 16 * 1024;
+
+            // FileBody is response body sent from [offset, offset+remain) of file
+            // on plaintext http1 connection, it is sent by Socket::write_file (sendfile) without copying to user space
+            // on tls connection (or if write_file is not supported), it is read by bounded chunks through read
+            // file is owned by holder and accessed through read so that fnetserv does not depend on file library
+            struct FileBody {
+                std::shared_ptr<void> holder;
+                std::uintptr_t handle = ~std::uintptr_t(0);
+                std::uint64_t offset = 0;
+                std::uint64_t remain = 0;
+                // returns read bytes. 0 means end of file
+                expected<size_t> (*read)(void* holder, view::wvec buf, std::uint64_t offset) = nullptr;
+                // write_file failed so read is used
+                bool no_write_file = false;
+
+                static FileBody make(file::File&& file, std::uint64_t offset, std::uint64_t length) {
+                    FileBody b;
+                    b.handle = file.native_handle();
+                    b.holder = std::allocate_shared<file::File>(glheap_objpool_allocator<file::File>(), std::move(file));
+                    b.offset = offset;
+                    b.remain = length;
+                    b.read = [](void* holder, view::wvec buf, std::uint64_t offset) -> expected<size_t> {
+                        auto res = static_cast<file::File*>(holder)->read_vec_at(&buf, 1, offset);
+                        if (!res) {
+                            return unexpect(res.error());
+                        }
+                        return *res;
+                    };
+                    return b;
+                }
+
+                // read next chunk into buf and advance
+                // returns empty buffer on end of file
+                expected<view::rvec> read_chunk(view::wvec buf) {
+                    buf = buf.substr(0, size_t((std::min)(remain, std::uint64_t(buf.size()))));
+                    auto res = read(holder.get(), buf, offset);
+                    if (!res) {
+                        return unexpect(res.error());
+                    }
+                    advance(*res);
+                    return buf.substr(0, *res);
+                }
+
+                void advance(size_t n) {
+                    offset += n;
+                    remain -= n;
+                }
+
+                explicit operator bool() const {
+                    return remain != 0;
+                }
+            };
+
             // handles tcp based transport
             // on quic based, another transport should be used
             struct Transport {
@@ -32,6 +90,13 @@ namespace futils {
                 fnet::flex_storage write_buf;
                 Client client;
                 tls::TLS tls;
+                // kTLS is enabled when write_buf is written (see may_enable_ktls_send)
+                bool ktls_pending = false;
+                // encryption of sending data is offloaded to kernel (kTLS)
+                // write_buf has plaintext and file body is sent by write_file
+                bool ktls_send = false;
+                // sent after write_buf
+                FileBody file_body;
                 http::HTTPVersion version = http::HTTPVersion::unknown;
                 std::shared_ptr<void> version_specific;
 
@@ -58,6 +123,16 @@ namespace futils {
                 }
 
                 void write_tls_data(StateContext& as) {
+                    if (ktls_send) {
+                        // records generated by TLS library (like KeyUpdate or alert)
+                        // can not be sent because record sequence number is managed by kernel
+                        auto res = tls.receive_tls_data_until_block([&](auto&&) {});
+                        if (res && *res) {
+                            as.log(log_level::err, &client.addr, error::Error("TLS record is generated after kTLS is enabled. close connection", error::Category::app));
+                            client.sock.shutdown();
+                        }
+                        return;
+                    }
                     auto res = tls.receive_tls_data_until_block([&](auto&& d) {
                         write_buf.append(d);
                     });
@@ -96,7 +171,39 @@ namespace futils {
                     }
                 }
 
+                // may_enable_ktls_send offloads encryption of sending data to kernel
+                // this must be called after ciphertext in write_buf is written to socket
+                // ciphertext still buffered in TLS library is moved to write_buf first
+                // and kTLS stays pending until it is also written (caller checks write_buf)
+                // if kernel does not support kTLS, TLS library continues encryption
+                void may_enable_ktls_send(StateContext& as) {
+                    if (!ktls_pending) {
+                        return;
+                    }
+                    write_tls_data(as);
+                    if (write_buf.size()) {
+                        return;
+                    }
+                    ktls_pending = false;
+                    byte info_buf[tls::ktls_crypto_info_size];
+                    auto info = tls.get_ktls_send_info(info_buf);
+                    if (!info) {
+                        as.log(log_level::debug, client.addr, "kTLS is not used: ", info.error());
+                        return;
+                    }
+                    if (auto res = client.sock.set_ktls_send(*info); !res) {
+                        as.log(log_level::debug, client.addr, "kTLS is not used: ", res.error());
+                        return;
+                    }
+                    ktls_send = true;
+                    as.log(log_level::debug, "kTLS send enabled", client.addr);
+                }
+
                 void may_shutdown_tls(StateContext& as) {
+                    if (ktls_send) {
+                        // close_notify can not be sent
+                        return;
+                    }
                     if (tls) {
                         tls.shutdown();
                         write_tls_data(as);
@@ -107,7 +214,7 @@ namespace futils {
                     if (d.size() == 0) {
                         return;
                     }
-                    if (tls) {
+                    if (tls && !ktls_send) {
                         auto ok = tls.write(d);
                         if (!ok) {
                             if (!tls::isTLSBlock(ok.error())) {
@@ -129,13 +236,46 @@ namespace futils {
             struct Requester {
                private:
                 friend bool& response_sent(Requester& req);
+                friend void reset_request(Requester& req);
+                friend FileBody take_file_body(Requester& req);
+                // declared before user_data so that user_data allocated from arena is destroyed first
+                Arena arena_;
                 std::shared_ptr<void> user_data;
                 bool response_sent = false;
+                FileBody file_body;
+
+                void add_length_and_connection(auto& header, std::uint64_t length) {
+                    number::Array<char, 40, true> buffer{};
+                    number::to_string(buffer, length);
+                    header.emplace("Content-Length", buffer.c_str());
+                    // handle keep-alive or close
+                    if (auto h1 = http.http1()) {
+                        if (h1->read_ctx.on_no_body_semantics() && h1->read_ctx.is_keep_alive()) {
+                            header.emplace("Connection", "keep-alive");
+                        }
+                        else {
+                            header.emplace("Connection", "close");
+                        }
+                    }
+                }
 
                public:
                 http::HTTP http;
                 fnet::NetAddrPort addr;
 
+                // arena is request scoped memory
+                // on http1 keep-alive connection, user data and arena are released at once after response is sent
+                // on http2, each stream has its own Requester
+                Arena& arena() {
+                    return arena_;
+                }
+
+                // allocator for containers of header, response and scratch space of the request
+                template <class T = char>
+                ArenaAllocator<T> allocator() {
+                    return ArenaAllocator<T>(&arena_);
+                }
+
                 template <class T>
                 std::shared_ptr<T> get_or_set_user_data(auto&& create) {
                     auto setter = [&](auto&& to_set) {
@@ -149,22 +289,85 @@ namespace futils {
                     if (response_sent) {
                         return error::Error("http response already sent", error::Category::app);
                     }
-                    number::Array<char, 40, true> buffer{};
-                    number::to_string(buffer, body.size());
-                    header.emplace("Content-Length", buffer.c_str());
-                    // handle keep-alive or close
-                    if (auto h1 = http.http1()) {
-                        if (h1->read_ctx.on_no_body_semantics() && h1->read_ctx.is_keep_alive()) {
-                            header.emplace("Connection", "keep-alive");
+                    add_length_and_connection(header, body.size());
+                    if (auto err = http.write_response(status, header, body)) {
+                        return err;
+                    }
+                    response_sent = true;
+                    return {};
+                }
+
+                // respond_file responds file content
+                // range is value of Range header of request (empty if not present)
+                // status is 200, 206 or 416 depending on range and Accept-Ranges, Content-Range are added
+                // on http1, body is sent by transport after header without being copied to http output
+                // on other versions, body is read by chunks and written through http
+                // method is method of request. if it is HEAD, only header (with Content-Length of body) is sent
+                error::Error respond_file(auto&& header, file::File&& file, std::string_view range = {}, std::string_view method = {}) {
+                    if (response_sent) {
+                        return error::Error("http response already sent", error::Category::app);
+                    }
+                    const std::uint64_t size = file.size();
+                    http1::ByteRange r;
+                    auto status = StatusCode::http_ok;
+                    number::Array<char, 80, true> content_range{};
+                    switch (http1::parse_byte_range(range, size, r)) {
+                        case http1::ByteRangeResult::partial:
+                            status = StatusCode::http_partial_content;
+                            strutil::append(content_range, "bytes ");
+                            number::to_string(content_range, r.offset);
+                            content_range.push_back('-');
+                            number::to_string(content_range, r.offset + r.length - 1);
+                            content_range.push_back('/');
+                            number::to_string(content_range, size);
+                            break;
+                        case http1::ByteRangeResult::unsatisfiable:
+                            status = StatusCode::http_range_not_satisfiable;
+                            strutil::append(content_range, "bytes */");
+                            number::to_string(content_range, size);
+                            r = {};
+                            break;
+                        default:
+                            break;
+                    }
+                    header.emplace("Accept-Ranges", "bytes");
+                    if (content_range.size()) {
+                        header.emplace("Content-Range", content_range.c_str());
+                    }
+                    add_length_and_connection(header, r.length);
+                    if (method == "HEAD") {
+                        if (auto err = http.write_response(status, header)) {
+                            return err;
                         }
-                        else {
-                            header.emplace("Connection", "close");
+                        response_sent = true;
+                        return {};
+                    }
+                    auto body = FileBody::make(std::move(file), r.offset, r.length);
+                    if (http.http1()) {
+                        if (auto err = http.write_response(status, header)) {
+                            return err;
                         }
+                        file_body = std::move(body);
+                        response_sent = true;
+                        return {};
                     }
-                    if (auto err = http.write_response(status, header, body)) {
+                    if (auto err = http.write_response(status, header, {}, !body)) {
                         return err;
                     }
                     response_sent = true;
+                    byte buf[file_body_chunk_size];
+                    while (body) {
+                        auto chunk = body.read_chunk(buf);
+                        if (!chunk) {
+                            return chunk.error();
+                        }
+                        if (chunk->empty()) {
+                            return error::Error("file is shorter than expected", error::Category::app);
+                        }
+                        if (auto err = http.write_body(*chunk, !body)) {
+                            return err;
+                        }
+                    }
                     return {};
                 }
             };
@@ -173,6 +376,9 @@ namespace futils {
                 tls::TLSConfig tls_config;
                 // http2 is used even if cleartext
                 bool prefer_http2 = false;
+                // offload encryption of sending data to kernel after TLS handshake if possible
+                // tls_config.set_ktls_enabled(true) is also required
+                bool ktls = false;
                 std::uint32_t normal_port = 0;
                 std::uint32_t secure_port = 0;
                 void (*next)(void*, std::shared_ptr<Requester>&& req, StateContext s);
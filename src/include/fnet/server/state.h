@@ -17,12 +17,15 @@
 #include "../../thread/channel.h"
 #include "../../thread/concurrent_queue.h"
 #include <memory>
+#include <vector>
 #include <fnet/quic/server/server.h>
 #include <fnet/quic/quic.h>
 
 namespace futils {
     namespace fnet {
         namespace server {
+            constexpr std::uint64_t default_thread_sleep = 100;
+
             struct Counter {
                 std::atomic_flag end_flag;
 
@@ -34,6 +37,12 @@ namespace futils {
                 std::atomic_uint32_t current_handler_thread;
                 // current acceptor thread
                 std::atomic_uint32_t current_acceptor_thread;
+                // current sharded listener thread
+                std::atomic_uint32_t current_shard_thread;
+                // current handler thread blocking on IOEvent
+                std::atomic_uint32_t sleeping_handler_thread;
+                // current accepted clients waiting for handler thread
+                std::atomic_uint32_t current_waiting_client;
                 // current waiting IOCP/epoll read call count
                 std::atomic_uint32_t waiting_async_read;
                 // current waiting IOCP/epoll write call count
@@ -65,7 +74,8 @@ namespace futils {
                 std::atomic_uint32_t max_handler_thread;
                 // recommended waiting handler thread count
                 std::atomic_uint32_t waiting_recommend;
-                // sleep for (millisecond)
+                // max time idle handler thread blocks on IOEvent (millisecond)
+                // 0 means default_thread_sleep
                 std::atomic_uint64_t thread_sleep;
                 // max skip reducing chance
                 std::atomic_uint32_t reduce_skip;
@@ -121,6 +131,25 @@ namespace futils {
 
             struct State;
 
+            // QUICRecvBatch is buffers for quic_recv_handler to receive datagrams at once
+            struct QUICRecvBatch;
+
+            // Shard is per thread listener and IOEvent of add_sharded_listener
+            struct Shard;
+
+            struct ShardConfig {
+                // number of shard thread. 0 means std::thread::hardware_concurrency()
+                std::uint32_t shards = 0;
+                int backlog = 10000;
+                bool ipv6only = false;
+                // pin shard thread i to cpu i (linux only)
+                bool pin_cpu = false;
+                // set SO_INCOMING_CPU of shard i to cpu i
+                // so that kernel prefers listener on cpu processing packet (linux only)
+                bool incoming_cpu = false;
+                event::IOBackend backend = event::IOBackend::platform_default;
+            };
+
             struct QUICServerState {
                 std::weak_ptr<State> state;
                 fnet::quic::server::MultiplexerConfig<fnet::quic::use::smartptr::DefaultTypeConfig> original_config;
@@ -141,13 +170,22 @@ namespace futils {
                 ServerEntry handler;
                 void* ctx;
                 log_t log_evt = nullptr;
+                std::vector<std::shared_ptr<Shard>> shards;
 
                 void check_and_start();
+                // wake_handler wakes up one handler thread blocking on IOEvent if exists
+                void wake_handler();
                 static void handler_thread(std::shared_ptr<State> state);
                 static void accept_thread(Socket, std::shared_ptr<State> state);
+                static void shard_thread(std::shared_ptr<Shard> shard, std::shared_ptr<State> state);
+                void arm_shard_accept(Shard* shard);
+                void handle_accepted(Client&& cl);
+                // enqueue_local queues w to shard of current thread
+                // returns false if current thread is not shard thread
+                static bool enqueue_local(DeferredCallback& w);
 
                 static void quic_send_thread(std::shared_ptr<State> state, fnet::Socket s, std::shared_ptr<quic_handler> handler);
-                static void quic_recv_handler(std::shared_ptr<State> state, fnet::Socket s, std::shared_ptr<quic_handler> handler);
+                static void quic_recv_handler(std::shared_ptr<State> state, fnet::Socket s, std::shared_ptr<quic_handler> handler, std::shared_ptr<QUICRecvBatch> batch);
                 static void quic_send_scheduler(std::shared_ptr<State> state, std::shared_ptr<quic_handler> handler);
                 static void quic_recv_scheduler(std::shared_ptr<State> state, std::shared_ptr<quic_handler> handler);
                 friend struct StateContext;
@@ -179,6 +217,16 @@ namespace futils {
                 // and invokes user defined handlers
                 void add_accept_thread(Socket&& listener);
 
+                // add_sharded_listener opens one SO_REUSEPORT listener per shard bound to addr
+                // and launches shard_thread for each of them
+                // shard thread owns IOEvent and runs accept, user defined handlers and I/O callbacks by itself
+                // so connection stays on accepting thread for whole lifetime without handler_thread
+                // if port of addr is 0, port chosen for first shard is shared by others
+                // returns bound address
+                // this is not thread safe and should be called before serving
+                // currently linux only
+                expected<NetAddrPort> add_sharded_listener(const SockAddr& addr, ShardConfig conf = {});
+
                 // add_quic_thread launches new quic_send_thread, quic_send_scheduler, quic_recv_scheduler and start quic_recv_handler
                 // some fields of serv_conf will be modified
                 // serv_conf.app_ctx will be set to QUICServerState with this pointer and original_config
@@ -364,8 +412,12 @@ namespace futils {
 
                 void enqueue_callback(DeferredCallback&& w) {
                     count.total_queued++;
+                    if (enqueue_local(w)) {
+                        return;  // run on same shard thread
+                    }
                     count.current_enqueued++;
                     io_notify << Queued{std::move(w)};
+                    wake_handler();
                 }
             };
 
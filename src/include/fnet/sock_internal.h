@@ -16,6 +16,7 @@
 #include "socket.h"
 #include "event/io.h"
 #include <platform/detect.h>
+#include <thread/lite_lock.h>
 
 namespace futils::fnet {
     struct SockTable;
@@ -30,6 +31,9 @@ namespace futils::fnet {
         std::uintptr_t sock = ~std::uintptr_t(0);
         event::IOEvent* event = nullptr;
         std::atomic_uint32_t refs;
+        // called when only one reference remains
+        // io_uring backend uses this to release reference held by multishot operation
+        void (*on_last_ref)(SockTable*) = nullptr;
 
         SockTable()
             : refs(1) {}
@@ -39,13 +43,17 @@ namespace futils::fnet {
         }
 
         std::uint32_t decr() {
-            if (0 == --refs) {
+            auto r = --refs;
+            if (r == 0) {
                 auto sock = this->sock;
                 destroy_platform(this);
                 sockclose(sock);
                 return 0;
             }
-            return refs;
+            if (r == 1 && on_last_ref) {
+                on_last_ref(this);
+            }
+            return r;
         }
     };
 
@@ -202,18 +210,106 @@ namespace futils::fnet {
     constexpr auto sizeof_WinSockTable = sizeof(WinSockTable);
 #elif defined(FUTILS_PLATFORM_LINUX)
     struct EpollTable;
+    struct UringMultishot;
+
+    // operation state of io_uring backend
+    // kernel refers these until completion
+    struct UringIOData {
+        msghdr msg;
+        iovec iov;
+        sockaddr_storage addr;
+        socklen_t addr_len = 0;
+        std::atomic_bool inflight;  // single shot operation is submitted
+    };
+
+    // handshake between thread registering async operation and threads completing or canceling it
+    // registering thread sets callback then tries io, so epoll may report event before io returns
+    // completion and cancel must not take callback until registration ends
+    // state: 0 = idle, 1 = registering, 2 = registering and may have waiters
+    struct EpollRegisterState {
+        std::atomic<std::uint32_t> state = 0;
+
+        static constexpr std::uint32_t idle = 0;
+        static constexpr std::uint32_t registering = 1;
+        static constexpr std::uint32_t waiting = 2;
+
+        void begin() {
+            state.store(registering, std::memory_order_relaxed);
+        }
+
+        void end() {
+            if (state.exchange(idle, std::memory_order_release) == waiting) {
+                state.notify_all();  // completion and cancel may wait at same time
+            }
+        }
+
+        // wait_idle blocks until registration ends
+        // registration only does non-blocking system call so waiting is short
+        void wait_idle() {
+            auto s = state.load(std::memory_order_acquire);
+            for (auto i = thread::default_spin_count(); i > 0 && s != idle; i--) {
+                thread::cpu_relax();
+                s = state.load(std::memory_order_acquire);
+            }
+            while (s != idle) {
+                if (s == registering && !state.compare_exchange_weak(s, waiting, std::memory_order_acquire, std::memory_order_acquire)) {
+                    continue;  // s is reloaded
+                }
+                state.wait(waiting, std::memory_order_acquire);
+                s = state.load(std::memory_order_acquire);
+            }
+        }
+    };
+
     struct EpollIOTableHeader : IOTableHeader {
         NotifyCallback cb;
         CancelableLock l;
         EpollTable* base;
-        std::atomic_bool epoll_lock;
+        EpollRegisterState reg;
+        UringIOData uring;
     };
 
     struct EpollTable : SockTable {
         EpollIOTableHeader r;
         EpollIOTableHeader w;
+        void* uring = nullptr;  // ring if event uses io_uring backend
+        std::atomic<UringMultishot*> multishot;
     };
 
+    // io_uring backend (uring.cpp)
+    namespace uring {
+        // low bits of user_data of submission
+        // epoll_event.data.ptr of epoll backend is EpollTable* so these bits are 0
+        constexpr std::uint64_t kind_mask = 7;
+        constexpr std::uint64_t kind_single = 1;  // EpollIOTableHeader*
+        constexpr std::uint64_t kind_recv = 2;    // EpollTable* with multishot recv
+        constexpr std::uint64_t kind_accept = 3;  // EpollTable* with multishot accept
+        constexpr std::uint64_t kind_wakeup = 4;  // IOEvent::notify. also used as epoll_event.data.u64 of eventfd
+
+        expected<void*> make_ring();
+        void destroy_ring(void* ring);
+        expected<size_t> wait(void* ring, std::uint32_t timeout, void (*f)(void*, void*), void* rt);
+        expected<void> notify(void* ring);
+
+        void handle_completion(std::uint64_t user_data, std::int32_t res);
+        expected<void> cancel(EpollTable* t, EpollIOTableHeader& io, std::uint64_t cancel_code);
+        void on_last_ref(SockTable* t);
+        void destroy(EpollTable* t);
+
+        expected<AsyncResult> read_async(EpollTable* t, view::wvec buffer, void* c, stream_notify_t notify, std::uint32_t flag);
+        expected<AsyncResult> write_async(EpollTable* t, view::rvec buffer, void* c, stream_notify_t notify, std::uint32_t flag);
+        expected<AsyncResult> readfrom_async(EpollTable* t, view::wvec buffer, NetAddrPort& addr, void* c, recvfrom_notify_t notify, std::uint32_t flag);
+        expected<AsyncResult> writeto_async(EpollTable* t, view::rvec buffer, const NetAddrPort& addr, void* c, stream_notify_t notify, std::uint32_t flag);
+        expected<AcceptAsyncResult<Socket>> accept_async(EpollTable* t, NetAddrPort& addr, void* c, accept_notify_t notify, std::uint32_t flag);
+        expected<AsyncResult> connect_async(EpollTable* t, const NetAddrPort& addr, void* c, stream_notify_t notify, std::uint32_t flag);
+
+        // data received by multishot recv must be read before socket
+        // returns nullopt if multishot recv is not used
+        std::optional<expected<view::wvec>> read_queued(SockTable* t, view::wvec data, bool is_stream);
+        // returns nullopt if multishot accept is not used
+        std::optional<expected<std::pair<Socket, NetAddrPort>>> accept_queued(SockTable* t);
+    }  // namespace uring
+
 #endif
 
     void set_nonblock(std::uintptr_t sock, bool);
@@ -223,6 +319,7 @@ namespace futils::fnet {
 
     std::pair<sockaddr*, int> NetAddrPort_to_sockaddr(sockaddr_storage* addr, const NetAddrPort&);
     expected<std::uintptr_t> socket_platform(SockAttr attr);
-    expected<Socket> setup_socket(std::uintptr_t sock, event::IOEvent* event);
+    // if nonblock is true, sock is already non-blocking (e.g. accept4 with SOCK_NONBLOCK)
+    expected<Socket> setup_socket(std::uintptr_t sock, event::IOEvent* event, bool nonblock = false);
 
 }  // namespace futils::fnet
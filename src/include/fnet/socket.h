@@ -20,6 +20,7 @@
 #include "storage.h"
 #include "event/io.h"
 #include "async.h"
+#include "../view/span.h"
 
 namespace futils {
     namespace fnet {
@@ -302,12 +303,33 @@ namespace futils {
             // returns read bytes and address
             expected<std::pair<view::wvec, NetAddrPort>> readfrom(view::wvec data, int flag = 0, bool is_stream = false);
 
+            // write_file sends [offset, offset+len) of file to stream socket without copying to user space
+            // file is native file handle (e.g. file::File::native_handle())
+            // on linux, this is done by sendfile. on other platforms, this returns error
+            // returns sent bytes. if it is less than len, remaining are not sent (e.g. would block)
+            expected<size_t> write_file(std::uintptr_t file, std::uint64_t offset, size_t len);
+
             // returns read bytes and address
             expected<view::rvec> writemsg(const NetAddrPort& addr, SockMsg<view::rvec> msg, int flag = 0);
 
             // returns read bytes and address
             expected<std::pair<view::wvec, NetAddrPort>> readmsg(SockMsg<view::wvec> msg, int flag = 0, bool is_stream = true);
 
+            // writeto_many sends each datagram to its address
+            // on linux, this is done by sendmmsg with a few system calls
+            // returns number of sent datagrams. if it is less than msgs.size(), remaining are not sent (e.g. would block)
+            // error is returned only when no datagram is sent
+            expected<size_t> writeto_many(view::rspan<Datagram<view::rvec>> msgs, int flag = 0);
+
+            // readfrom_many receives datagrams into msgs until msgs is filled or socket would block
+            // on linux, this is done by recvmmsg with a few system calls
+            // msgs[i].data and msgs[i].control are shrunk to received size and msgs[i].addr is set to sender address
+            // returns number of received datagrams
+            // error (including would block) is returned only when no datagram is received
+            // on linux, blocking socket waits only until first datagram is received (MSG_WAITFORONE)
+            // on other platforms, socket should be non-blocking otherwise this waits until msgs is filled
+            expected<size_t> readfrom_many(view::wspan<Datagram<view::wvec>> msgs, int flag = 0);
+
             // wait_readable waits socket until to be readable using select function or until timeout
             expected<void> wait_readable(std::uint32_t sec, std::uint32_t usec);
             // wait_readable waits socket until to be writable using select function or until timeout
@@ -406,6 +428,25 @@ namespace futils {
             // on linux, this function always return false
             expected<void> set_exclusive_use(bool exclusive);
 
+            // set_reuse_port sets SO_REUSEPORT
+            // on linux, sockets bound to same address with this option share incoming connections
+            // and kernel distributes them to each listener by hash of connection
+            // on windows, this function always return error
+            expected<void> set_reuse_port(bool reuse);
+
+            // set_incoming_cpu sets SO_INCOMING_CPU
+            // on linux, listener in SO_REUSEPORT group with same cpu as one processing packet is preferred
+            // on windows, this function always return error
+            expected<void> set_incoming_cpu(int cpu);
+
+            // set_ktls_send sets TCP_ULP "tls" and TLS_TX so that kernel encrypts records written to this socket
+            // crypto_info is linux struct tls12_crypto_info_* (see tls::TLS::get_ktls_send_info)
+            // after this, write and write_file take plaintext (sendfile works on TLS connection)
+            // if kernel has no tls ULP (ENOENT), this returns error and following calls in this process fail without syscall
+            // (latched until process exit; tls module loaded later is not used)
+            // on windows, this function always return error
+            expected<void> set_ktls_send(view::rvec crypto_info);
+
             // set_ipv6only sets IPV6_V6ONLY
             // if this is false,you can accept both ipv6 and ipv4
             // default value is different between linux(false) and windows(true)
@@ -454,6 +495,13 @@ namespace futils {
             expected<void> set_gso(bool enable);
             expected<bool> get_gso();
 
+            // GRO is Generic Receive Offload
+            // if enabled, kernel may coalesce datagrams from same peer and
+            // segment size is reported by UDP_GRO cmsg (see fnet/gso.h)
+            // this is linux only
+            expected<void> set_gro(bool enable);
+            expected<bool> get_gro();
+
             // set_packet_info sets IP_PKTINFO
             expected<void> set_recv_packet_info_v4(bool enable);
             expected<bool> get_recv_packet_info_v4();
@@ -485,6 +533,8 @@ namespace futils {
 
             expected<AsyncResult> read_async(view::wvec buffer, void* c, stream_notify_t notify, std::uint32_t flag = 0);
             expected<AsyncResult> write_async(view::rvec buffer, void* c, stream_notify_t notify, std::uint32_t flag = 0);
+            // datagram received into buffer by readfrom_async has no control message (like UDP_GRO segment size)
+            // if control message is needed, peek (MSG_PEEK) to wait for readiness and read by readfrom_many in callback
             expected<AsyncResult> readfrom_async(view::wvec buffer, NetAddrPort& addr, void* c, recvfrom_notify_t notify, std::uint32_t flag = 0);
             expected<AsyncResult> writeto_async(view::rvec buffer, const NetAddrPort& addr, void* c, stream_notify_t notify, std::uint32_t flag = 0);
 
@@ -130,6 +130,14 @@ namespace futils {
 
                 expected<void> set_session_callback(bool (*cb)(Session&& sess, void* arg), void* arg);
 
+                // if enabled, TLS connections created from this config track
+                // application traffic secret and record sequence number to offload encryption to kernel (kTLS)
+                // see TLS::get_ktls_send_info
+                // if enabled, TLS 1.3 cipher suite of TLS created by create_tls is limited to TLS_AES_128_GCM_SHA256 (OpenSSL only)
+                // cipher suites of this config itself are not changed
+                // key log callback set by set_key_log_callback is still called
+                expected<void> set_ktls_enabled(bool enable);
+
                 constexpr operator bool() const {
                     return ctx != nullptr;
                 }
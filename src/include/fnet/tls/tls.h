@@ -30,6 +30,10 @@ namespace futils {
 
             fnet_dll_export(bool) isTLSBlock(const error::Error& err);
 
+            // size of linux struct tls12_crypto_info_aes_gcm_128
+            // returned by TLS::get_ktls_send_info
+            constexpr auto ktls_crypto_info_size = 40;
+
             // TLS is wrapper class of SSL
             struct fnet_class_export TLS {
                private:
@@ -160,6 +164,15 @@ namespace futils {
                 bool in_handshake();
 
                 expected<view::rvec> get_tls_version();
+
+                // get_ktls_send_info returns crypto info for Socket::set_ktls_send
+                // (linux struct tls12_crypto_info_aes_gcm_128) which has current application write key and record sequence number
+                // TLSConfig::set_ktls_enabled(true) is required before create_tls
+                // currently only TLS 1.3 with TLS_AES_128_GCM_SHA256 is supported
+                // all data from receive_tls_data must be sent before Socket::set_ktls_send
+                // after that, write and shutdown must not be called and
+                // data from receive_tls_data (like KeyUpdate) can not be sent anymore
+                expected<view::wvec> get_ktls_send_info(view::wvec buffer);
             };
 
             void get_error_strings(int (*cb)(const char*, size_t, void*), void* user);
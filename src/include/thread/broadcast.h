@@ -0,0 +1,435 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+// broadcast - single producer broadcast ring
+// unlike ForkChan, an element is written once into shared ring and
+// each subscriber only has read cursor, so cost of publish does not depend on number of subscribers
+// see also LMAX Disruptor (https://lmax-exchange.github.io/disruptor/)
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "lite_lock.h"
+#include "../wrap/light/smart_ptr.h"
+
+namespace futils {
+    namespace thread {
+
+        enum class BroadcastPolicy {
+            // producer waits for the slowest subscriber
+            block,
+            // subscriber that is a whole ring behind is detached and reported as lagged
+            drop_slow,
+            // producer never waits and subscriber that is overrun skips to oldest alive element
+            // requires trivially copyable T, otherwise drop_slow is used
+            overwrite,
+        };
+
+        enum class BroadcastState {
+            ok,
+            empty,
+            // some elements were lost. cursor is moved forward and next receive continues
+            lagged,
+            closed,
+        };
+
+        template <class T>
+        struct BroadcastRing {
+            static constexpr bool can_overwrite = std::is_trivially_copyable_v<T>;
+
+           private:
+            static constexpr std::uint64_t reading_bit = std::uint64_t(1) << 62;
+            static constexpr std::uint64_t detached_bit = std::uint64_t(1) << 63;
+            static constexpr std::uint64_t seq_mask = reading_bit - 1;
+
+            // stamp is 2*seq+1 while writing and 2*seq+2 after written
+            struct alignas(64) Slot {
+                std::atomic<std::uint64_t> stamp = 0;
+                T value{};
+            };
+
+           public:
+            struct alignas(64) Cursor {
+                std::atomic<std::uint64_t> next = 0;
+            };
+
+           private:
+            std::unique_ptr<Slot[]> slots;
+            std::uint64_t mask = 0;
+            BroadcastPolicy policy;
+
+            // producer local
+            alignas(64) std::uint64_t head = 0;
+            std::uint64_t gate = 0;
+
+            alignas(64) std::atomic<std::uint64_t> published = 0;
+            std::atomic<std::uint32_t> read_epoch = 0;
+            std::atomic<std::uint32_t> read_waiters = 0;
+            std::atomic_flag closed;
+
+            alignas(64) std::atomic<std::uint32_t> progress = 0;
+            std::atomic<bool> producer_waiting = false;
+
+            LiteLock lock_;
+            std::vector<Cursor*> cursors;
+
+            std::uint64_t capacity() const {
+                return mask + 1;
+            }
+
+            // returns true if seq can be written
+            // on drop_slow, cursors that is a whole ring behind are detached
+            bool refresh_gate(std::uint64_t seq) {
+                std::scoped_lock l{lock_};
+                auto min = seq;
+                for (auto c : cursors) {
+                    auto v = c->next.load(std::memory_order_acquire);
+                    while (!(v & detached_bit) && (v & seq_mask) + capacity() <= seq) {
+                        if (policy == BroadcastPolicy::block) {
+                            break;
+                        }
+                        if (v & reading_bit) {
+                            // reading slot that will be overwritten. wait for it
+                            std::this_thread::yield();
+                            v = c->next.load(std::memory_order_acquire);
+                            continue;
+                        }
+                        if (c->next.compare_exchange_weak(v, v | detached_bit, std::memory_order_acq_rel)) {
+                            v |= detached_bit;
+                        }
+                    }
+                    if (!(v & detached_bit) && (v & seq_mask) < min) {
+                        min = v & seq_mask;
+                    }
+                }
+                gate = min;
+                return seq < gate + capacity();
+            }
+
+            void wait_progress(std::uint64_t seq) {
+                for (auto i = 0; i < 16; i++) {
+                    if (refresh_gate(seq)) {
+                        return;
+                    }
+                    std::this_thread::yield();
+                }
+                while (true) {
+                    producer_waiting.store(true, std::memory_order_seq_cst);
+                    auto e = progress.load(std::memory_order_seq_cst);
+                    if (refresh_gate(seq) || closed.test()) {
+                        producer_waiting.store(false, std::memory_order_relaxed);
+                        return;
+                    }
+                    progress.wait(e, std::memory_order_seq_cst);
+                }
+            }
+
+            void notify_readers() {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (read_waiters.load(std::memory_order_relaxed) != 0) {
+                    read_epoch.fetch_add(1, std::memory_order_relaxed);
+                    read_epoch.notify_all();
+                }
+            }
+
+            void advance(Cursor& c, std::uint64_t next) {
+                if (policy == BroadcastPolicy::block) {
+                    c.next.store(next, std::memory_order_seq_cst);
+                    if (producer_waiting.load(std::memory_order_seq_cst)) {
+                        progress.fetch_add(1, std::memory_order_relaxed);
+                        progress.notify_one();
+                    }
+                }
+                else {
+                    c.next.store(next, std::memory_order_release);
+                }
+            }
+
+           public:
+            // capacity is rounded up to power of 2
+            explicit BroadcastRing(size_t cap, BroadcastPolicy policy = BroadcastPolicy::block)
+                : policy(policy == BroadcastPolicy::overwrite && !can_overwrite ? BroadcastPolicy::drop_slow : policy) {
+                size_t n = 2;
+                while (n < cap) {
+                    n <<= 1;
+                }
+                slots = std::make_unique<Slot[]>(n);
+                mask = n - 1;
+            }
+
+            BroadcastRing(const BroadcastRing&) = delete;
+
+            // called by producer only
+            bool publish(T&& t) {
+                if (closed.test()) {
+                    return false;
+                }
+                auto seq = head;
+                if (policy != BroadcastPolicy::overwrite && seq >= gate + capacity()) {
+                    if (policy == BroadcastPolicy::block) {
+                        wait_progress(seq);
+                        if (closed.test()) {
+                            return false;
+                        }
+                    }
+                    else {
+                        refresh_gate(seq);
+                    }
+                }
+                auto& slot = slots[seq & mask];
+                if (policy == BroadcastPolicy::overwrite) {
+                    // seqlock write
+                    slot.stamp.store(2 * seq + 1, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_release);
+                    slot.value = std::move(t);
+                }
+                else {
+                    slot.value = std::move(t);
+                }
+                slot.stamp.store(2 * seq + 2, std::memory_order_release);
+                head = seq + 1;
+                published.store(seq + 1, std::memory_order_release);
+                notify_readers();
+                return true;
+            }
+
+            void close() {
+                if (closed.test_and_set()) {
+                    return;
+                }
+                read_epoch.fetch_add(1, std::memory_order_seq_cst);
+                read_epoch.notify_all();
+                progress.fetch_add(1, std::memory_order_seq_cst);
+                progress.notify_all();
+            }
+
+            bool is_closed() const {
+                return closed.test();
+            }
+
+            std::uint64_t published_count() const {
+                return published.load(std::memory_order_acquire);
+            }
+
+            // new subscriber receives elements published after this call
+            void attach(Cursor& c) {
+                std::scoped_lock l{lock_};
+                c.next.store(published.load(std::memory_order_acquire), std::memory_order_release);
+                if (policy != BroadcastPolicy::overwrite) {
+                    cursors.push_back(&c);
+                }
+            }
+
+            void detach(Cursor& c) {
+                std::scoped_lock l{lock_};
+                std::erase(cursors, &c);
+                // detached cursor may be the slowest one producer is waiting for
+                if (policy == BroadcastPolicy::block && producer_waiting.load(std::memory_order_seq_cst)) {
+                    progress.fetch_add(1, std::memory_order_relaxed);
+                    progress.notify_one();
+                }
+            }
+
+            // read calls fn(const T&) with next element without copy
+            // on overwrite policy, element is copied before fn is called
+            // dropped is incremented by number of lost elements when lagged
+            BroadcastState read(Cursor& c, std::uint64_t& dropped, auto&& fn) {
+                auto v = c.next.load(std::memory_order_relaxed);
+                if (v & detached_bit) {
+                    // rejoin from latest. this must be serialized with refresh_gate
+                    // so that producer never has gate newer than rejoined cursor
+                    std::scoped_lock l{lock_};
+                    auto now = published.load(std::memory_order_acquire);
+                    dropped += now - (v & seq_mask);
+                    c.next.store(now, std::memory_order_release);
+                    return BroadcastState::lagged;
+                }
+                auto seq = v & seq_mask;
+                auto& slot = slots[seq & mask];
+                auto stamp = slot.stamp.load(std::memory_order_acquire);
+                if (stamp < 2 * seq + 2) {
+                    if (closed.test() && seq >= published.load(std::memory_order_acquire)) {
+                        return BroadcastState::closed;
+                    }
+                    return BroadcastState::empty;
+                }
+                if (policy == BroadcastPolicy::overwrite) {
+                    if constexpr (can_overwrite) {
+                        if (stamp == 2 * seq + 2) {
+                            alignas(T) unsigned char buf[sizeof(T)];
+                            std::memcpy(buf, &slot.value, sizeof(T));
+                            std::atomic_thread_fence(std::memory_order_acquire);
+                            if (slot.stamp.load(std::memory_order_relaxed) == stamp) {
+                                c.next.store(seq + 1, std::memory_order_release);
+                                fn(*std::launder(reinterpret_cast<const T*>(buf)));
+                                return BroadcastState::ok;
+                            }
+                        }
+                        // overrun. skip to oldest element that is not overwritten soon
+                        auto now = published.load(std::memory_order_acquire);
+                        auto next = now > capacity() ? now - capacity() + 1 : 0;
+                        if (next < seq + 1) {
+                            next = seq + 1;
+                        }
+                        dropped += next - seq;
+                        c.next.store(next, std::memory_order_release);
+                        return BroadcastState::lagged;
+                    }
+                }
+                if (policy == BroadcastPolicy::drop_slow) {
+                    // tell producer not to overwrite this slot
+                    if (!c.next.compare_exchange_strong(v, v | reading_bit, std::memory_order_acq_rel)) {
+                        return read(c, dropped, fn);  // detached just now
+                    }
+                }
+                fn(static_cast<const T&>(slot.value));
+                advance(c, seq + 1);
+                return BroadcastState::ok;
+            }
+
+            BroadcastState wait_read(Cursor& c, std::uint64_t& dropped, auto&& fn) {
+                for (;;) {
+                    for (auto i = 0; i < 16; i++) {
+                        auto res = read(c, dropped, fn);
+                        if (res != BroadcastState::empty) {
+                            return res;
+                        }
+                        std::this_thread::yield();
+                    }
+                    read_waiters.fetch_add(1, std::memory_order_seq_cst);
+                    auto e = read_epoch.load(std::memory_order_seq_cst);
+                    auto res = read(c, dropped, fn);
+                    if (res != BroadcastState::empty) {
+                        read_waiters.fetch_sub(1, std::memory_order_relaxed);
+                        return res;
+                    }
+                    read_epoch.wait(e, std::memory_order_seq_cst);
+                    read_waiters.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+
+            std::uint64_t lag(const Cursor& c) const {
+                auto v = c.next.load(std::memory_order_acquire);
+                return published.load(std::memory_order_acquire) - (v & seq_mask);
+            }
+        };
+
+        template <class T>
+        struct BroadcastReader {
+           private:
+            wrap::shared_ptr<BroadcastRing<T>> ring;
+            std::unique_ptr<typename BroadcastRing<T>::Cursor> cursor;
+            std::uint64_t dropped_ = 0;
+            bool blocking = false;
+
+           public:
+            BroadcastReader() = default;
+            BroadcastReader(wrap::shared_ptr<BroadcastRing<T>>& r)
+                : ring(r), cursor(std::make_unique<typename BroadcastRing<T>::Cursor>()) {
+                ring->attach(*cursor);
+            }
+
+            BroadcastReader(BroadcastReader&&) = default;
+
+            BroadcastReader& operator=(BroadcastReader&& r) {
+                if (this == &r) {
+                    return *this;
+                }
+                if (ring && cursor) {
+                    ring->detach(*cursor);
+                }
+                ring = std::move(r.ring);
+                cursor = std::move(r.cursor);
+                dropped_ = r.dropped_;
+                blocking = r.blocking;
+                return *this;
+            }
+
+            ~BroadcastReader() {
+                if (ring && cursor) {
+                    ring->detach(*cursor);
+                }
+            }
+
+            void set_blocking(bool flag) {
+                blocking = flag;
+            }
+
+            // receive copy of next element
+            BroadcastState operator>>(T& t) {
+                return read([&](const T& v) { t = v; });
+            }
+
+            // call fn(const T&) with next element without copy (except overwrite policy)
+            BroadcastState read(auto&& fn) {
+                if (!ring) {
+                    return BroadcastState::closed;
+                }
+                if (blocking) {
+                    return ring->wait_read(*cursor, dropped_, fn);
+                }
+                return ring->read(*cursor, dropped_, fn);
+            }
+
+            // number of elements lost by lag
+            std::uint64_t dropped() const {
+                return dropped_;
+            }
+
+            // number of elements published but not received yet
+            std::uint64_t lag() const {
+                return ring ? ring->lag(*cursor) : 0;
+            }
+        };
+
+        // BroadcastChan is producer side of BroadcastRing
+        // only one thread can send at once
+        template <class T>
+        struct BroadcastChan {
+           private:
+            wrap::shared_ptr<BroadcastRing<T>> ring;
+
+           public:
+            BroadcastChan() = default;
+            BroadcastChan(wrap::shared_ptr<BroadcastRing<T>>& r)
+                : ring(r) {}
+
+            bool operator<<(T&& t) {
+                return ring ? ring->publish(std::move(t)) : false;
+            }
+
+            [[nodiscard]] BroadcastReader<T> subscribe() {
+                if (!ring) {
+                    return {};
+                }
+                return BroadcastReader<T>(ring);
+            }
+
+            bool is_closed() const {
+                return ring ? ring->is_closed() : true;
+            }
+
+            void close() {
+                if (ring) {
+                    ring->close();
+                }
+            }
+        };
+
+        template <class T>
+        BroadcastChan<T> make_broadcast(size_t capacity = 1024, BroadcastPolicy policy = BroadcastPolicy::block) {
+            auto ring = wrap::make_shared<BroadcastRing<T>>(capacity, policy);
+            return BroadcastChan<T>(ring);
+        }
+    }  // namespace thread
+}  // namespace futils
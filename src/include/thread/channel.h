@@ -9,7 +9,10 @@
 // channel - channel between threads
 #pragma once
 
+#include <bit>
+#include <memory>
 #include "lite_lock.h"
+#include "concurrent_queue.h"
 #include "../wrap/light/queue.h"
 #include "../wrap/light/enum.h"
 #include "../wrap/light/smart_ptr.h"
@@ -33,6 +36,12 @@ namespace futils {
 
         using ChanState = wrap::EnumWrap<ChanStateValue, ChanStateValue::enable, ChanStateValue::closed>;
 
+        enum class BlockLevel {
+            normal,
+            force_block,
+            mustnot,
+        };
+
         struct ContainerHandler {
             template <class Que>
             bool remove(Que& que, ChanDisposePolicy policy) {
@@ -78,6 +87,22 @@ namespace futils {
             }
         };
 
+        // handler for ChanBuffer<T, BucketQue>
+        // level(t) classifies item into one of levels priorities (0 is highest)
+        // if aging is not 0, every aging-th load is served round robin from lower non-empty levels
+        // so that low priority items are not starved
+        // replace level() by deriving this to use other than T::level()
+        template <size_t level_count = 8>
+        struct BucketHandler {
+            static constexpr size_t levels = level_count;
+            size_t aging = 0;
+
+            template <class T>
+            size_t level(const T& t) const {
+                return t.level();
+            }
+        };
+
         template <class T, template <class...> class Que = wrap::queue, class Handler = ContainerHandler, class Lock = LiteLock>
         struct ChanBuffer {
            private:
@@ -85,8 +110,9 @@ namespace futils {
             size_t limit = ~0;
             Lock lock_;
             std::atomic_flag closed;
-            LiteLock read_blocking;
-            LiteLock write_blocking;
+            // set while a blocking reader/writer waits. cleared and notified on state change
+            std::atomic_flag read_blocking;
+            std::atomic_flag write_blocking;
             ChanDisposePolicy policy = ChanDisposePolicy::dispose_new;
             Handler handler;
 
@@ -102,9 +128,14 @@ namespace futils {
                 return true;
             }
 
+            static void release_blocking(std::atomic_flag& f) {
+                f.clear(std::memory_order_release);
+                f.notify_all();
+            }
+
             void unlock_ioblocking() {
-                write_blocking.unlock();
-                read_blocking.unlock();
+                release_blocking(write_blocking);
+                release_blocking(read_blocking);
             }
 
             bool check_close() {
@@ -120,11 +151,11 @@ namespace futils {
                     if (!check_close()) {
                         return ChanStateValue::closed;
                     }
-                    write_blocking.unlock();
+                    release_blocking(write_blocking);
                     return ChanStateValue::empty;
                 }
                 handler.pop(que, t);
-                write_blocking.unlock();
+                release_blocking(write_blocking);
                 return true;
             }
 
@@ -133,11 +164,11 @@ namespace futils {
                     return ChanStateValue::closed;
                 }
                 if (!check_limit()) {
-                    read_blocking.unlock();
+                    release_blocking(read_blocking);
                     return ChanStateValue::full;
                 }
                 handler.push(que, std::move(t));
-                read_blocking.unlock();
+                release_blocking(read_blocking);
                 return true;
             }
 
@@ -209,9 +240,9 @@ namespace futils {
                     lock_.lock();
                     auto res = unlock_store(std::move(t));
                     if (res == ChanStateValue::full) {
-                        write_blocking.flag.test_and_set();
+                        write_blocking.test_and_set();
                         lock_.unlock();
-                        write_blocking.flag.wait(true);
+                        write_blocking.wait(true);
                         continue;
                     }
                     lock_.unlock();
@@ -224,9 +255,9 @@ namespace futils {
                     lock_.lock();
                     auto res = unlock_load(t);
                     if (res == ChanStateValue::empty) {
-                        read_blocking.flag.test_and_set();
+                        read_blocking.test_and_set();
                         lock_.unlock();
-                        read_blocking.flag.wait(true);
+                        read_blocking.wait(true);
                         continue;
                     }
                     lock_.unlock();
@@ -234,6 +265,71 @@ namespace futils {
                 }
             }
 
+            // store items[0..n) under one lock
+            // stored items are moved from and sent is set to number of them
+            // returns true if at least one item is stored
+            ChanState store_batch(T* items, size_t n, size_t& sent, BlockLevel level) {
+                sent = 0;
+                while (true) {
+                    if (level == BlockLevel::mustnot) {
+                        if (!lock_.try_lock()) {
+                            return ChanStateValue::blocked;
+                        }
+                    }
+                    else {
+                        lock_.lock();
+                    }
+                    ChanState res = true;
+                    while (sent < n) {
+                        res = unlock_store(std::move(items[sent]));
+                        if (!res) {
+                            break;
+                        }
+                        sent++;
+                    }
+                    if (sent == 0 && res == ChanStateValue::full && level == BlockLevel::force_block) {
+                        write_blocking.test_and_set();
+                        lock_.unlock();
+                        write_blocking.wait(true);
+                        continue;
+                    }
+                    lock_.unlock();
+                    return sent ? ChanState(true) : res;
+                }
+            }
+
+            // load up to n items into out under one lock
+            // returns true if at least one item is loaded
+            ChanState load_batch(T* out, size_t n, size_t& received, BlockLevel level) {
+                received = 0;
+                while (true) {
+                    if (level == BlockLevel::mustnot) {
+                        if (!lock_.try_lock()) {
+                            return ChanStateValue::blocked;
+                        }
+                    }
+                    else {
+                        lock_.lock();
+                    }
+                    ChanState res = true;
+                    while (received < n) {
+                        res = unlock_load(out[received]);
+                        if (!res) {
+                            break;
+                        }
+                        received++;
+                    }
+                    if (received == 0 && res == ChanStateValue::empty && level == BlockLevel::force_block) {
+                        read_blocking.test_and_set();
+                        lock_.unlock();
+                        read_blocking.wait(true);
+                        continue;
+                    }
+                    lock_.unlock();
+                    return received ? ChanState(true) : res;
+                }
+            }
+
             bool close() {
                 if (closed.test_and_set()) {
                     return true;
@@ -248,10 +344,406 @@ namespace futils {
             }
         };
 
-        enum class BlockLevel {
-            normal,
-            force_block,
-            mustnot,
+        // tag for ChanBuffer backed by BoundedRingQueue
+        // use as make_chan<T, RingQue>(limit)
+        template <class...>
+        struct RingQue {};
+
+        // lock-free bounded channel buffer
+        // capacity is limit rounded up to power of 2 (1024 if limit is unbounded) and fixed at creation
+        // so change_limit has no effect
+        // ChanDisposePolicy::dispose_back cannot remove newest item from ring, so it drops new item as dispose_new does
+        template <class T, class Handler, class Lock>
+        struct ChanBuffer<T, RingQue, Handler, Lock> {
+           private:
+            static constexpr size_t default_capacity = 1024;
+            BoundedRingQueue<T> que;
+            std::atomic<ChanDisposePolicy> policy;
+            Handler handler;
+
+            static size_t capacity_of(size_t limit) {
+                return limit == size_t(~0) || limit == 0 ? default_capacity : limit;
+            }
+
+            ChanState push(T&& t) {
+                while (!que.try_push(std::move(t))) {
+                    if (que.is_closed()) {
+                        return ChanStateValue::closed;
+                    }
+                    if (policy.load(std::memory_order_relaxed) != ChanDisposePolicy::dispose_front) {
+                        return ChanStateValue::full;
+                    }
+                    que.try_pop();  // dispose oldest
+                }
+                return true;
+            }
+
+            ChanState empty_state() {
+                return que.is_closed() ? ChanStateValue::closed : ChanStateValue::empty;
+            }
+
+           public:
+            ChanBuffer(size_t limit = ~0, ChanDisposePolicy policy = ChanDisposePolicy::dispose_new)
+                : que(capacity_of(limit)), policy(policy) {}
+
+            size_t peek_queue() const {
+                return que.size();
+            }
+
+            template <class Fn>
+            bool set_handler(Fn&& fn) {
+                fn(this->handler);
+                return true;
+            }
+
+            void change_limit(size_t) {}
+
+            void change_policy(ChanDisposePolicy policy) {
+                this->policy.store(policy, std::memory_order_relaxed);
+            }
+
+            ChanState try_store(T&& t) {
+                return store(std::move(t));
+            }
+
+            ChanState try_load(T& t) {
+                return load(t);
+            }
+
+            ChanState store(T&& t) {
+                if (que.is_closed()) {
+                    return ChanStateValue::closed;
+                }
+                return push(std::move(t));
+            }
+
+            ChanState load(T& t) {
+                auto v = que.try_pop();
+                if (!v) {
+                    if (!que.is_closed()) {
+                        return ChanStateValue::empty;
+                    }
+                    v = que.try_pop();  // drain items pushed before close
+                    if (!v) {
+                        return ChanStateValue::closed;
+                    }
+                }
+                t = std::move(*v);
+                return true;
+            }
+
+            ChanState blocking_store(T&& t) {
+                auto res = store(std::move(t));
+                if (res != ChanStateValue::full) {
+                    return res;
+                }
+                return que.push_wait(std::move(t)) ? ChanState(true) : ChanState(ChanStateValue::closed);
+            }
+
+            ChanState blocking_load(T& t) {
+                auto v = que.pop_wait();
+                if (!v) {
+                    return ChanStateValue::closed;
+                }
+                t = std::move(*v);
+                return true;
+            }
+
+            ChanState store_batch(T* items, size_t n, size_t& sent, BlockLevel level) {
+                sent = 0;
+                if (que.is_closed()) {
+                    return ChanStateValue::closed;
+                }
+                if (n == 0) {
+                    return true;
+                }
+                sent = que.try_push_n(items, n);
+                while (sent < n && policy.load(std::memory_order_relaxed) == ChanDisposePolicy::dispose_front) {
+                    if (!push(std::move(items[sent]))) {
+                        break;
+                    }
+                    sent++;
+                }
+                if (sent == 0 && level == BlockLevel::force_block) {
+                    sent = que.push_n_wait(items, n);
+                    if (sent == 0) {
+                        return ChanStateValue::closed;
+                    }
+                }
+                return sent ? ChanState(true) : ChanState(ChanStateValue::full);
+            }
+
+            ChanState load_batch(T* out, size_t n, size_t& received, BlockLevel level) {
+                received = 0;
+                if (n == 0) {
+                    return true;
+                }
+                auto assign = [&](T&& v) {
+                    out[received++] = std::move(v);
+                };
+                if (level == BlockLevel::force_block) {
+                    que.pop_n_wait(n, assign);
+                }
+                else if (!que.try_pop_n(n, assign) && que.is_closed()) {
+                    que.try_pop_n(n, assign);
+                }
+                return received ? ChanState(true) : empty_state();
+            }
+
+            bool close() {
+                que.close();
+                return true;
+            }
+
+            bool is_closed() const {
+                return que.is_closed();
+            }
+        };
+
+        // tag for ChanBuffer with discrete priority levels
+        // use as make_chan<T, BucketQue, BucketHandler<levels>>(limit)
+        template <class...>
+        struct BucketQue {};
+
+        // lock-free channel buffer with discrete priority levels
+        // each level has BoundedRingQueue of limit capacity (1024 if unbounded) and
+        // non-empty levels are tracked by atomic bitmap, so store and load are O(1)
+        // items of the same level are FIFO
+        // handler is not synchronized, so call set_handler before sharing channel
+        template <class T, class Handler, class Lock>
+        struct ChanBuffer<T, BucketQue, Handler, Lock> {
+            static_assert(Handler::levels > 0 && Handler::levels <= 64, "levels must be in 1..64");
+
+           private:
+            static constexpr size_t levels = Handler::levels;
+            static constexpr size_t default_capacity = 1024;
+            std::unique_ptr<BoundedRingQueue<T>> ques[levels];
+            // bitmap is a hint. a set bit may be stale, and a clear bit is repaired by the storer
+            alignas(64) std::atomic<std::uint64_t> nonempty = 0;
+            alignas(64) std::atomic<size_t> loads = 0;
+            std::atomic<size_t> cursor = 0;
+            alignas(64) std::atomic<std::uint32_t> epoch = 0;
+            std::atomic<std::uint32_t> waiters = 0;
+            std::atomic_flag closed;
+            std::atomic<ChanDisposePolicy> policy;
+            Handler handler;
+
+            static constexpr std::uint64_t bit(size_t l) {
+                return std::uint64_t(1) << l;
+            }
+
+            size_t level_of(const T& t) {
+                auto l = handler.level(t);
+                return l < levels ? l : levels - 1;
+            }
+
+            void published(size_t l) {
+                // pairs with fence in pop_from
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!(nonempty.load(std::memory_order_relaxed) & bit(l))) {
+                    nonempty.fetch_or(bit(l), std::memory_order_seq_cst);
+                }
+                if (waiters.load(std::memory_order_relaxed) != 0) {
+                    epoch.fetch_add(1, std::memory_order_relaxed);
+                    epoch.notify_one();
+                }
+            }
+
+            std::optional<T> pop_from(size_t l) {
+                auto v = ques[l]->try_pop();
+                if (!v) {
+                    nonempty.fetch_and(~bit(l), std::memory_order_seq_cst);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (ques[l]->size() != 0) {
+                        nonempty.fetch_or(bit(l), std::memory_order_seq_cst);
+                    }
+                }
+                return v;
+            }
+
+            // returns level to serve by aging policy or levels if this is not aged turn
+            size_t aged_level(std::uint64_t m) {
+                auto aging = handler.aging;
+                if (aging == 0 || loads.fetch_add(1, std::memory_order_relaxed) % aging != aging - 1) {
+                    return levels;
+                }
+                // round robin over levels except the highest non-empty one
+                auto lower = m & (m - 1);
+                if (!lower) {
+                    return levels;
+                }
+                auto c = cursor.load(std::memory_order_relaxed) % levels;
+                auto later = lower & (~std::uint64_t(0) << c);
+                auto l = size_t(std::countr_zero(later ? later : lower));
+                cursor.store(l + 1, std::memory_order_relaxed);
+                return l;
+            }
+
+            bool pop_any(T& t) {
+                auto m = nonempty.load(std::memory_order_acquire);
+                if (!m) {
+                    return false;
+                }
+                auto l = aged_level(m);
+                if (l == levels) {
+                    l = std::countr_zero(m);
+                }
+                while (true) {
+                    if (auto v = pop_from(l)) {
+                        t = std::move(*v);
+                        return true;
+                    }
+                    m &= ~bit(l);
+                    if (!m) {
+                        return false;
+                    }
+                    l = std::countr_zero(m);
+                }
+            }
+
+           public:
+            ChanBuffer(size_t limit = ~0, ChanDisposePolicy policy = ChanDisposePolicy::dispose_new)
+                : policy(policy) {
+                auto cap = limit == size_t(~0) || limit == 0 ? default_capacity : limit;
+                for (auto& q : ques) {
+                    q = std::make_unique<BoundedRingQueue<T>>(cap);
+                }
+            }
+
+            size_t peek_queue() const {
+                size_t n = 0;
+                for (auto& q : ques) {
+                    n += q->size();
+                }
+                return n;
+            }
+
+            template <class Fn>
+            bool set_handler(Fn&& fn) {
+                fn(this->handler);
+                return true;
+            }
+
+            void change_limit(size_t) {}
+
+            void change_policy(ChanDisposePolicy policy) {
+                this->policy.store(policy, std::memory_order_relaxed);
+            }
+
+            ChanState try_store(T&& t) {
+                return store(std::move(t));
+            }
+
+            ChanState try_load(T& t) {
+                return load(t);
+            }
+
+            // dispose_front removes the oldest item of the same level
+            ChanState store(T&& t) {
+                if (closed.test()) {
+                    return ChanStateValue::closed;
+                }
+                auto l = level_of(t);
+                auto& q = *ques[l];
+                while (!q.try_push(std::move(t))) {
+                    if (q.is_closed()) {
+                        return ChanStateValue::closed;
+                    }
+                    if (policy.load(std::memory_order_relaxed) != ChanDisposePolicy::dispose_front) {
+                        return ChanStateValue::full;
+                    }
+                    q.try_pop();
+                }
+                published(l);
+                return true;
+            }
+
+            ChanState load(T& t) {
+                if (pop_any(t)) {
+                    return true;
+                }
+                if (!closed.test()) {
+                    return ChanStateValue::empty;
+                }
+                // drain items stored before close
+                return pop_any(t) ? ChanState(true) : ChanState(ChanStateValue::closed);
+            }
+
+            ChanState blocking_store(T&& t) {
+                auto res = store(std::move(t));
+                if (res != ChanStateValue::full) {
+                    return res;
+                }
+                auto l = level_of(t);
+                if (!ques[l]->push_wait(std::move(t))) {
+                    return ChanStateValue::closed;
+                }
+                published(l);
+                return true;
+            }
+
+            ChanState blocking_load(T& t) {
+                for (;;) {
+                    for (auto i = 0; i < 16; i++) {
+                        auto res = load(t);
+                        if (res != ChanStateValue::empty) {
+                            return res;
+                        }
+                        std::this_thread::yield();
+                    }
+                    waiters.fetch_add(1, std::memory_order_seq_cst);
+                    auto e = epoch.load(std::memory_order_seq_cst);
+                    auto res = load(t);
+                    if (res != ChanStateValue::empty) {
+                        waiters.fetch_sub(1, std::memory_order_relaxed);
+                        return res;
+                    }
+                    epoch.wait(e, std::memory_order_seq_cst);
+                    waiters.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+
+            ChanState store_batch(T* items, size_t n, size_t& sent, BlockLevel level) {
+                sent = 0;
+                ChanState res = true;
+                while (sent < n) {
+                    res = sent == 0 && level == BlockLevel::force_block ? blocking_store(std::move(items[sent])) : store(std::move(items[sent]));
+                    if (!res) {
+                        break;
+                    }
+                    sent++;
+                }
+                return sent ? ChanState(true) : res;
+            }
+
+            ChanState load_batch(T* out, size_t n, size_t& received, BlockLevel level) {
+                received = 0;
+                ChanState res = true;
+                while (received < n) {
+                    res = received == 0 && level == BlockLevel::force_block ? blocking_load(out[received]) : load(out[received]);
+                    if (!res) {
+                        break;
+                    }
+                    received++;
+                }
+                return received ? ChanState(true) : res;
+            }
+
+            bool close() {
+                if (closed.test_and_set()) {
+                    return true;
+                }
+                for (auto& q : ques) {
+                    q->close();
+                }
+                epoch.fetch_add(1, std::memory_order_seq_cst);
+                epoch.notify_all();
+                return true;
+            }
+
+            bool is_closed() const {
+                return closed.test();
+            }
         };
 
         template <class T, template <class...> class Que, class Handler, class Lock>
@@ -325,6 +817,15 @@ namespace futils {
                     return this->buffer->load(t);
                 }
             }
+
+            // receive up to n items with one synchronization
+            ChanState recv_batch(T* out, size_t n, size_t& received) {
+                received = 0;
+                if (!this->buffer) {
+                    return false;
+                }
+                return this->buffer->load_batch(out, n, received, this->blocking);
+            }
         };
 
         template <class T, template <class...> class Que = wrap::queue, class Handler = ContainerHandler, class Lock = LiteLock>
@@ -345,6 +846,16 @@ namespace futils {
                     return this->buffer->store(std::move(t));
                 }
             }
+
+            // send items[0..n) with one synchronization
+            // sent items are moved from
+            ChanState send_batch(T* items, size_t n, size_t& sent) {
+                sent = 0;
+                if (!this->buffer) {
+                    return false;
+                }
+                return this->buffer->store_batch(items, n, sent, this->blocking);
+            }
         };
 
         template <class T, template <class...> class Que = wrap::queue, class Handler = ContainerHandler, class Lock = LiteLock>
@@ -7,8 +7,11 @@
 
 #pragma once
 #include <atomic>
+#include <cstdint>
 #include <memory>
+#include <new>
 #include <optional>
+#include <thread>
 
 namespace futils::thread {
 
@@ -27,6 +30,11 @@ namespace futils::thread {
             ref_count.fetch_add(1, std::memory_order_relaxed);
         }
 
+        // returns true if this was the last reference
+        bool release() {
+            return ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+
         template <class A>
         void dec_ref(A& a) {
             using traits = std::allocator_traits<A>;
@@ -37,6 +45,164 @@ namespace futils::thread {
         }
     };
 
+    struct QueueStats {
+        size_t allocations = 0;
+        size_t deallocations = 0;
+    };
+
+    // free list for QueueNode memory
+    // freed nodes are pushed onto shared stack by CAS (push only, so no ABA)
+    // and the stack is taken at once by exchange into per-thread cache slot
+    // so steady load does not call allocator
+    template <typename T, class A>
+    struct QueueNodeRecycler {
+       private:
+        static constexpr size_t cache_line = 64;
+        static constexpr size_t slot_count = 16;
+        static constexpr size_t consumer_batch = 32;
+
+        struct FreeNode {
+            FreeNode* next;
+        };
+        static_assert(sizeof(QueueNode<T>) >= sizeof(FreeNode));
+
+        struct alignas(cache_line) Slot {
+            std::atomic_flag lock;
+            FreeNode* list = nullptr;
+        };
+
+        using rebound_alloc = typename std::allocator_traits<A>::template rebind_alloc<QueueNode<T>>;
+        using traits = typename std::allocator_traits<A>::template rebind_traits<QueueNode<T>>;
+        [[no_unique_address]] rebound_alloc allocator;
+
+        Slot slots[slot_count];
+        alignas(cache_line) std::atomic<FreeNode*> shared = nullptr;
+        // touched only by consumer
+        alignas(cache_line) FreeNode* consumer_list = nullptr;
+        FreeNode* consumer_tail = nullptr;
+        size_t consumer_count = 0;
+        std::atomic<size_t> allocations = 0;
+        std::atomic<size_t> deallocations = 0;
+
+        static size_t slot_index() {
+            static std::atomic<size_t> next_index = 0;
+            thread_local const size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % slot_count;
+            return index;
+        }
+
+        static FreeNode* to_free(QueueNode<T>* node) {
+            return std::construct_at(reinterpret_cast<FreeNode*>(node), FreeNode{nullptr});
+        }
+
+        void push_shared(FreeNode* first, FreeNode* last) {
+            auto head = shared.load(std::memory_order_relaxed);
+            do {
+                last->next = head;
+            } while (!shared.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        void free_list(FreeNode* list) {
+            while (list) {
+                auto next = list->next;
+                traits::deallocate(allocator, reinterpret_cast<QueueNode<T>*>(list), 1);
+                deallocations.fetch_add(1, std::memory_order_relaxed);
+                list = next;
+            }
+        }
+
+        // move list of other slots into slot
+        // this is slow path but nodes cached by exited threads are not stranded
+        void steal_slots(Slot& slot) {
+            for (auto& other : slots) {
+                if (&other == &slot || other.lock.test_and_set(std::memory_order_acquire)) {
+                    continue;
+                }
+                auto list = other.list;
+                other.list = nullptr;
+                other.lock.clear(std::memory_order_release);
+                if (list) {
+                    slot.list = list;
+                    return;
+                }
+            }
+        }
+
+        QueueNode<T>* take() {
+            auto& slot = slots[slot_index()];
+            if (slot.lock.test_and_set(std::memory_order_acquire)) {
+                return nullptr;  // shared with other thread and it is using. fallback to allocator
+            }
+            if (!slot.list) {
+                slot.list = shared.exchange(nullptr, std::memory_order_acquire);
+                if (!slot.list) {
+                    steal_slots(slot);
+                }
+            }
+            auto node = slot.list;
+            if (node) {
+                slot.list = node->next;
+            }
+            slot.lock.clear(std::memory_order_release);
+            return reinterpret_cast<QueueNode<T>*>(node);
+        }
+
+       public:
+        QueueNodeRecycler() = default;
+        QueueNodeRecycler(const QueueNodeRecycler&) = delete;
+
+        ~QueueNodeRecycler() {
+            for (auto& slot : slots) {
+                free_list(slot.list);
+            }
+            free_list(shared.load());
+            free_list(consumer_list);
+        }
+
+        // called by any thread
+        template <class... Arg>
+        QueueNode<T>* create(Arg&&... arg) {
+            auto node = take();
+            if (!node) {
+                node = traits::allocate(allocator, 1);
+                allocations.fetch_add(1, std::memory_order_relaxed);
+            }
+            traits::construct(allocator, node, std::forward<Arg>(arg)...);
+            return node;
+        }
+
+        // called by any thread
+        void recycle(QueueNode<T>* node) {
+            traits::destroy(allocator, node);
+            auto f = to_free(node);
+            push_shared(f, f);
+        }
+
+        // called by consumer thread only
+        // nodes are returned to shared stack by batch
+        void recycle_consumer(QueueNode<T>* node) {
+            traits::destroy(allocator, node);
+            auto f = to_free(node);
+            f->next = consumer_list;
+            consumer_list = f;
+            if (!consumer_tail) {
+                consumer_tail = f;
+            }
+            if (++consumer_count >= consumer_batch) {
+                push_shared(consumer_list, consumer_tail);
+                consumer_list = nullptr;
+                consumer_tail = nullptr;
+                consumer_count = 0;
+            }
+        }
+
+        QueueStats stats() const {
+            return QueueStats{
+                .allocations = allocations.load(std::memory_order_relaxed),
+                .deallocations = deallocations.load(std::memory_order_relaxed),
+            };
+        }
+    };
+
     // thread safety
     // A - push thread
     // B - pop thread
@@ -48,9 +214,9 @@ namespace futils::thread {
     // A: last->next = node
     // B: next = first->next.load() // acquired
     // B: head.store(next) // next becomes the new head
-    // B: first->dec_ref() // ref_count = 1
+    // B: first->release() // ref_count = 1
     // A: last->notify_one() // notify B but nothing happens
-    // A: last->dec_ref() // ref_count = 0, destroy the old first
+    // A: last->release() // ref_count = 0, recycle the old first
     // scenario 2:
     // last == first
     // A: last = tail.exchange(node)
@@ -61,22 +227,27 @@ namespace futils::thread {
     // A: last->next = node
     // A: last->notify_one() // notify B
     // B: next = first->next.load() // acquired
-    // A: last->dec_ref() // ref_count = 1
+    // A: last->release() // ref_count = 1
     // B: head.store(next) // next becomes the new head
-    // B: first->dec_ref() // ref_count = 0, destroy the old first
+    // B: first->release() // ref_count = 0, recycle the old first
+    // node memory is recycled through QueueNodeRecycler
     template <typename T, class A>
     struct MultiProduceSingleConsumeQueue {
        private:
         std::atomic<QueueNode<T>*> head;
         std::atomic<QueueNode<T>*> tail;
-        using rebound_alloc = typename std::allocator_traits<A>::template rebind_alloc<QueueNode<T>>;
-        rebound_alloc allocator;
-        using traits = typename std::allocator_traits<A>::template rebind_traits<QueueNode<T>>;
+        QueueNodeRecycler<T, A> recycler;
+
+        // called by the consumer
+        void release_head(QueueNode<T>* first) {
+            if (first->release()) {
+                recycler.recycle_consumer(first);
+            }
+        }
 
        public:
         MultiProduceSingleConsumeQueue() {
-            auto node = traits::allocate(allocator, 1);
-            traits::construct(allocator, node);
+            auto node = recycler.create();
             head.store(node);
             tail.store(node);
         }
@@ -85,22 +256,27 @@ namespace futils::thread {
             auto node = head.load();
             while (node) {
                 auto next = node->next.load();
-                traits::destroy(allocator, node);
-                traits::deallocate(allocator, node, 1);
+                recycler.recycle(node);
                 node = next;
             }
         }
 
         // called by the producer (multi thread)
         void push(auto&& data) {
-            auto node = traits::allocate(allocator, 1);
-            traits::construct(allocator, node, std::forward<decltype(data)>(data));
+            auto node = recycler.create(std::forward<decltype(data)>(data));
             node->next = nullptr;
             auto last = tail.exchange(node);
             last->inc_ref();  // temporary for notify_one
             last->next = node;
             last->next.notify_one();
-            last->dec_ref(allocator);  // release temporary reference
+            if (last->release()) {  // release temporary reference
+                recycler.recycle(last);
+            }
+        }
+
+        // allocator calls made by this queue
+        QueueStats stats() const {
+            return recycler.stats();
         }
 
         std::optional<T> pop_wait() {
@@ -115,7 +291,7 @@ namespace futils::thread {
             }
             head.store(next);                   // next becomes the new head (stub node)
             auto data = std::move(next->data);  // get the data
-            first->dec_ref(allocator);          // destroy the old head
+            release_head(first);                // recycle the old head
             return data;
         }
 
@@ -128,7 +304,7 @@ namespace futils::thread {
             }
             head.store(next);                   // next becomes the new head (stub node)
             auto data = std::move(next->data);  // get the data
-            first->dec_ref(allocator);          // destroy the old head
+            release_head(first);                // recycle the old head
             return data;
         }
 
@@ -200,6 +376,272 @@ namespace futils::thread {
         }
     };
 
+    // bounded multi producer multi consumer queue
+    // based on Dmitry Vyukov's bounded MPMC queue
+    // each cell has sequence number so producer and consumer do not share cache line except the cell
+    // capacity is rounded up to power of 2
+    template <typename T, class A = std::allocator<T>>
+    struct BoundedRingQueue {
+       private:
+        static constexpr size_t cache_line = 64;
+
+        struct alignas(cache_line) Cell {
+            std::atomic<size_t> seq;
+            alignas(T) unsigned char storage[sizeof(T)];
+
+            T* get() {
+                return std::launder(reinterpret_cast<T*>(storage));
+            }
+        };
+
+        using rebound_alloc = typename std::allocator_traits<A>::template rebind_alloc<Cell>;
+        using traits = typename std::allocator_traits<A>::template rebind_traits<Cell>;
+        [[no_unique_address]] rebound_alloc allocator;
+        Cell* cells = nullptr;
+        size_t mask = 0;
+
+        alignas(cache_line) std::atomic<size_t> enqueue_pos = 0;
+        alignas(cache_line) std::atomic<size_t> dequeue_pos = 0;
+
+        // for blocking wait
+        alignas(cache_line) std::atomic<std::uint32_t> push_epoch = 0;
+        std::atomic<std::uint32_t> pop_waiters = 0;
+        alignas(cache_line) std::atomic<std::uint32_t> pop_epoch = 0;
+        std::atomic<std::uint32_t> push_waiters = 0;
+        std::atomic_bool closed = false;
+
+        // claim up to n contiguous ready cells from pos_ref
+        // offset is 0 for producer and 1 for consumer
+        size_t claim(std::atomic<size_t>& pos_ref, size_t n, size_t offset, size_t& pos) {
+            pos = pos_ref.load(std::memory_order_relaxed);
+            for (;;) {
+                size_t k = 0;
+                bool retry = false;
+                for (; k < n; k++) {
+                    auto& cell = cells[(pos + k) & mask];
+                    auto seq = cell.seq.load(std::memory_order_acquire);
+                    auto diff = std::intptr_t(seq) - std::intptr_t(pos + k + offset);
+                    if (diff == 0) {
+                        continue;
+                    }
+                    if (diff > 0 && k == 0) {
+                        // other thread claimed pos
+                        retry = true;
+                    }
+                    break;
+                }
+                if (retry) {
+                    pos = pos_ref.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (k == 0) {
+                    return 0;  // full or empty
+                }
+                if (pos_ref.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                    return k;
+                }
+            }
+        }
+
+        void notify_pushed(size_t n) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (pop_waiters.load(std::memory_order_relaxed) != 0) {
+                pop_epoch.fetch_add(1, std::memory_order_relaxed);
+                if (n == 1) {
+                    pop_epoch.notify_one();
+                }
+                else {
+                    pop_epoch.notify_all();
+                }
+            }
+        }
+
+        void notify_popped(size_t n) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (push_waiters.load(std::memory_order_relaxed) != 0) {
+                push_epoch.fetch_add(1, std::memory_order_relaxed);
+                if (n == 1) {
+                    push_epoch.notify_one();
+                }
+                else {
+                    push_epoch.notify_all();
+                }
+            }
+        }
+
+        bool wait_until(std::atomic<std::uint32_t>& waiters, std::atomic<std::uint32_t>& epoch, auto&& try_op) {
+            for (;;) {
+                // short spin before sleeping
+                for (auto i = 0; i < 16; i++) {
+                    if (try_op()) {
+                        return true;
+                    }
+                    std::this_thread::yield();
+                }
+                waiters.fetch_add(1, std::memory_order_seq_cst);
+                auto e = epoch.load(std::memory_order_seq_cst);
+                if (try_op()) {
+                    waiters.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+                if (closed.load(std::memory_order_acquire)) {
+                    waiters.fetch_sub(1, std::memory_order_relaxed);
+                    return false;
+                }
+                epoch.wait(e, std::memory_order_seq_cst);
+                waiters.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+       public:
+        explicit BoundedRingQueue(size_t capacity) {
+            size_t cap = 2;
+            while (cap < capacity) {
+                cap <<= 1;
+            }
+            cells = traits::allocate(allocator, cap);
+            for (size_t i = 0; i < cap; i++) {
+                traits::construct(allocator, cells + i);
+                cells[i].seq.store(i, std::memory_order_relaxed);
+            }
+            mask = cap - 1;
+        }
+
+        BoundedRingQueue(const BoundedRingQueue&) = delete;
+
+        ~BoundedRingQueue() {
+            while (try_pop()) {
+            }
+            for (size_t i = 0; i <= mask; i++) {
+                traits::destroy(allocator, cells + i);
+            }
+            traits::deallocate(allocator, cells, mask + 1);
+        }
+
+        size_t capacity() const {
+            return mask + 1;
+        }
+
+        // approximate size
+        size_t size() const {
+            auto e = enqueue_pos.load(std::memory_order_relaxed);
+            auto d = dequeue_pos.load(std::memory_order_relaxed);
+            return e > d ? e - d : 0;
+        }
+
+        // push up to n items from items[0..n). returns number of pushed items
+        // pushed items are moved from
+        size_t try_push_n(T* items, size_t n) {
+            size_t pos;
+            auto k = claim(enqueue_pos, n, 0, pos);
+            for (size_t i = 0; i < k; i++) {
+                auto& cell = cells[(pos + i) & mask];
+                std::construct_at(cell.get(), std::move(items[i]));
+                cell.seq.store(pos + i + 1, std::memory_order_release);
+            }
+            if (k) {
+                notify_pushed(k);
+            }
+            return k;
+        }
+
+        bool try_push(auto&& data) {
+            size_t pos;
+            if (!claim(enqueue_pos, 1, 0, pos)) {
+                return false;
+            }
+            auto& cell = cells[pos & mask];
+            std::construct_at(cell.get(), std::forward<decltype(data)>(data));
+            cell.seq.store(pos + 1, std::memory_order_release);
+            notify_pushed(1);
+            return true;
+        }
+
+        // pop up to n items and call out(T&&) for each. returns number of popped items
+        size_t try_pop_n(size_t n, auto&& out) {
+            size_t pos;
+            auto k = claim(dequeue_pos, n, 1, pos);
+            for (size_t i = 0; i < k; i++) {
+                auto& cell = cells[(pos + i) & mask];
+                out(std::move(*cell.get()));
+                std::destroy_at(cell.get());
+                cell.seq.store(pos + i + mask + 1, std::memory_order_release);
+            }
+            if (k) {
+                notify_popped(k);
+            }
+            return k;
+        }
+
+        std::optional<T> try_pop() {
+            std::optional<T> result;
+            try_pop_n(1, [&](T&& v) { result.emplace(std::move(v)); });
+            return result;
+        }
+
+        // block until data is pushed. returns false if closed
+        bool push_wait(auto&& data) {
+            if (closed.load(std::memory_order_acquire)) {
+                return false;
+            }
+            return wait_until(push_waiters, push_epoch, [&] {
+                return try_push(std::forward<decltype(data)>(data));
+            });
+        }
+
+        // block until at least one item is pushed and push as many as possible
+        // returns number of pushed items (0 if closed)
+        size_t push_n_wait(T* items, size_t n) {
+            if (n == 0 || closed.load(std::memory_order_acquire)) {
+                return 0;
+            }
+            size_t k = 0;
+            wait_until(push_waiters, push_epoch, [&] {
+                k = try_push_n(items, n);
+                return k != 0;
+            });
+            return k;
+        }
+
+        // block until data is available. returns nullopt if closed and empty
+        std::optional<T> pop_wait() {
+            std::optional<T> result;
+            wait_until(pop_waiters, pop_epoch, [&] {
+                result = try_pop();
+                return result.has_value();
+            });
+            return result;
+        }
+
+        // block until at least one item is available and pop up to n items
+        // returns number of popped items (0 if closed and empty)
+        size_t pop_n_wait(size_t n, auto&& out) {
+            if (n == 0) {
+                return 0;
+            }
+            size_t k = 0;
+            wait_until(pop_waiters, pop_epoch, [&] {
+                k = try_pop_n(n, out);
+                return k != 0;
+            });
+            return k;
+        }
+
+        // close queue and wake all waiters
+        // remaining items can still be popped
+        void close() {
+            closed.store(true, std::memory_order_release);
+            push_epoch.fetch_add(1, std::memory_order_seq_cst);
+            push_epoch.notify_all();
+            pop_epoch.fetch_add(1, std::memory_order_seq_cst);
+            pop_epoch.notify_all();
+        }
+
+        bool is_closed() const {
+            return closed.load(std::memory_order_acquire);
+        }
+    };
+
     template <typename T, class A>
     struct MultiProducerChannelBuffer {
        private:
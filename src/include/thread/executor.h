@@ -0,0 +1,460 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+// executor - multi-thread work stealing executor for poll::Task
+// like tokio's multi thread runtime
+#pragma once
+#include "async.h"
+#include "steal_deque.h"
+#include <cassert>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace futils::thread::poll {
+
+    struct Executor;
+
+    namespace internal {
+        enum TaskRunState : std::uint32_t {
+            idle = 0,
+            scheduled = 1,
+            running = 2,
+            notified = 3,  // woken while running
+            complete = 4,
+        };
+
+        struct TaskHeader;
+
+        struct TaskVTable {
+            // returns true if task is complete
+            bool (*run)(TaskHeader* self) = nullptr;
+            void (*destroy)(TaskHeader* self) = nullptr;
+        };
+
+        struct TaskHeader {
+            std::atomic<std::uint32_t> state = scheduled;
+            std::atomic<std::uint32_t> ref = 1;
+            const TaskVTable* vtable = nullptr;
+            Executor* exec = nullptr;
+            AtomicWaker join_waker;
+
+            void inc_ref() {
+                ref.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void dec_ref() {
+                if (ref.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    vtable->destroy(this);
+                }
+            }
+        };
+
+        // defined after Executor
+        void schedule_task(TaskHeader* task);
+
+        inline void* task_waker_clone(void* self) {
+            static_cast<TaskHeader*>(self)->inc_ref();
+            return self;
+        }
+
+        inline void task_waker_drop(void* self) {
+            static_cast<TaskHeader*>(self)->dec_ref();
+        }
+
+        inline void task_waker_wake(void* self) {
+            schedule_task(static_cast<TaskHeader*>(self));
+        }
+
+        // Waker::wake does not consume the Waker (drop is called by destructor)
+        // so wake and wake_by_ref are same
+        constexpr VTable task_waker_vtable{
+            .drop = task_waker_drop,
+            .clone = task_waker_clone,
+            .wake = task_waker_wake,
+            .wake_by_ref = task_waker_wake,
+        };
+
+        template <class R>
+        struct TaskCore : TaskHeader {
+            std::optional<R> output;
+        };
+
+        // NOTE: Poller is held directly instead of through Task<F, R>
+        //       because generated Poll/TaskState are not move constructible
+        template <class F, class R>
+        struct RawTask : TaskCore<R> {
+            F task;
+
+            template <class T>
+            RawTask(T&& f)
+                : task(std::forward<T>(f)) {}
+
+            static bool run(TaskHeader* self) {
+                auto t = static_cast<RawTask*>(self);
+                t->inc_ref();  // for waker in context
+                Context ctx{Waker(self, &task_waker_vtable)};
+                auto r = t->task.poll(ctx);
+                if (r.pending()) {
+                    return false;
+                }
+                t->output.emplace(std::move(*r.ready()));
+                return true;
+            }
+
+            static void destroy(TaskHeader* self) {
+                delete static_cast<RawTask*>(self);
+            }
+
+            static constexpr TaskVTable task_vtable{
+                .run = run,
+                .destroy = destroy,
+            };
+        };
+
+        template <class T>
+        struct poll_value;
+
+        template <class R>
+        struct poll_value<Poll<R>> {
+            using type = R;
+        };
+
+        template <class F>
+        using poll_value_t = typename poll_value<decltype(std::declval<F&>().poll(std::declval<Context&>()))>::type;
+    }  // namespace internal
+
+    // JoinHandle is handle to result of spawned task
+    // JoinHandle can be polled by other task (fan-in) or joined by blocking
+    template <class R>
+    struct JoinHandle {
+       private:
+        internal::TaskCore<R>* task = nullptr;
+
+        friend struct Executor;
+        JoinHandle(internal::TaskCore<R>* t)
+            : task(t) {}
+
+       public:
+        constexpr JoinHandle() = default;
+        JoinHandle(JoinHandle&& other) noexcept
+            : task(std::exchange(other.task, nullptr)) {}
+
+        JoinHandle& operator=(JoinHandle&& other) noexcept {
+            if (this != &other) {
+                this->~JoinHandle();
+                task = std::exchange(other.task, nullptr);
+            }
+            return *this;
+        }
+
+        ~JoinHandle() {
+            if (task) {
+                task->dec_ref();
+                task = nullptr;
+            }
+        }
+
+        explicit operator bool() const {
+            return task != nullptr;
+        }
+
+        bool is_finished() const {
+            return task && task->state.load(std::memory_order_acquire) == internal::complete;
+        }
+
+        // poll result from other task
+        // result can be taken only once
+        // handle MUST be returned by spawn (not default-constructed or moved-from)
+        Poll<R> poll(Context& ctx) {
+            assert(task && "poll on empty JoinHandle");
+            if (!is_finished()) {
+                task->join_waker.register_waker(ctx.waker);
+                if (!is_finished()) {
+                    return typename Poll<R>::Pending{};
+                }
+            }
+            return typename Poll<R>::Ready{std::move(*task->output)};
+        }
+
+        // block calling thread until task completes
+        // MUST NOT be called from worker thread of executor
+        R join() {
+            assert(task && "join on empty JoinHandle");
+            for (;;) {
+                auto s = task->state.load(std::memory_order_acquire);
+                if (s == internal::complete) {
+                    break;
+                }
+                task->state.wait(s, std::memory_order_acquire);
+            }
+            return std::move(*task->output);
+        }
+    };
+
+    // Executor runs poll::Task on worker threads
+    // each worker has own Chase-Lev deque and steals from others when empty
+    // task spawned or woken from outside of worker is pushed into global injection queue
+    // idle worker parks until new task arrives
+    // NOTE: Waker of task MUST NOT be woken after Executor is destroyed
+    struct Executor {
+       private:
+        struct Worker {
+            WorkStealDeque<internal::TaskHeader*> local;
+            std::uint64_t rand = 0;
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> threads;
+
+        std::mutex inject_lock;
+        std::deque<internal::TaskHeader*> inject;
+        std::atomic_size_t inject_count = 0;
+
+        alignas(64) std::atomic<std::uint32_t> epoch = 0;
+        alignas(64) std::atomic<std::uint32_t> sleepers = 0;
+        std::atomic_bool closed = false;
+
+        static constexpr size_t spin_count = 64;
+
+        struct Current {
+            Executor* exec = nullptr;
+            Worker* worker = nullptr;
+        };
+
+        static Current& current() {
+            thread_local Current c;
+            return c;
+        }
+
+        friend void internal::schedule_task(internal::TaskHeader* task);
+
+        void notify() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleepers.load(std::memory_order_seq_cst) != 0) {
+                epoch.fetch_add(1, std::memory_order_seq_cst);
+                epoch.notify_one();
+            }
+        }
+
+        // task reference is moved to queue
+        void enqueue(internal::TaskHeader* task) {
+            auto& c = current();
+            if (c.exec == this) {
+                c.worker->local.push(task);
+            }
+            else {
+                std::scoped_lock l{inject_lock};
+                inject.push_back(task);
+                inject_count.fetch_add(1, std::memory_order_release);
+            }
+            notify();
+        }
+
+        void schedule(internal::TaskHeader* task) {
+            auto s = task->state.load(std::memory_order_acquire);
+            for (;;) {
+                if (s == internal::idle) {
+                    if (task->state.compare_exchange_weak(s, internal::scheduled, std::memory_order_acq_rel)) {
+                        if (closed.load(std::memory_order_acquire)) {
+                            return;
+                        }
+                        task->inc_ref();
+                        enqueue(task);
+                        return;
+                    }
+                }
+                else if (s == internal::running) {
+                    if (task->state.compare_exchange_weak(s, internal::notified, std::memory_order_acq_rel)) {
+                        return;
+                    }
+                }
+                else {
+                    return;  // already scheduled or complete
+                }
+            }
+        }
+
+        internal::TaskHeader* pop_inject() {
+            if (inject_count.load(std::memory_order_acquire) == 0) {
+                return nullptr;
+            }
+            std::scoped_lock l{inject_lock};
+            if (inject.empty()) {
+                return nullptr;
+            }
+            auto t = inject.front();
+            inject.pop_front();
+            inject_count.fetch_sub(1, std::memory_order_relaxed);
+            return t;
+        }
+
+        internal::TaskHeader* find_task(Worker& w) {
+            if (auto t = w.local.pop()) {
+                return *t;
+            }
+            if (auto t = pop_inject()) {
+                return t;
+            }
+            // xorshift for victim selection
+            w.rand ^= w.rand << 13;
+            w.rand ^= w.rand >> 7;
+            w.rand ^= w.rand << 17;
+            const auto n = workers.size();
+            const auto start = w.rand % n;
+            for (size_t i = 0; i < n; i++) {
+                auto& victim = *workers[(start + i) % n];
+                if (&victim == &w) {
+                    continue;
+                }
+                if (auto t = victim.local.steal()) {
+                    return *t;
+                }
+            }
+            return nullptr;
+        }
+
+        void run_task(internal::TaskHeader* task) {
+            task->state.store(internal::running, std::memory_order_release);
+            if (task->vtable->run(task)) {
+                task->state.store(internal::complete, std::memory_order_release);
+                task->state.notify_all();
+                task->join_waker.wake();
+                task->dec_ref();
+                return;
+            }
+            std::uint32_t expect = internal::running;
+            if (task->state.compare_exchange_strong(expect, internal::idle, std::memory_order_acq_rel)) {
+                task->dec_ref();
+                return;
+            }
+            // woken while running. reschedule on local queue with same reference
+            task->state.store(internal::scheduled, std::memory_order_release);
+            if (closed.load(std::memory_order_acquire)) {
+                task->dec_ref();
+                return;
+            }
+            enqueue(task);
+        }
+
+        void worker_loop(size_t index) {
+            auto& w = *workers[index];
+            w.rand = 0x9E3779B97F4A7C15ull * (index + 1);
+            current() = Current{this, &w};
+            while (!closed.load(std::memory_order_acquire)) {
+                internal::TaskHeader* task = nullptr;
+                for (size_t i = 0; i < spin_count && !task; i++) {
+                    task = find_task(w);
+                    if (!task && i > spin_count / 2) {
+                        std::this_thread::yield();
+                    }
+                }
+                if (task) {
+                    run_task(task);
+                    continue;
+                }
+                // park
+                sleepers.fetch_add(1, std::memory_order_seq_cst);
+                auto e = epoch.load(std::memory_order_seq_cst);
+                task = find_task(w);
+                if (task || closed.load(std::memory_order_acquire)) {
+                    sleepers.fetch_sub(1, std::memory_order_seq_cst);
+                    if (task) {
+                        run_task(task);
+                    }
+                    continue;
+                }
+                epoch.wait(e, std::memory_order_seq_cst);
+                sleepers.fetch_sub(1, std::memory_order_seq_cst);
+            }
+            current() = Current{};
+        }
+
+        void drain() {
+            for (auto& w : workers) {
+                while (auto t = w->local.pop()) {
+                    (*t)->dec_ref();
+                }
+            }
+            std::scoped_lock l{inject_lock};
+            for (auto t : inject) {
+                t->dec_ref();
+            }
+            inject.clear();
+            inject_count = 0;
+        }
+
+       public:
+        // n_thread == 0 means hardware concurrency
+        explicit Executor(size_t n_thread = 0) {
+            if (n_thread == 0) {
+                n_thread = std::thread::hardware_concurrency();
+                if (n_thread == 0) {
+                    n_thread = 1;
+                }
+            }
+            for (size_t i = 0; i < n_thread; i++) {
+                workers.push_back(std::make_unique<Worker>());
+            }
+            for (size_t i = 0; i < n_thread; i++) {
+                threads.emplace_back([this, i] { worker_loop(i); });
+            }
+        }
+
+        Executor(const Executor&) = delete;
+
+        ~Executor() {
+            shutdown();
+        }
+
+        size_t worker_count() const {
+            return workers.size();
+        }
+
+        // spawn task
+        // if called from worker thread, task is pushed to local queue of the worker
+        template <class F, class R = internal::poll_value_t<F>>
+            requires Poller<F, R>
+        JoinHandle<R> spawn(F&& f) {
+            auto task = new internal::RawTask<std::decay_t<F>, R>(std::forward<F>(f));
+            task->vtable = &internal::RawTask<std::decay_t<F>, R>::task_vtable;
+            task->exec = this;
+            task->ref.store(2, std::memory_order_relaxed);  // JoinHandle and queue
+            if (closed.load(std::memory_order_acquire)) {
+                task->dec_ref();
+                return JoinHandle<R>(task);
+            }
+            enqueue(task);
+            return JoinHandle<R>(task);
+        }
+
+        // stop all workers and wait for them
+        // queued task is dropped without completion
+        // (so JoinHandle::join of such task never returns)
+        void shutdown() {
+            if (closed.exchange(true)) {
+                return;
+            }
+            epoch.fetch_add(1, std::memory_order_seq_cst);
+            epoch.notify_all();
+            for (auto& t : threads) {
+                t.join();
+            }
+            threads.clear();
+            drain();
+        }
+    };
+
+    namespace internal {
+        inline void schedule_task(TaskHeader* task) {
+            task->exec->schedule(task);
+        }
+    }  // namespace internal
+
+}  // namespace futils::thread::poll
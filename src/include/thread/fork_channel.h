@@ -90,18 +90,18 @@ namespace futils {
                     return false;
                 }
                 T copy(std::move(t));
-                std::erase_if(listener, [&](auto& v) {
-                    SendChan<T, Que>& c = get<1>(v);
-                    if (c.is_closed()) {
-                        return true;
+                for (auto it = listener.begin(); it != listener.end();) {
+                    SendChan<T, Que>& c = get<1>(*it);
+                    if (!c.is_closed()) {
+                        auto tomov = copy;
+                        c.set_blocking(blocking);
+                        if ((c << std::move(tomov)) != ChanStateValue::closed) {
+                            it++;
+                            continue;
+                        }
                     }
-                    auto tomov = copy;
-                    c.set_blocking(blocking);
-                    if ((c << std::move(tomov)) == ChanStateValue::closed) {
-                        return true;
-                    }
-                    return false;
-                });
+                    it = listener.erase(it);
+                }
                 lock_.unlock();
                 return true;
             }
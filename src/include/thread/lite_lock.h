@@ -9,25 +9,75 @@
 // lite_lock - lite lock
 #pragma once
 #include <atomic>
+#include <cstdint>
+#include <thread>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace futils {
     namespace thread {
+
+        // hint to cpu that this is spin loop
+        inline void cpu_relax() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_pause();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+            __yield();
+#elif defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+            asm volatile("yield");
+#endif
+        }
+
+        // spinning is useless on single core
+        inline std::uint32_t default_spin_count() {
+            static const std::uint32_t count = std::thread::hardware_concurrency() > 1 ? 100 : 0;
+            return count;
+        }
+
+        // state: 0 = unlocked, 1 = locked, 2 = locked and may have waiters
+        // unlock calls notify only if state was 2 and wakes one waiter
+        // see also "Futexes Are Tricky" (Drepper)
         struct LiteLock {
-            std::atomic_flag flag;
+            std::atomic<std::uint32_t> state = 0;
+
+            static constexpr std::uint32_t unlocked = 0;
+            static constexpr std::uint32_t locked = 1;
+            static constexpr std::uint32_t contended = 2;
 
             void lock() {
-                while (!try_lock()) {
-                    flag.wait(true);
+                if (try_lock()) {
+                    return;
+                }
+                // spin until unlocked or someone is sleeping
+                for (auto i = default_spin_count(); i > 0; i--) {
+                    auto s = state.load(std::memory_order_relaxed);
+                    if (s == unlocked && try_lock()) {
+                        return;
+                    }
+                    if (s == contended) {
+                        break;
+                    }
+                    cpu_relax();
+                }
+                // mark as contended before sleep
+                // lock acquired with contended state because other waiters may exist
+                while (state.exchange(contended, std::memory_order_acquire) != unlocked) {
+                    state.wait(contended, std::memory_order_relaxed);
                 }
             }
 
             bool try_lock() {
-                return flag.test_and_set(std::memory_order_acquire) == false;
+                auto expected = unlocked;
+                return state.compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed);
             }
 
             void unlock() {
-                flag.clear(std::memory_order_release);
-                flag.notify_all();
+                if (state.exchange(unlocked, std::memory_order_release) == contended) {
+                    state.notify_one();
+                }
             }
         };
 
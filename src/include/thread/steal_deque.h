@@ -0,0 +1,145 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+// steal_deque - Chase-Lev work stealing deque
+// see also "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013)
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace futils::thread {
+
+    // owner thread calls push and pop (LIFO)
+    // other threads call steal (FIFO)
+    // T must be trivially copyable (usually pointer)
+    template <class T>
+    struct WorkStealDeque {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+       private:
+        struct Array {
+            std::int64_t mask = 0;
+            std::atomic<T>* buffer = nullptr;
+
+            explicit Array(std::int64_t cap)
+                : mask(cap - 1), buffer(new std::atomic<T>[cap]) {}
+
+            ~Array() {
+                delete[] buffer;
+            }
+
+            std::int64_t capacity() const {
+                return mask + 1;
+            }
+
+            T get(std::int64_t i) const {
+                return buffer[i & mask].load(std::memory_order_relaxed);
+            }
+
+            void put(std::int64_t i, T v) {
+                buffer[i & mask].store(v, std::memory_order_relaxed);
+            }
+        };
+
+        alignas(64) std::atomic<std::int64_t> top = 0;
+        alignas(64) std::atomic<std::int64_t> bottom = 0;
+        alignas(64) std::atomic<Array*> array;
+        // old arrays may be read by concurrent steal so they are freed at destruction
+        std::vector<Array*> garbage;
+
+        Array* grow(Array* a, std::int64_t b, std::int64_t t) {
+            auto n = new Array(a->capacity() * 2);
+            for (auto i = t; i < b; i++) {
+                n->put(i, a->get(i));
+            }
+            garbage.push_back(a);
+            array.store(n, std::memory_order_release);
+            return n;
+        }
+
+       public:
+        // capacity must be power of 2
+        explicit WorkStealDeque(std::int64_t capacity = 256)
+            : array(new Array(capacity)) {}
+
+        WorkStealDeque(const WorkStealDeque&) = delete;
+
+        ~WorkStealDeque() {
+            delete array.load();
+            for (auto a : garbage) {
+                delete a;
+            }
+        }
+
+        // called by owner
+        void push(T v) {
+            auto b = bottom.load(std::memory_order_relaxed);
+            auto t = top.load(std::memory_order_acquire);
+            auto a = array.load(std::memory_order_relaxed);
+            if (b - t > a->capacity() - 1) {
+                a = grow(a, b, t);
+            }
+            a->put(b, v);
+            bottom.store(b + 1, std::memory_order_release);
+        }
+
+        // called by owner
+        std::optional<T> pop() {
+            auto b = bottom.load(std::memory_order_relaxed) - 1;
+            auto a = array.load(std::memory_order_relaxed);
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto t = top.load(std::memory_order_relaxed);
+            if (t > b) {
+                // empty
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+            T v = a->get(b);
+            if (t == b) {
+                // last element. race with steal
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    bottom.store(b + 1, std::memory_order_relaxed);
+                    return std::nullopt;
+                }
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return v;
+        }
+
+        // called by any thread
+        std::optional<T> steal() {
+            auto t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto b = bottom.load(std::memory_order_acquire);
+            if (t >= b) {
+                return std::nullopt;
+            }
+            auto a = array.load(std::memory_order_acquire);
+            T v = a->get(t);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return std::nullopt;  // lost race
+            }
+            return v;
+        }
+
+        // approximate size
+        std::size_t size() const {
+            auto b = bottom.load(std::memory_order_relaxed);
+            auto t = top.load(std::memory_order_relaxed);
+            return b > t ? b - t : 0;
+        }
+
+        bool empty() const {
+            return size() == 0;
+        }
+    };
+
+}  // namespace futils::thread
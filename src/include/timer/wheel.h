@@ -0,0 +1,322 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+// wheel - hierarchical hashed timer wheel
+// see also "Hashed and Hierarchical Timing Wheels" (Varghese and Lauck 1987)
+#pragma once
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include "../thread/lite_lock.h"
+
+namespace futils::timer {
+
+    // TimerEntry is intrusive node of TimerWheel
+    // embed or derive this and cast back in expire callback
+    // entry must be canceled (or expired) before destruction
+    struct TimerEntry {
+       private:
+        friend struct TimerWheel;
+        TimerEntry* prev = nullptr;
+        TimerEntry* next = nullptr;
+        std::uint64_t expire_ = 0;
+        std::uint32_t slot = 0;
+
+        void unlink() {
+            prev->next = next;
+            next->prev = prev;
+            prev = nullptr;
+            next = nullptr;
+        }
+
+       public:
+        constexpr TimerEntry() = default;
+        TimerEntry(const TimerEntry&) = delete;
+        TimerEntry& operator=(const TimerEntry&) = delete;
+
+        constexpr bool active() const noexcept {
+            return next != nullptr;
+        }
+
+        constexpr std::uint64_t expire() const noexcept {
+            return expire_;
+        }
+    };
+
+    // tick is abstract unit of time decided by user (for example, milliseconds from steady clock)
+    // each level has 64 slots and 11 levels cover whole 64 bit tick space,
+    // so there is no overflow list
+    // entries whose expire is already passed are kept in separate due list
+    struct TimerWheel {
+        static constexpr std::uint32_t slot_bits = 6;
+        static constexpr std::uint32_t slot_count = 1 << slot_bits;
+        static constexpr std::uint32_t slot_mask = slot_count - 1;
+        static constexpr std::uint32_t level_count = (64 + slot_bits - 1) / slot_bits;
+
+       private:
+        static constexpr std::uint32_t due_slot = level_count * slot_count;
+        TimerEntry heads[due_slot + 1];
+        std::uint64_t occupied[level_count]{};
+        std::uint64_t current = 0;
+        size_t count = 0;
+
+        static constexpr std::uint32_t digit(std::uint64_t tick, std::uint32_t level) {
+            return (tick >> (level * slot_bits)) & slot_mask;
+        }
+
+        void insert(TimerEntry& e, std::uint32_t idx) {
+            auto& head = heads[idx];
+            e.slot = idx;
+            e.prev = head.prev;
+            e.next = &head;
+            head.prev->next = &e;
+            head.prev = &e;
+            if (idx != due_slot) {
+                occupied[idx / slot_count] |= std::uint64_t(1) << (idx % slot_count);
+            }
+        }
+
+        void link(TimerEntry& e) {
+            if (e.expire_ <= current) {
+                insert(e, due_slot);
+                return;
+            }
+            // highest differ digit decides level
+            auto level = std::uint32_t(std::bit_width(e.expire_ ^ current) - 1) / slot_bits;
+            insert(e, level * slot_count + digit(e.expire_, level));
+        }
+
+        void unlink(TimerEntry& e) {
+            auto idx = e.slot;
+            e.unlink();
+            // if e is already detached by expire_slot, slot may be relinked or empty
+            // so check emptiness instead of counting
+            if (idx != due_slot && heads[idx].next == &heads[idx]) {
+                occupied[idx / slot_count] &= ~(std::uint64_t(1) << (idx % slot_count));
+            }
+        }
+
+        // detach whole slot into local list
+        void detach(std::uint32_t idx, TimerEntry& local) {
+            auto& head = heads[idx];
+            if (idx != due_slot) {
+                occupied[idx / slot_count] &= ~(std::uint64_t(1) << (idx % slot_count));
+            }
+            if (head.next == &head) {
+                local.next = &local;
+                local.prev = &local;
+                return;
+            }
+            local.next = head.next;
+            local.prev = head.prev;
+            local.next->prev = &local;
+            local.prev->next = &local;
+            head.next = &head;
+            head.prev = &head;
+        }
+
+        void cascade(std::uint32_t level) {
+            TimerEntry local;
+            detach(level * slot_count + digit(current, level), local);
+            while (local.next != &local) {
+                auto e = local.next;
+                e->unlink();
+                if (e->expire_ == current) {
+                    insert(*e, digit(current, 0));  // fired by following expire()
+                }
+                else {
+                    link(*e);
+                }
+            }
+        }
+
+        size_t expire(std::uint32_t idx, auto&& on_expire) {
+            TimerEntry local;
+            detach(idx, local);
+            size_t n = 0;
+            while (local.next != &local) {
+                auto e = local.next;
+                e->unlink();
+                count--;
+                n++;
+                on_expire(*e);  // e may be rescheduled or destroyed here
+            }
+            return n;
+        }
+
+        // next tick that something has to be done (expire or cascade)
+        std::optional<std::uint64_t> next_event() const {
+            for (std::uint32_t level = 0; level < level_count; level++) {
+                auto d = digit(current, level);
+                auto later = d == slot_mask ? 0 : occupied[level] & (~std::uint64_t(0) << (d + 1));
+                if (later) {
+                    auto shift = level * slot_bits;
+                    auto upper = shift + slot_bits >= 64 ? 0 : (current >> (shift + slot_bits)) << (shift + slot_bits);
+                    return upper | (std::uint64_t(std::countr_zero(later)) << shift);
+                }
+            }
+            return std::nullopt;
+        }
+
+       public:
+        explicit TimerWheel(std::uint64_t now = 0)
+            : current(now) {
+            for (auto& h : heads) {
+                h.next = &h;
+                h.prev = &h;
+            }
+        }
+
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        // schedule inserts or reschedules entry in O(1)
+        // expire <= now() fires at next advance()
+        void schedule(TimerEntry& e, std::uint64_t expire) {
+            if (e.active()) {
+                unlink(e);
+            }
+            else {
+                count++;
+            }
+            e.expire_ = expire;
+            link(e);
+        }
+
+        // cancel removes entry in O(1)
+        // returns false if entry is not active
+        bool cancel(TimerEntry& e) {
+            if (!e.active()) {
+                return false;
+            }
+            unlink(e);
+            count--;
+            return true;
+        }
+
+        // advance moves time to now and calls on_expire(TimerEntry&) for each expired entry
+        // entry is removed before callback so callback can reschedule or destroy it
+        // entry scheduled to expire <= now() in callback fires at next advance()
+        // returns number of expired entries
+        size_t advance(std::uint64_t now, auto&& on_expire) {
+            size_t n = expire(due_slot, on_expire);
+            while (true) {
+                auto t = next_event();
+                if (!t || *t > now) {
+                    break;
+                }
+                current = *t;
+                for (auto level = level_count - 1; level > 0; level--) {
+                    if (current & ((std::uint64_t(1) << (level * slot_bits)) - 1)) {
+                        continue;  // not a boundary of this level
+                    }
+                    if (occupied[level] & (std::uint64_t(1) << digit(current, level))) {
+                        cascade(level);
+                    }
+                }
+                n += expire(digit(current, 0), on_expire);
+            }
+            if (now > current) {
+                current = now;
+            }
+            return n;
+        }
+
+        // next_expiry returns lower bound of next expiry tick
+        // it is exact if the timer is within 64 ticks, otherwise it may be the tick of cascade
+        // returns nullopt if no timer is active
+        std::optional<std::uint64_t> next_expiry() const {
+            if (heads[due_slot].next != &heads[due_slot]) {
+                return current;
+            }
+            return next_event();
+        }
+
+        // wait_timeout is a hook for IOEvent::wait/wait_io_event
+        // returns ticks until next expiry clamped by max_wait
+        // if tick is millisecond, result can be directly passed as timeout of epoll_wait
+        std::uint32_t wait_timeout(std::uint64_t now, std::uint32_t max_wait) const {
+            auto next = next_expiry();
+            if (!next) {
+                return max_wait;
+            }
+            if (*next <= now) {
+                return 0;
+            }
+            auto delta = *next - now;
+            return delta < max_wait ? std::uint32_t(delta) : max_wait;
+        }
+
+        std::uint64_t now() const noexcept {
+            return current;
+        }
+
+        size_t size() const noexcept {
+            return count;
+        }
+
+        bool empty() const noexcept {
+            return count == 0;
+        }
+    };
+
+    // LockedTimerWheel is thread safe variant of TimerWheel
+    // on_expire is called with lock held as on_expire(TimerEntry&, TimerWheel&)
+    // so use passed TimerWheel to reschedule in callback, calling member of this causes deadlock
+    template <class Lock = thread::LiteLock>
+    struct LockedTimerWheel {
+       private:
+        Lock lock;
+        TimerWheel wheel;
+
+       public:
+        explicit LockedTimerWheel(std::uint64_t now = 0)
+            : wheel(now) {}
+
+        void schedule(TimerEntry& e, std::uint64_t expire) {
+            std::scoped_lock l{lock};
+            wheel.schedule(e, expire);
+        }
+
+        bool cancel(TimerEntry& e) {
+            std::scoped_lock l{lock};
+            return wheel.cancel(e);
+        }
+
+        size_t advance(std::uint64_t now, auto&& on_expire) {
+            std::scoped_lock l{lock};
+            return wheel.advance(now, [&](TimerEntry& e) {
+                on_expire(e, wheel);
+            });
+        }
+
+        std::optional<std::uint64_t> next_expiry() {
+            std::scoped_lock l{lock};
+            return wheel.next_expiry();
+        }
+
+        std::uint32_t wait_timeout(std::uint64_t now, std::uint32_t max_wait) {
+            std::scoped_lock l{lock};
+            return wheel.wait_timeout(now, max_wait);
+        }
+
+        size_t size() {
+            std::scoped_lock l{lock};
+            return wheel.size();
+        }
+    };
+
+    // steady_ticks returns steady clock time in Dur unit
+    // useful as tick source of TimerWheel
+    template <class Dur = std::chrono::milliseconds>
+    std::uint64_t steady_ticks() {
+        return std::chrono::duration_cast<Dur>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+}  // namespace futils::timer
@@ -14,9 +14,256 @@
 #define _WASI_EMULATED_MMAN
 #endif
 #include <sys/mman.h>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// hand written context switch saves only callee-saved registers
+// and does not touch signal mask unlike swapcontext
+// define FUTILS_CORO_USE_UCONTEXT to use ucontext for comparison
+#if !defined(FUTILS_CORO_USE_UCONTEXT) && defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__))
+#define FUTILS_CORO_ASM_SWITCH
+#endif
+
+#ifdef FUTILS_CORO_ASM_SWITCH
+extern "C" {
+// save callee-saved registers on current stack, store stack pointer to *from_sp
+// and restore registers from to_sp
+void futils_coro_switch(void** from_sp, void* to_sp);
+// first entry of new context. calls fn(arg) placed by make_context
+void futils_coro_entry();
+}
+
+#if defined(__x86_64__)
+// frame layout (from stack pointer)
+// 0: mxcsr(4) + x87 control word(4)
+// 8: r15, r14, r13, r12, rbx, rbp
+// 56: return address
+asm(R"(
+    .text
+    .globl futils_coro_switch
+    .type futils_coro_switch, @function
+    .p2align 4
+futils_coro_switch:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $8, %rsp
+    stmxcsr (%rsp)
+    fnstcw 4(%rsp)
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    ldmxcsr (%rsp)
+    fldcw 4(%rsp)
+    addq $8, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size futils_coro_switch, .-futils_coro_switch
+
+    .globl futils_coro_entry
+    .type futils_coro_entry, @function
+    .p2align 4
+futils_coro_entry:
+    movq %r12, %rdi
+    callq *%r13
+    ud2
+    .size futils_coro_entry, .-futils_coro_entry
+)");
+#elif defined(__aarch64__)
+// frame layout (from stack pointer)
+// 0: x19-x28, 80: x29, x30(return address), 96: d8-d15
+asm(R"(
+    .text
+    .globl futils_coro_switch
+    .type futils_coro_switch, %function
+    .p2align 4
+futils_coro_switch:
+    sub sp, sp, #160
+    stp x19, x20, [sp, #0]
+    stp x21, x22, [sp, #16]
+    stp x23, x24, [sp, #32]
+    stp x25, x26, [sp, #48]
+    stp x27, x28, [sp, #64]
+    stp x29, x30, [sp, #80]
+    stp d8, d9, [sp, #96]
+    stp d10, d11, [sp, #112]
+    stp d12, d13, [sp, #128]
+    stp d14, d15, [sp, #144]
+    mov x2, sp
+    str x2, [x0]
+    mov sp, x1
+    ldp x19, x20, [sp, #0]
+    ldp x21, x22, [sp, #16]
+    ldp x23, x24, [sp, #32]
+    ldp x25, x26, [sp, #48]
+    ldp x27, x28, [sp, #64]
+    ldp x29, x30, [sp, #80]
+    ldp d8, d9, [sp, #96]
+    ldp d10, d11, [sp, #112]
+    ldp d12, d13, [sp, #128]
+    ldp d14, d15, [sp, #144]
+    add sp, sp, #160
+    ret
+    .size futils_coro_switch, .-futils_coro_switch
+
+    .globl futils_coro_entry
+    .type futils_coro_entry, %function
+    .p2align 4
+futils_coro_entry:
+    mov x0, x19
+    blr x20
+    brk #0
+    .size futils_coro_entry, .-futils_coro_entry
+)");
+#endif
+#endif
 
 namespace futils {
     namespace coro {
+#ifdef FUTILS_CORO_ASM_SWITCH
+        struct Context {
+            void* sp = nullptr;
+        };
+
+        // build initial frame so that first switch returns into futils_coro_entry
+        void make_context(Context& ctx, byte* stack_top, void (*call)(C*), C* arg) {
+            auto top = reinterpret_cast<std::uintptr_t>(stack_top) & ~std::uintptr_t(15);
+#if defined(__x86_64__)
+            auto frame = reinterpret_cast<std::uint64_t*>(top - 64);
+            std::uint32_t mxcsr = 0x1F80;
+            std::uint16_t fpucw = 0x037F;
+            ::memcpy(frame, &mxcsr, sizeof(mxcsr));
+            ::memcpy(reinterpret_cast<byte*>(frame) + 4, &fpucw, sizeof(fpucw));
+            frame[1] = 0;                                                   // r15
+            frame[2] = 0;                                                   // r14
+            frame[3] = reinterpret_cast<std::uint64_t>(call);               // r13
+            frame[4] = reinterpret_cast<std::uint64_t>(arg);                // r12
+            frame[5] = 0;                                                   // rbx
+            frame[6] = 0;                                                   // rbp
+            frame[7] = reinterpret_cast<std::uint64_t>(&futils_coro_entry);  // return address
+#elif defined(__aarch64__)
+            auto frame = reinterpret_cast<std::uint64_t*>(top - 160);
+            ::memset(frame, 0, 160);
+            frame[0] = reinterpret_cast<std::uint64_t>(arg);                 // x19
+            frame[1] = reinterpret_cast<std::uint64_t>(call);                // x20
+            frame[11] = reinterpret_cast<std::uint64_t>(&futils_coro_entry);  // x30
+#endif
+            ctx.sp = frame;
+        }
+
+        void swap_context(Context& from, Context& to) {
+            futils_coro_switch(&from.sp, to.sp);
+        }
+#else
+        struct Context {
+            ucontext_t ctx{};
+        };
+
+        void make_context(Context& ctx, byte* stack_top, size_t size, void (*call)(C*), C* arg) {
+            getcontext(&ctx.ctx);
+            ctx.ctx.uc_stack.ss_sp = stack_top;
+            ctx.ctx.uc_stack.ss_size = size;
+            ctx.ctx.uc_link = nullptr;
+            makecontext(&ctx.ctx, reinterpret_cast<void (*)()>(call), 1, arg);
+        }
+
+        void swap_context(Context& from, Context& to) {
+            swapcontext(&from.ctx, &to.ctx);
+        }
+#endif
+
+        // pool of mapped stacks with guard page
+        // stacks are reused across add_coroutine instead of mmap/munmap for each coroutine
+        struct StackPool {
+           private:
+            std::mutex l;
+            view::wvec* free_list = nullptr;  // linked through head of each usable stack area
+            size_t cached = 0;
+            size_t max_cached = 0;
+            size_t page = 0;
+            size_t alloc_size = 0;
+
+            view::wvec* link_of(view::wvec s) {
+                // first usable page (next to guard page) has at least a page
+                return reinterpret_cast<view::wvec*>(s.data() + page);
+            }
+
+            view::wvec map() {
+                auto p = ::mmap(nullptr, alloc_size,
+                                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+                if (!p || p == MAP_FAILED) {
+                    return {};
+                }
+                ::mprotect(p, page, PROT_NONE);  // guard page
+                return view::wvec(static_cast<byte*>(p), alloc_size);
+            }
+
+           public:
+            void init(size_t stack_size, size_t max_cache, size_t prefill) {
+                page = size_t(::getpagesize());
+                alloc_size = ((stack_size / page) + 1) * page;  // +1 for guard page
+                max_cached = max_cache;
+                for (size_t i = 0; i < prefill && i < max_cached; i++) {
+                    auto s = map();
+                    if (s.null()) {
+                        break;
+                    }
+                    put(s);
+                }
+            }
+
+            size_t size() const {
+                return alloc_size;
+            }
+
+            view::wvec get() {
+                {
+                    const auto lk = std::lock_guard(l);
+                    if (free_list) {
+                        auto link = free_list;
+                        auto s = *link;
+                        free_list = *reinterpret_cast<view::wvec**>(link + 1);
+                        cached--;
+                        return s;
+                    }
+                }
+                return map();
+            }
+
+            void put(view::wvec s) {
+                {
+                    const auto lk = std::lock_guard(l);
+                    if (cached < max_cached) {
+                        auto link = link_of(s);
+                        *link = s;
+                        *reinterpret_cast<view::wvec**>(link + 1) = free_list;
+                        free_list = link;
+                        cached++;
+                        return;
+                    }
+                }
+                ::munmap(s.data(), s.size());
+            }
+
+            ~StackPool() {
+                while (free_list) {
+                    auto s = *free_list;
+                    free_list = *reinterpret_cast<view::wvec**>(free_list + 1);
+                    ::munmap(s.data(), s.size());
+                }
+            }
+        };
+
         struct CallStack {
            private:
             view::wvec stack;
@@ -44,20 +291,23 @@ namespace futils {
                 return stack.size() - std::uintptr_t(base_ptr() - stack_ptr());
             }
 
-            bool init(size_t stack_size, size_t ctrl) {
-                auto page = size_t(::getpagesize());
-                auto alloc_size = ((stack_size / page) + 1) * page;
-                auto p = ::mmap(nullptr, alloc_size,
-                                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_GROWSDOWN, -1, 0);
-                if (!p || p == MAP_FAILED) {
+            bool init(StackPool& pool, size_t ctrl) {
+                auto s = pool.get();
+                if (s.null()) {
                     return false;
                 }
-                ::mprotect(p, page, PROT_NONE);
-                stack = view::wvec(static_cast<byte*>(p), alloc_size);
+                stack = s;
                 ctrl_block = ctrl;
                 return true;
             }
 
+            // return stack to pool
+            void release(StackPool& pool) {
+                if (!stack.null()) {
+                    pool.put(std::exchange(stack, view::wvec()));
+                }
+            }
+
             constexpr CallStack() = default;
 
             constexpr CallStack& operator=(CallStack&& v) noexcept {
@@ -80,36 +330,79 @@ namespace futils {
 
         struct Handle {
             CallStack stack;
-            ucontext_t ctx{};
+            Context ctx{};
         };
 
-        Handle* setup_handle(size_t stack_size, void (*call)(C*), C* arg) {
+        Handle* setup_handle(StackPool& pool, void (*call)(C*), C* arg) {
             CallStack stack;
-            if (!stack.init(stack_size, sizeof(Handle))) {
+            if (!stack.init(pool, sizeof(Handle))) {
                 return nullptr;
             }
-            auto h = reinterpret_cast<Handle*>(stack.ctrl_block_ptr());
+            auto h = new (stack.ctrl_block_ptr()) Handle();
             h->stack = std::move(stack);
-            getcontext(&h->ctx);
-            h->ctx.uc_stack.ss_sp = h->stack.top_ptr();
-            h->ctx.uc_stack.ss_size = h->stack.stack_size();
-            h->ctx.uc_link = nullptr;
-            makecontext(&h->ctx, reinterpret_cast<void (*)()>(call), 1, arg);
+#ifdef FUTILS_CORO_ASM_SWITCH
+            make_context(h->ctx, h->stack.stack_ptr(), call, arg);
+#else
+            make_context(h->ctx, h->stack.top_ptr(), h->stack.stack_size(), call, arg);
+#endif
             return h;
         }
 
-        void delete_handle(void* p) {
+        void delete_handle(StackPool& pool, void* p) {
             auto h = static_cast<Handle*>(p);
             CallStack s;
             s = std::move(h->stack);
-            (void)s;
-            // auto destruct
+            h->~Handle();
+            s.release(pool);
         }
 
+        constexpr size_t coro_stack_size = 8192;
+
+        struct MultiThread;
+
         struct LinuxHandle : Platform {
-            ucontext_t root_ctx;
+            Context root_ctx;
+            StackPool stacks;
+            MultiThread* mt = nullptr;  // not null if M:N scheduler
+        };
+
+        // worker of M:N scheduler
+        struct Worker {
+            std::mutex l;
+            RingQue<C*> que;
+            Context root_ctx;
+            void* thread_ctx = nullptr;
+            std::thread th;
         };
 
+        struct MultiThread {
+            Worker* workers = nullptr;
+            size_t n_worker = 0;
+            std::atomic<size_t> next = 0;  // round robin for add_coroutine from non-worker
+            std::atomic<size_t> live = 0;  // coroutines not yet done
+            size_t capacity = 0;           // sum of queue capacity. live never exceeds this
+            std::atomic<std::uint32_t> epoch = 0;
+            std::atomic<std::uint32_t> sleepers = 0;
+            std::atomic_bool stop = false;
+        };
+
+        static thread_local Worker* current_worker;
+        static thread_local MultiThread* current_mt;
+
+        // coroutine may resume on other thread
+        // so thread local must be read after resume without caching its address
+        [[gnu::noinline]] static Worker* get_worker() {
+            auto w = current_worker;
+            asm volatile("" ::: "memory");
+            return w;
+        }
+
+        [[gnu::noinline]] static MultiThread* get_mt() {
+            auto m = current_mt;
+            asm volatile("" ::: "memory");
+            return m;
+        }
+
 #define as_coro_handle(ptr) static_cast<coro::Handle*>(ptr)
 #define as_handle(ptr) static_cast<LinuxHandle*>(ptr)
 #define get_linhandle(c) (c->is_main() ? as_handle(c->handle) : as_handle(c->main_->handle))
@@ -120,23 +413,279 @@ namespace futils {
             return running_coro;
         }
 
+        [[gnu::noinline]] static void set_running(C* c) {
+            running_coro = c;
+            asm volatile("" ::: "memory");
+        }
+
+        // root context to return when coroutine c suspends or exits
+        static Context& root_context_of(C* c, LinuxHandle* mh) {
+            if (mh->mt) {
+                return get_worker()->root_ctx;
+            }
+            return mh->root_ctx;
+        }
+
+        void** C::thread_context_slot() const {
+            auto mh = is_main() ? as_handle(handle) : as_handle(main_->handle);
+            if (!mh || !mh->mt || get_mt() != mh->mt) {
+                return nullptr;
+            }
+            return &get_worker()->thread_ctx;
+        }
+
+        static void wake_worker(MultiThread* mt) {
+            if (mt->sleepers.load(std::memory_order_seq_cst) != 0) {
+                mt->epoch.fetch_add(1, std::memory_order_seq_cst);
+                mt->epoch.notify_one();
+            }
+        }
+
+        // push to local queue if called on worker, otherwise round robin
+        static bool push_mt(MultiThread* mt, C* c) {
+            size_t start = 0;
+            if (get_mt() == mt) {
+                start = get_worker() - mt->workers;
+            }
+            else {
+                start = mt->next.fetch_add(1, std::memory_order_relaxed);
+            }
+            for (size_t i = 0; i < mt->n_worker; i++) {
+                auto& w = mt->workers[(start + i) % mt->n_worker];
+                const auto l = std::lock_guard(w.l);
+                if (w.que.push(std::move(c))) {
+                    wake_worker(mt);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // push suspended or stolen coroutine back
+        // own queue may be filled by other threads, then try others
+        // caller holds c so queued coroutines are less than capacity and this eventually succeeds
+        static void requeue(MultiThread* mt, Worker& w, C* c) {
+            {
+                const auto l = std::lock_guard(w.l);
+                if (w.que.push(std::move(c))) {
+                    return;
+                }
+            }
+            while (!push_mt(mt, c)) {
+                std::this_thread::yield();
+            }
+        }
+
+        static C* pop_local(Worker& w) {
+            const auto l = std::lock_guard(w.l);
+            return w.que.pop();
+        }
+
+        // steal half of other worker's queue
+        static C* steal(MultiThread* mt, Worker& self) {
+            auto index = size_t(&self - mt->workers);
+            C* buf[64];
+            for (size_t i = 1; i < mt->n_worker; i++) {
+                auto& victim = mt->workers[(index + i) % mt->n_worker];
+                size_t n = 0;
+                {
+                    const auto l = std::lock_guard(victim.l);
+                    auto half = (victim.que.size() + 1) / 2;
+                    n = victim.que.steal(buf, half < 64 ? half : 64);
+                }
+                if (n == 0) {
+                    continue;
+                }
+                for (size_t k = 1; k < n; k++) {
+                    requeue(mt, self, buf[k]);
+                }
+                return buf[0];
+            }
+            return nullptr;
+        }
+
         void C::coro_sub(C* c) {
             c->state = CState::running;
             const auto h = helper::defer([c] {
                 c->state = CState::done;
                 auto mh = as_handle(c->main_->handle);
                 while (true) {
-                    swapcontext(&as_coro_handle(c->handle)->ctx,
-                                &mh->root_ctx);
+                    swap_context(as_coro_handle(c->handle)->ctx,
+                                 root_context_of(c, mh));
                 }
             });
             try {
                 c->coroutine(c, c->user);
             } catch (...) {
-                as_handle(c->main_->handle)->except = std::current_exception();
+                auto mh = as_handle(c->main_->handle);
+                const auto l = mh->lock();
+                mh->except = std::current_exception();
             }
         }
 
+        struct MultiThreadScheduler {
+            static bool add(LinuxHandle* h, C* m, void* user, C::coro_t f) {
+                auto v = h->resource.alloc(sizeof(C));
+                if (!v) {
+                    return false;
+                }
+                auto c = new (v) C(m, f, user);
+                auto d = helper::defer([&] {
+                    h->resource.free(c);  // no destructor because no handle
+                });
+                auto handle = setup_handle(h->stacks, C::coro_sub, c);
+                if (!handle) {
+                    return false;
+                }
+                c->handle = handle;
+                if (h->mt->live.fetch_add(1, std::memory_order_relaxed) >= h->mt->capacity) {
+                    h->mt->live.fetch_sub(1, std::memory_order_relaxed);
+                    delete_handle(h->stacks, handle);
+                    return false;
+                }
+                while (!push_mt(h->mt, c)) {
+                    std::this_thread::yield();  // room exists but is being used by requeue
+                }
+                d.cancel();
+                return true;
+            }
+
+            static void done(LinuxHandle* h, C* c) {
+                c->~C();
+                h->resource.free(c);
+                h->mt->live.fetch_sub(1, std::memory_order_acq_rel);
+                h->mt->live.notify_all();  // wake run()
+            }
+
+            static void worker_main(LinuxHandle* h, Worker* w) {
+                auto mt = h->mt;
+                current_worker = w;
+                current_mt = mt;
+                while (true) {
+                    auto c = pop_local(*w);
+                    if (!c) {
+                        c = steal(mt, *w);
+                    }
+                    if (!c) {
+                        if (mt->stop.load(std::memory_order_acquire)) {
+                            break;
+                        }
+                        mt->sleepers.fetch_add(1, std::memory_order_seq_cst);
+                        auto e = mt->epoch.load(std::memory_order_seq_cst);
+                        c = pop_local(*w);
+                        if (!c) {
+                            c = steal(mt, *w);
+                        }
+                        if (!c && !mt->stop.load(std::memory_order_acquire)) {
+                            mt->epoch.wait(e, std::memory_order_seq_cst);
+                        }
+                        mt->sleepers.fetch_sub(1, std::memory_order_relaxed);
+                        if (!c) {
+                            continue;
+                        }
+                    }
+                    set_running(c);
+                    swap_context(w->root_ctx, as_coro_handle(c->handle)->ctx);
+                    set_running(nullptr);
+                    if (c->state == CState::done) {
+                        done(h, c);
+                        continue;
+                    }
+                    requeue(mt, *w, c);
+                }
+                current_worker = nullptr;
+                current_mt = nullptr;
+            }
+
+            static void suspend(C* c) {
+                c->state = CState::suspend;
+                swap_context(as_coro_handle(c->handle)->ctx, get_worker()->root_ctx);
+                c->state = CState::running;
+            }
+
+            static bool run(LinuxHandle* h) {
+                auto mt = h->mt;
+                auto live = mt->live.load(std::memory_order_acquire);
+                if (live != 0) {
+                    mt->live.wait(live, std::memory_order_acquire);
+                }
+                {
+                    const auto l = h->lock();
+                    if (h->except) {
+                        auto v = std::exchange(h->except, nullptr);
+                        std::rethrow_exception(v);
+                    }
+                }
+                return mt->live.load(std::memory_order_acquire) != 0;
+            }
+
+            static void destruct(LinuxHandle* h) {
+                auto mt = h->mt;
+                while (mt->live.load(std::memory_order_acquire) != 0) {
+                    run(h);
+                }
+                mt->stop.store(true, std::memory_order_release);
+                mt->epoch.fetch_add(1, std::memory_order_seq_cst);
+                mt->epoch.notify_all();
+                for (size_t i = 0; i < mt->n_worker; i++) {
+                    auto& w = mt->workers[i];
+                    if (w.th.joinable()) {
+                        w.th.join();
+                    }
+                    if (auto q = w.que.set_que(nullptr, 0)) {
+                        h->resource.free(q);
+                    }
+                    w.~Worker();
+                }
+                h->resource.free(mt->workers);
+                mt->~MultiThread();
+                h->resource.free(mt);
+                h->mt = nullptr;
+            }
+
+            static bool construct(LinuxHandle* h, size_t n_thread, size_t max_running, size_t max_idle) {
+                if (n_thread == 0) {
+                    n_thread = std::thread::hardware_concurrency();
+                    if (n_thread == 0) {
+                        n_thread = 1;
+                    }
+                }
+                auto v = h->resource.alloc(sizeof(MultiThread));
+                if (!v) {
+                    return false;
+                }
+                auto mt = new (v) MultiThread();
+                h->mt = mt;
+                auto w = h->resource.alloc(sizeof(Worker) * n_thread);
+                if (!w) {
+                    mt->~MultiThread();
+                    h->resource.free(mt);
+                    h->mt = nullptr;
+                    return false;
+                }
+                mt->workers = static_cast<Worker*>(w);
+                auto per_worker = max_running + max_idle;
+                mt->capacity = per_worker * n_thread;
+                // keep stacks up to queue capacity of all workers
+                h->stacks.init(coro_stack_size, per_worker * n_thread, max_running);
+                for (size_t i = 0; i < n_thread; i++) {
+                    auto worker = new (mt->workers + i) Worker();
+                    mt->n_worker++;
+                    auto q = h->resource.alloc(sizeof(C*) * per_worker);
+                    if (!q) {
+                        destruct(h);
+                        return false;
+                    }
+                    new (q) C* [per_worker] {};
+                    worker->que.set_que(static_cast<C**>(q), per_worker);
+                }
+                for (size_t i = 0; i < n_thread; i++) {
+                    mt->workers[i].th = std::thread(worker_main, h, mt->workers + i);
+                }
+                return true;
+            }
+        };
+
         bool C::add_coroutine(void* user, coro_t f) {
             if (!f) {
                 return false;
@@ -152,6 +701,9 @@ namespace futils {
             else {
                 m = this->main_;
             }
+            if (h->mt) {
+                return MultiThreadScheduler::add(h, m, user, f);
+            }
             const auto l = h->lock();
             if (h->idle.block()) {
                 return false;
@@ -164,7 +716,7 @@ namespace futils {
             auto d = helper::defer([&] {
                 h->resource.free(c);  // no destructor because no handle
             });
-            auto handle = setup_handle(8192, coro_sub, c);
+            auto handle = setup_handle(h->stacks, coro_sub, c);
             if (!handle) {
                 return false;
             }
@@ -192,16 +744,32 @@ namespace futils {
             if (!h->alloc_que(max_running, max_idle)) {
                 return nullptr;
             }
-            getcontext(&h->root_ctx);
             d.cancel();
             return h;
         }
 
+        bool C::construct_platform_mt(size_t n_thread, size_t max_running, size_t max_idle, Resource res) {
+            auto h = init_handle(1, 1, res);
+            if (!h) {
+                return false;
+            }
+            if (!MultiThreadScheduler::construct(h, n_thread, max_running, max_idle)) {
+                auto dealloc = h->resource.free;
+                h->~LinuxHandle();
+                dealloc(h);
+                return false;
+            }
+            handle = h;
+            return true;
+        }
+
         bool C::construct_platform(size_t max_running, size_t max_idle, Resource res) {
             auto h = init_handle(max_running, max_idle, res);
             if (!h) {
                 return false;
             }
+            // keep stacks up to concurrent coroutines and map some of them in advance
+            h->stacks.init(coro_stack_size, max_running + max_idle, max_running);
             handle = h;
             return true;
         }
@@ -211,10 +779,12 @@ namespace futils {
                 return;
             }
             auto h = as_handle(main_->handle);
+            if (h->mt) {
+                MultiThreadScheduler::suspend(this);
+                return;
+            }
             if (h->current != this) {
-                swapcontext(
-                    &as_coro_handle(this->handle)->ctx,
-                    &h->root_ctx);
+                swap_context(as_coro_handle(this->handle)->ctx, h->root_ctx);
                 return;
             }
             this->state = CState::suspend;
@@ -230,14 +800,12 @@ namespace futils {
             h->current = next;
             running_coro = next;
             if (next == nullptr) {
-                swapcontext(
-                    &as_coro_handle(this->handle)->ctx,
-                    &h->root_ctx);
+                swap_context(as_coro_handle(this->handle)->ctx, h->root_ctx);
                 return;
             }
             // currently access to this is still safe
-            swapcontext(&as_coro_handle(this->handle)->ctx,
-                        &as_coro_handle(next->handle)->ctx);
+            swap_context(as_coro_handle(this->handle)->ctx,
+                         as_coro_handle(next->handle)->ctx);
         }
 
         void C::destruct_platform() {
@@ -245,6 +813,9 @@ namespace futils {
                 return;
             }
             if (is_main()) {
+                if (as_handle(handle)->mt) {
+                    MultiThreadScheduler::destruct(as_handle(handle));
+                }
                 while (true) {
                     if (!run_platform()) {
                         break;
@@ -256,7 +827,7 @@ namespace futils {
                 dealloc(h);
             }
             else {
-                delete_handle(handle);
+                delete_handle(as_handle(main_->handle)->stacks, handle);
             }
         }
 
@@ -265,13 +836,16 @@ namespace futils {
                 return false;
             }
             auto h = as_handle(handle);
+            if (h->mt) {
+                return MultiThreadScheduler::run(h);
+            }
             h->fetch_tasks();
             h->current = h->running.pop();
             if (!h->current) {
                 return false;
             }
-            swapcontext(&h->root_ctx,
-                        &as_coro_handle(h->current->handle)->ctx);
+            swap_context(h->root_ctx,
+                         as_coro_handle(h->current->handle)->ctx);
             if (h->current && h->current->state == CState::done) {
                 h->current->~C();
                 h->resource.free(h->current);
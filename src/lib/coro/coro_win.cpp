@@ -122,6 +122,16 @@ namespace futils {
             return h;
         }
 
+        // M:N scheduler is not implemented with fiber yet
+        // fallback to single thread scheduler
+        bool C::construct_platform_mt(size_t, size_t max_running, size_t max_idle, Resource res) {
+            return construct_platform(max_running, max_idle, res);
+        }
+
+        void** C::thread_context_slot() const {
+            return nullptr;
+        }
+
         bool C::construct_platform(size_t max_running, size_t max_idle, Resource res) {
             auto h = init_handle(max_running, max_idle, res);
             if (!h) {
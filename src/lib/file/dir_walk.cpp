@@ -0,0 +1,534 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <platform/windows/dllexport_source.h>
+#include <platform/detect.h>
+#include <file/dir_walk.h>
+#include <helper/defer.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef FUTILS_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
+#include <string.h>
+#ifdef FUTILS_PLATFORM_LINUX
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace futils::file {
+
+    namespace {
+        using path_string = std::basic_string<wrap::path_char>;
+
+#ifdef FUTILS_PLATFORM_WINDOWS
+        constexpr wrap::path_char path_sep = L'\\';
+        using os_handle = HANDLE;
+        const os_handle invalid_handle = INVALID_HANDLE_VALUE;
+#else
+        constexpr wrap::path_char path_sep = '/';
+        using os_handle = int;
+        constexpr os_handle invalid_handle = -1;
+#endif
+        // upper bound of directory handles kept open in queue
+        // exceeded directory is queued by path and reopened from root
+        constexpr std::size_t max_queued_handle = 512;
+
+        struct DirWork {
+            os_handle handle = invalid_handle;
+            path_string path;  // relative to root
+            std::size_t depth = 0;
+        };
+
+        struct Walker {
+            const WalkOption& opt;
+            void* ctx;
+            bool (*filter)(void*, const DirEntry&);
+            void (*callback)(void*, const DirEntry&);
+#ifdef FUTILS_PLATFORM_WINDOWS
+            path_string root;
+#else
+            int root_fd = -1;
+#endif
+
+            std::mutex m;
+            std::condition_variable cv;
+            std::deque<DirWork> queue;
+            std::size_t pending = 0;  // queued + running
+            std::atomic_size_t queued_handle = 0;
+            std::atomic_bool stop = false;
+            FileError err{};
+            bool has_err = false;
+
+            void push(DirWork&& w) {
+                std::scoped_lock l{m};
+                pending++;
+                queue.push_back(std::move(w));
+                cv.notify_one();
+            }
+
+            bool pop(DirWork& w) {
+                std::unique_lock l{m};
+                cv.wait(l, [&] { return stop || !queue.empty() || pending == 0; });
+                if (stop || queue.empty()) {
+                    return false;
+                }
+                w = std::move(queue.front());
+                queue.pop_front();
+                return true;
+            }
+
+            void done() {
+                std::scoped_lock l{m};
+                if (--pending == 0) {
+                    cv.notify_all();
+                }
+            }
+
+            void fail(FileError e) {
+                std::scoped_lock l{m};
+                if (!has_err) {
+                    err = e;
+                    has_err = true;
+                }
+                if (opt.stop_on_error) {
+                    stop = true;
+                    cv.notify_all();
+                }
+            }
+
+            bool reserve_handle() {
+                if (queued_handle.fetch_add(1) < max_queued_handle) {
+                    return true;
+                }
+                queued_handle.fetch_sub(1);
+                return false;
+            }
+
+            bool report(DirEntry& e) {
+                if (filter && !filter(ctx, e)) {
+                    return false;
+                }
+                callback(ctx, e);
+                return true;
+            }
+
+            bool should_descend(const DirEntry& e) const {
+                return e.type == FileType::directory && e.depth + 1 <= opt.max_depth;
+            }
+
+            void scan(DirWork& w);
+
+            void run() {
+                DirWork w;
+                while (pop(w)) {
+                    scan(w);
+                    done();
+                }
+            }
+
+            void close_queued();
+        };
+
+#ifdef FUTILS_PLATFORM_WINDOWS
+        Time filetime_to_time(const FILETIME& ft) {
+            std::uint64_t t = (std::uint64_t(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+            t -= 116444736000000000;
+            t *= 100;
+            return Time{.sec = t / 1000000000, .nsec = std::uint32_t(t % 1000000000)};
+        }
+
+        FileType find_data_type(const WIN32_FIND_DATAW& data) {
+            if ((data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) &&
+                (data.dwReserved0 == IO_REPARSE_TAG_SYMLINK || data.dwReserved0 == IO_REPARSE_TAG_MOUNT_POINT)) {
+                return FileType::symlink;
+            }
+            if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                return FileType::directory;
+            }
+            if (data.dwFileAttributes & FILE_ATTRIBUTE_DEVICE) {
+                return FileType::device;
+            }
+            return FileType::regular;
+        }
+
+        void find_data_to_stat(const WIN32_FIND_DATAW& data, Stat& st) {
+            Perm perm;
+            perm.read(true);
+            if (!(data.dwFileAttributes & FILE_ATTRIBUTE_READONLY)) {
+                perm.write(true);
+            }
+            switch (find_data_type(data)) {
+                case FileType::symlink:
+                    st.mode.symlink(true);
+                    break;
+                case FileType::directory:
+                    st.mode.directory(true);
+                    perm.execute(true);
+                    break;
+                case FileType::device:
+                    st.mode.device(true);
+                    break;
+                default:
+                    break;
+            }
+            st.mode.perm(perm);
+            st.size = (std::uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+            st.create_time = filetime_to_time(data.ftCreationTime);
+            st.access_time = filetime_to_time(data.ftLastAccessTime);
+            st.mod_time = filetime_to_time(data.ftLastWriteTime);
+        }
+
+        // FindFirstFileExW returns attributes and size of entries with directory listing
+        // so no additional stat call is needed
+        void Walker::scan(DirWork& w) {
+            path_string pattern = root;
+            if (!w.path.empty()) {
+                pattern.push_back(path_sep);
+                pattern.append(w.path);
+            }
+            pattern.append(L"\\*");
+            WIN32_FIND_DATAW data{};
+            auto h = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+            if (h == INVALID_HANDLE_VALUE) {
+                fail(FileError{.method = "FindFirstFileExW", .err_code = GetLastError()});
+                return;
+            }
+            auto d = helper::defer([&] { FindClose(h); });
+            path_string path = w.path;
+            if (!path.empty()) {
+                path.push_back(path_sep);
+            }
+            const auto base_len = path.size();
+            do {
+                if (stop) {
+                    return;
+                }
+                auto name = view::basic_rvec<wrap::path_char>(data.cFileName, ::wcslen(data.cFileName));
+                if ((name.size() == 1 && name[0] == L'.') ||
+                    (name.size() == 2 && name[0] == L'.' && name[1] == L'.')) {
+                    continue;
+                }
+                path.resize(base_len);
+                path.append(name.data(), name.size());
+                DirEntry e;
+                e.name = name;
+                e.path = view::basic_rvec<wrap::path_char>(path.data(), path.size());
+                e.type = find_data_type(data);
+                e.depth = w.depth;
+                Stat st;
+                if (opt.stat) {
+                    find_data_to_stat(data, st);
+                    e.stat = &st;
+                }
+                if (e.type == FileType::symlink && opt.follow_symlink &&
+                    (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+                    e.type = FileType::directory;
+                }
+                if (!report(e)) {
+                    continue;
+                }
+                if (should_descend(e)) {
+                    push(DirWork{.path = path, .depth = w.depth + 1});
+                }
+            } while (FindNextFileW(h, &data));
+            auto code = GetLastError();
+            if (code != ERROR_NO_MORE_FILES) {
+                fail(FileError{.method = "FindNextFileW", .err_code = code});
+            }
+        }
+
+        void Walker::close_queued() {
+            queue.clear();
+        }
+#else
+        FileType mode_to_type(mode_t mode) {
+            if (S_ISREG(mode)) {
+                return FileType::regular;
+            }
+            if (S_ISDIR(mode)) {
+                return FileType::directory;
+            }
+            if (S_ISLNK(mode)) {
+                return FileType::symlink;
+            }
+            if (S_ISBLK(mode) || S_ISCHR(mode)) {
+                return FileType::device;
+            }
+            if (S_ISFIFO(mode)) {
+                return FileType::pipe;
+            }
+            if (S_ISSOCK(mode)) {
+                return FileType::socket;
+            }
+            return FileType::unknown;
+        }
+
+        FileType dtype_to_type(unsigned char d_type) {
+            switch (d_type) {
+                case DT_REG:
+                    return FileType::regular;
+                case DT_DIR:
+                    return FileType::directory;
+                case DT_LNK:
+                    return FileType::symlink;
+                case DT_BLK:
+                case DT_CHR:
+                    return FileType::device;
+                case DT_FIFO:
+                    return FileType::pipe;
+                case DT_SOCK:
+                    return FileType::socket;
+                default:
+                    return FileType::unknown;
+            }
+        }
+
+        void os_stat_to_stat(const struct stat& os, Stat& st) {
+            switch (mode_to_type(os.st_mode)) {
+                case FileType::directory:
+                    st.mode.directory(true);
+                    break;
+                case FileType::symlink:
+                    st.mode.symlink(true);
+                    break;
+                case FileType::device:
+                    st.mode.device(true);
+                    st.mode.char_device(S_ISCHR(os.st_mode));
+                    break;
+                case FileType::pipe:
+                    st.mode.pipe(true);
+                    break;
+                case FileType::socket:
+                    st.mode.socket(true);
+                    break;
+                default:
+                    break;
+            }
+            st.mode.perm(Perm(os.st_mode & 0777));
+            st.mode.uid(os.st_mode & S_ISUID);
+            st.mode.gid(os.st_mode & S_ISGID);
+            st.mode.sticky(os.st_mode & S_ISVTX);
+            st.size = os.st_size;
+#ifdef FUTILS_PLATFORM_MACOS
+            st.create_time = Time{std::uint64_t(os.st_ctimespec.tv_sec), std::uint32_t(os.st_ctimespec.tv_nsec)};
+            st.access_time = Time{std::uint64_t(os.st_atimespec.tv_sec), std::uint32_t(os.st_atimespec.tv_nsec)};
+            st.mod_time = Time{std::uint64_t(os.st_mtimespec.tv_sec), std::uint32_t(os.st_mtimespec.tv_nsec)};
+#else
+            st.create_time = Time{std::uint64_t(os.st_ctim.tv_sec), std::uint32_t(os.st_ctim.tv_nsec)};
+            st.access_time = Time{std::uint64_t(os.st_atim.tv_sec), std::uint32_t(os.st_atim.tv_nsec)};
+            st.mod_time = Time{std::uint64_t(os.st_mtim.tv_sec), std::uint32_t(os.st_mtim.tv_nsec)};
+#endif
+        }
+
+#ifdef FUTILS_PLATFORM_LINUX
+        struct linux_dirent64 {
+            ino64_t d_ino;
+            off64_t d_off;
+            unsigned short d_reclen;
+            unsigned char d_type;
+            char d_name[];
+        };
+
+        // read entries with getdents64 directly to avoid DIR* allocation and per entry call
+        // returns 0 or errno
+        int read_dir(int fd, auto&& cb) {
+            alignas(linux_dirent64) char buf[32 * 1024];
+            for (;;) {
+                auto n = ::syscall(SYS_getdents64, fd, buf, sizeof(buf));
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return errno;
+                }
+                if (n == 0) {
+                    return 0;
+                }
+                for (long off = 0; off < n;) {
+                    auto ent = reinterpret_cast<linux_dirent64*>(buf + off);
+                    off += ent->d_reclen;
+                    if (!cb(static_cast<const char*>(ent->d_name), ent->d_type)) {
+                        return 0;
+                    }
+                }
+            }
+        }
+#else
+        int read_dir(int fd, auto&& cb) {
+            auto dup_fd = ::dup(fd);
+            if (dup_fd < 0) {
+                return errno;
+            }
+            auto dir = ::fdopendir(dup_fd);
+            if (!dir) {
+                auto code = errno;
+                ::close(dup_fd);
+                return code;
+            }
+            auto d = helper::defer([&] { ::closedir(dir); });
+            for (;;) {
+                errno = 0;
+                auto ent = ::readdir(dir);
+                if (!ent) {
+                    return errno;
+                }
+                if (!cb(static_cast<const char*>(ent->d_name), ent->d_type)) {
+                    return 0;
+                }
+            }
+        }
+#endif
+
+        void Walker::scan(DirWork& w) {
+            int fd = w.handle;
+            if (fd < 0) {
+                fd = ::openat(root_fd, w.path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (fd < 0) {
+                    fail(FileError{.method = "openat", .err_code = errno});
+                    return;
+                }
+            }
+            else {
+                queued_handle.fetch_sub(1);
+            }
+            auto d = helper::defer([&] { ::close(fd); });
+            path_string path = w.path;
+            if (!path.empty()) {
+                path.push_back(path_sep);
+            }
+            const auto base_len = path.size();
+            auto code = read_dir(fd, [&](const char* name, unsigned char d_type) {
+                if (stop) {
+                    return false;
+                }
+                if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) {
+                    return true;
+                }
+                const auto name_len = ::strlen(name);
+                path.resize(base_len);
+                path.append(name, name_len);
+                DirEntry e;
+                e.name = view::basic_rvec<wrap::path_char>(name, name_len);
+                e.path = view::basic_rvec<wrap::path_char>(path.data(), path.size());
+                e.type = dtype_to_type(d_type);
+                e.depth = w.depth;
+                Stat st;
+                // stat only if required
+                if (opt.stat || e.type == FileType::unknown ||
+                    (e.type == FileType::symlink && opt.follow_symlink)) {
+                    struct stat os {};
+                    if (::fstatat(fd, name, &os, opt.follow_symlink ? 0 : AT_SYMLINK_NOFOLLOW) == 0) {
+                        e.type = mode_to_type(os.st_mode);
+                        if (opt.stat) {
+                            os_stat_to_stat(os, st);
+                            e.stat = &st;
+                        }
+                    }
+                }
+                if (!report(e)) {
+                    return true;
+                }
+                if (!should_descend(e)) {
+                    return true;
+                }
+                int sub = -1;
+                if (reserve_handle()) {
+                    sub = ::openat(fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC | (opt.follow_symlink ? 0 : O_NOFOLLOW));
+                    if (sub < 0) {
+                        queued_handle.fetch_sub(1);
+                        fail(FileError{.method = "openat", .err_code = errno});
+                        return !stop;
+                    }
+                }
+                push(DirWork{.handle = sub, .path = path, .depth = w.depth + 1});
+                return true;
+            });
+            if (code != 0) {
+                fail(FileError{.method = "getdents64", .err_code = code});
+            }
+        }
+
+        void Walker::close_queued() {
+            for (auto& w : queue) {
+                if (w.handle >= 0) {
+                    ::close(w.handle);
+                }
+            }
+            queue.clear();
+        }
+#endif
+    }  // namespace
+
+    file_result<void> STDCALL walk_directory(const wrap::path_char* root, const WalkOption& opt,
+                                             void* ctx,
+                                             bool (*filter)(void* ctx, const DirEntry& entry),
+                                             void (*callback)(void* ctx, const DirEntry& entry)) {
+        if (!root || !callback) {
+#ifdef FUTILS_PLATFORM_WINDOWS
+            return helper::either::unexpected(FileError{.method = "walk_directory", .err_code = ERROR_INVALID_PARAMETER});
+#else
+            return helper::either::unexpected(FileError{.method = "walk_directory", .err_code = EINVAL});
+#endif
+        }
+        Walker w{.opt = opt, .ctx = ctx, .filter = filter, .callback = callback};
+#ifdef FUTILS_PLATFORM_WINDOWS
+        w.root = root;
+        while (!w.root.empty() && (w.root.back() == L'\\' || w.root.back() == L'/')) {
+            w.root.pop_back();
+        }
+        auto attr = GetFileAttributesW(root);
+        if (attr == INVALID_FILE_ATTRIBUTES) {
+            return helper::either::unexpected(FileError{.method = "GetFileAttributesW", .err_code = GetLastError()});
+        }
+        if (!(attr & FILE_ATTRIBUTE_DIRECTORY)) {
+            return helper::either::unexpected(FileError{.method = "walk_directory", .err_code = ERROR_DIRECTORY});
+        }
+        w.push(DirWork{});
+#else
+        w.root_fd = ::open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (w.root_fd < 0) {
+            return helper::either::unexpected(FileError{.method = "open", .err_code = errno});
+        }
+        auto d = helper::defer([&] { ::close(w.root_fd); });
+        auto first = ::openat(w.root_fd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (first < 0) {
+            return helper::either::unexpected(FileError{.method = "openat", .err_code = errno});
+        }
+        w.queued_handle = 1;
+        w.push(DirWork{.handle = first});
+#endif
+        auto n = opt.threads;
+        if (n == 0) {
+            n = std::thread::hardware_concurrency();
+        }
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < n; i++) {
+            workers.emplace_back([&] { w.run(); });
+        }
+        w.run();  // calling thread is also worker
+        for (auto& t : workers) {
+            t.join();
+        }
+        w.close_queued();
+        if (w.has_err && opt.stop_on_error) {
+            return helper::either::unexpected(w.err);
+        }
+        return {};
+    }
+
+}  // namespace futils::file
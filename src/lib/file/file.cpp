@@ -22,6 +22,8 @@
 #include <errno.h>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <limits.h>
 
 #endif
 
@@ -254,7 +256,13 @@ namespace futils::file {
         return {};
     }
 
-    file_result<MMap> File::mmap(Mode m) const {
+    std::size_t STDCALL mmap_granularity() {
+        SYSTEM_INFO info{};
+        GetSystemInfo(&info);
+        return info.dwAllocationGranularity;
+    }
+
+    file_result<MMap> File::mmap(Mode m, const MMapOption& opt) const {
         if (handle == ~0) {
             return helper::either::unexpected(FileError{.method = "File::mmap", .err_code = ERROR_INVALID_PARAMETER});
         }
@@ -265,6 +273,18 @@ namespace futils::file {
         if ((s->mode.perm() & m.perm()) != m.perm()) {
             return helper::either::unexpected(FileError{.method = "File::mmap", .err_code = ERROR_ACCESS_DENIED});
         }
+        if (opt.offset % mmap_granularity() != 0 || opt.offset > s->size) {
+            return helper::either::unexpected(FileError{.method = "File::mmap", .err_code = ERROR_INVALID_PARAMETER});
+        }
+        std::size_t len = s->size - opt.offset;
+        if (opt.length != 0 && opt.length < len) {
+            len = opt.length;
+        }
+        if (len == 0) {
+            // MapViewOfFile treats 0 as until end of file and CreateFileMappingW rejects empty file
+            // so empty range can not be mapped
+            return helper::either::unexpected(FileError{.method = "File::mmap", .err_code = ERROR_INVALID_PARAMETER});
+        }
         int page_flag = 0;
         int file_map_flag = 0;
         if (m.perm().owner_write()) {
@@ -281,12 +301,42 @@ namespace futils::file {
             return helper::either::unexpected(FileError{.method = "CreateFileMappingW", .err_code = GetLastError()});
         }
         auto d = futils::helper::defer([&] { CloseHandle(m_handle); });
-        auto ptr = MapViewOfFile(m_handle, file_map_flag, 0, 0, 0);
+        auto ptr = MapViewOfFile(m_handle, file_map_flag, DWORD(opt.offset >> 32), DWORD(opt.offset & 0xffffffff), len);
         if (ptr == nullptr) {
             return helper::either::unexpected(FileError{.method = "MapViewOfFile", .err_code = GetLastError()});
         }
         d.cancel();
-        return MMap(reinterpret_cast<byte*>(ptr), std::uintptr_t(m_handle), s->size, m);
+        auto map = MMap(reinterpret_cast<byte*>(ptr), std::uintptr_t(m_handle), len, opt.offset, m);
+        // hints are best effort
+        if (opt.populate) {
+            map.advise(MMapAdvice::will_need);
+        }
+        else if (opt.advice != MMapAdvice::normal) {
+            map.advise(opt.advice);
+        }
+        return map;
+    }
+
+    file_result<void> MMap::advise(MMapAdvice advice, std::size_t offset, std::size_t len) const {
+        if (!ptr) {
+            return helper::either::unexpected(FileError{.method = "MMap::advise", .err_code = ERROR_INVALID_PARAMETER});
+        }
+        if (offset >= file_len) {
+            return {};
+        }
+        if (len > file_len - offset) {
+            len = file_len - offset;
+        }
+        if (advice != MMapAdvice::will_need) {
+            return {};  // no equivalent
+        }
+        WIN32_MEMORY_RANGE_ENTRY entry{};
+        entry.VirtualAddress = ptr + offset;
+        entry.NumberOfBytes = len;
+        if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0)) {
+            return helper::either::unexpected(FileError{.method = "PrefetchVirtualMemory", .err_code = GetLastError()});
+        }
+        return {};
     }
 
     file_result<void> MMap::unmap() {
@@ -319,6 +369,91 @@ namespace futils::file {
         return view::rvec(r.data() + written, r.size() - written);
     }
 
+    // windows has no general gather/scatter io for buffered handle (WriteFileGather requires page aligned buffer)
+    // so emulate with loop of WriteFile/ReadFile
+    file_result<size_t> File::write_vec(const view::rvec* vec, size_t count) const {
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            auto res = write_file(vec[i]);
+            if (!res) {
+                if (total) {
+                    return total;
+                }
+                return helper::either::unexpected(res.error());
+            }
+            total += vec[i].size() - res->size();
+            if (res->size()) {
+                break;
+            }
+        }
+        return total;
+    }
+
+    file_result<size_t> File::write_vec_at(const view::rvec* vec, size_t count, std::uint64_t offset) const {
+        auto h = reinterpret_cast<HANDLE>(handle);
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            OVERLAPPED ol{};
+            ol.Offset = DWORD((offset + total) & 0xffffffff);
+            ol.OffsetHigh = DWORD((offset + total) >> 32);
+            DWORD written = 0;
+            if (!WriteFile(h, vec[i].data(), vec[i].size(), &written, &ol)) {
+                if (total) {
+                    return total;
+                }
+                return helper::either::unexpected(FileError{.method = "WriteFile", .err_code = GetLastError()});
+            }
+            total += written;
+            if (written != vec[i].size()) {
+                break;
+            }
+        }
+        return total;
+    }
+
+    file_result<size_t> File::read_vec(const view::wvec* vec, size_t count) const {
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            auto res = read_file(vec[i]);
+            if (!res) {
+                if (total) {
+                    return total;
+                }
+                return helper::either::unexpected(res.error());
+            }
+            total += res->size();
+            if (res->size() != vec[i].size()) {
+                break;
+            }
+        }
+        return total;
+    }
+
+    file_result<size_t> File::read_vec_at(const view::wvec* vec, size_t count, std::uint64_t offset) const {
+        auto h = reinterpret_cast<HANDLE>(handle);
+        size_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            OVERLAPPED ol{};
+            ol.Offset = DWORD((offset + total) & 0xffffffff);
+            ol.OffsetHigh = DWORD((offset + total) >> 32);
+            DWORD read = 0;
+            if (!ReadFile(h, vec[i].data(), vec[i].size(), &read, &ol)) {
+                if (GetLastError() == ERROR_HANDLE_EOF) {
+                    break;
+                }
+                if (total) {
+                    return total;
+                }
+                return helper::either::unexpected(FileError{.method = "ReadFile", .err_code = GetLastError()});
+            }
+            total += read;
+            if (read != vec[i].size()) {
+                break;
+            }
+        }
+        return total;
+    }
+
     file_result<view::basic_rvec<wrap::path_char>> File::write_console(view::basic_rvec<wrap::path_char> w) const {
         auto h = reinterpret_cast<HANDLE>(handle);
         DWORD written = 0;
@@ -453,6 +588,12 @@ namespace futils::file {
 
 #else
 
+#ifdef IOV_MAX
+    constexpr size_t internal_iov_max = IOV_MAX < 1024 ? IOV_MAX : 1024;
+#else
+    constexpr size_t internal_iov_max = 1024;
+#endif
+
     struct StrHolder {
        private:
         const char *buf;
@@ -785,7 +926,11 @@ namespace futils::file {
         return {};
     }
 
-    file_result<MMap> File::mmap(Mode m) const {
+    std::size_t mmap_granularity() {
+        return getpagesize();
+    }
+
+    file_result<MMap> File::mmap(Mode m, const MMapOption &opt) const {
         if (handle == ~0) {
             return helper::either::unexpected(FileError{.method = "File::mmap", .err_code = EBADF});
         }
@@ -796,6 +941,14 @@ namespace futils::file {
         if ((s->mode.perm() & m.perm()) != m.perm()) {
             return helper::either::unexpected(FileError{.method = "File::mmap", .err_code = EACCES});
         }
+        auto page = getpagesize();
+        if (opt.offset % page != 0 || opt.offset > s->size) {
+            return helper::either::unexpected(FileError{.method = "File::mmap", .err_code = EINVAL});
+        }
+        std::size_t len = s->size - opt.offset;
+        if (opt.length != 0 && opt.length < len) {
+            len = opt.length;
+        }
         int prot_flag = 0;
         if (m.perm().owner_write()) {
             prot_flag |= PROT_WRITE;
@@ -810,13 +963,82 @@ namespace futils::file {
         if (m.temporary()) {
             map_flag = MAP_PRIVATE;
         }
-        auto page = getpagesize();
-        auto size = (s->size / page + 1) * page;
-        auto ptr = ::mmap(nullptr, size, prot_flag, map_flag, handle, 0);
+#ifdef MAP_POPULATE
+        if (opt.populate) {
+            map_flag |= MAP_POPULATE;
+        }
+#endif
+        auto size = (len / page + 1) * page;
+        auto ptr = ::mmap(nullptr, size, prot_flag, map_flag, handle, opt.offset);
         if (ptr == MAP_FAILED) {
             return helper::either::unexpected(FileError{.method = "mmap", .err_code = errno});
         }
-        return MMap(reinterpret_cast<byte *>(ptr), size, s->size, m);
+        auto map = MMap(reinterpret_cast<byte *>(ptr), size, len, opt.offset, m);
+        // hints are best effort
+#ifndef MAP_POPULATE
+        if (opt.populate) {
+            map.advise(MMapAdvice::will_need);
+        }
+#endif
+        if (opt.huge_page) {
+            map.advise(MMapAdvice::huge_page);
+        }
+        if (opt.advice != MMapAdvice::normal) {
+            map.advise(opt.advice);
+        }
+        return map;
+    }
+
+    file_result<void> MMap::advise(MMapAdvice advice, std::size_t offset, std::size_t len) const {
+        if (!ptr) {
+            return helper::either::unexpected(FileError{.method = "MMap::advise", .err_code = EINVAL});
+        }
+        if (offset >= file_len) {
+            return {};
+        }
+        if (len > file_len - offset) {
+            len = file_len - offset;
+        }
+        // madvise requires page aligned address
+        auto page = std::size_t(getpagesize());
+        auto aligned = offset / page * page;
+        len += offset - aligned;
+#ifdef FUTILS_PLATFORM_WASI
+        return {};  // emulated mman has no madvise
+#else
+        int adv = 0;
+        switch (advice) {
+            case MMapAdvice::normal:
+                adv = MADV_NORMAL;
+                break;
+            case MMapAdvice::sequential:
+                adv = MADV_SEQUENTIAL;
+                break;
+            case MMapAdvice::random:
+                adv = MADV_RANDOM;
+                break;
+            case MMapAdvice::will_need:
+                adv = MADV_WILLNEED;
+                break;
+            case MMapAdvice::dont_need:
+                adv = MADV_DONTNEED;
+                break;
+#ifdef MADV_HUGEPAGE
+            case MMapAdvice::huge_page:
+                adv = MADV_HUGEPAGE;
+                break;
+            case MMapAdvice::no_huge_page:
+                adv = MADV_NOHUGEPAGE;
+                break;
+#endif
+            default:
+                return {};  // not supported on this platform
+        }
+        if (::madvise(ptr + aligned, len, adv) != 0) {
+            return helper::either::unexpected(FileError{.method = "madvise", .err_code = errno});
+        }
+        return {};
+#endif
     }
 
     file_result<void> MMap::unmap() {
@@ -840,6 +1062,59 @@ namespace futils::file {
         return view::rvec(r.data() + written, r.size() - written);
     }
 
+    // convert to struct iovec at most IOV_MAX entries
+    template <class Vec>
+    size_t to_iovec(struct iovec (&iov)[internal_iov_max], const Vec *vec, size_t count) {
+        if (count > internal_iov_max) {
+            count = internal_iov_max;
+        }
+        for (size_t i = 0; i < count; i++) {
+            iov[i].iov_base = const_cast<byte *>(vec[i].data());
+            iov[i].iov_len = vec[i].size();
+        }
+        return count;
+    }
+
+    file_result<size_t> File::write_vec(const view::rvec *vec, size_t count) const {
+        struct iovec iov[internal_iov_max];
+        count = to_iovec(iov, vec, count);
+        auto written = ::writev(handle, iov, count);
+        if (written < 0) {
+            return helper::either::unexpected(FileError{.method = "writev", .err_code = errno});
+        }
+        return size_t(written);
+    }
+
+    file_result<size_t> File::write_vec_at(const view::rvec *vec, size_t count, std::uint64_t offset) const {
+        struct iovec iov[internal_iov_max];
+        count = to_iovec(iov, vec, count);
+        auto written = ::pwritev(handle, iov, count, offset);
+        if (written < 0) {
+            return helper::either::unexpected(FileError{.method = "pwritev", .err_code = errno});
+        }
+        return size_t(written);
+    }
+
+    file_result<size_t> File::read_vec(const view::wvec *vec, size_t count) const {
+        struct iovec iov[internal_iov_max];
+        count = to_iovec(iov, vec, count);
+        auto read = ::readv(handle, iov, count);
+        if (read < 0) {
+            return helper::either::unexpected(FileError{.method = "readv", .err_code = errno});
+        }
+        return size_t(read);
+    }
+
+    file_result<size_t> File::read_vec_at(const view::wvec *vec, size_t count, std::uint64_t offset) const {
+        struct iovec iov[internal_iov_max];
+        count = to_iovec(iov, vec, count);
+        auto read = ::preadv(handle, iov, count, offset);
+        if (read < 0) {
+            return helper::either::unexpected(FileError{.method = "preadv", .err_code = errno});
+        }
+        return size_t(read);
+    }
+
     file_result<view::basic_rvec<wrap::path_char>> File::write_console(view::basic_rvec<wrap::path_char> w) const {
         return write_file(view::rvec(w.data(), w.size())).transform([&](view::rvec r) {
             return view::basic_rvec<wrap::path_char>(r.data(), r.size());
@@ -41,16 +41,14 @@ namespace futils::fnet {
         auto t = static_cast<EpollTable*>(b);
         // at here, if we can get callback, we execute it
         EpollIOTableHeader& io = w ? static_cast<EpollIOTableHeader&>(t->w) : t->r;
+        if (t->uring) {
+            return uring::cancel(t, io, cancel_code);
+        }
         void (*notify)() = nullptr;
         void* user = nullptr;
         NotifyCallback::call_t call = nullptr;
         auto result = io.l.interrupt(cancel_code, [&]() -> expected<void> {
-            while (io.epoll_lock) {
-                timespec spec;
-                spec.tv_sec = 0;
-                spec.tv_nsec = 1;
-                nanosleep(&spec, &spec);
-            }
+            io.reg.wait_idle();
             if (auto call_ = io.cb.call.exchange(nullptr)) {
                 call = call_;
                 notify = io.cb.notify;
@@ -69,16 +67,15 @@ namespace futils::fnet {
     namespace event {
         fnet_dll_implement(void) fnet_handle_completion(void* p, void*) {
             auto event = static_cast<epoll_event*>(p);
+            if (event->data.u64 & uring::kind_mask) {
+                uring::handle_completion(event->data.u64, std::int32_t(event->events));
+                return;
+            }
             auto tbl = static_cast<EpollTable*>(event->data.ptr);
             auto events = event->events;
             if (events & (EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
                 if (tbl->r.cb.call) {
-                    while (tbl->r.epoll_lock) {
-                        timespec spec;
-                        spec.tv_sec = 0;
-                        spec.tv_nsec = 1;
-                        nanosleep(&spec, &spec);
-                    }
+                    tbl->r.reg.wait_idle();
                     if (auto call = tbl->r.cb.call.exchange(nullptr)) {
                         auto notify = tbl->r.cb.notify;
                         auto user = tbl->r.cb.user;
@@ -88,12 +85,7 @@ namespace futils::fnet {
             }
             if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) {
                 if (tbl->w.cb.call) {
-                    while (tbl->w.epoll_lock) {
-                        timespec spec;
-                        spec.tv_sec = 0;
-                        spec.tv_nsec = 1;
-                        nanosleep(&spec, &spec);
-                    }
+                    tbl->w.reg.wait_idle();
                     if (auto call = tbl->w.cb.call.exchange(nullptr)) {
                         auto notify = tbl->w.cb.notify;
                         auto user = tbl->w.cb.user;
@@ -198,8 +190,8 @@ namespace futils::fnet {
         return io.l.try_lock()  // lock released by call_stream
             .and_then([&](std::uint64_t cancel_code) {
                 io.base = t;
-                io.epoll_lock = true;
-                const auto d = helper::defer([&] { io.epoll_lock = false; });  // anyway, release finally
+                io.reg.begin();
+                const auto d = helper::defer([&] { io.reg.end(); });  // anyway, release finally
                 cb.set_notify(c, notify, call);
                 t->incr();  // increment, released by Socket passed to notify() or on_success()
                 auto result = do_io(t->sock, buffer, flag);
@@ -222,8 +214,8 @@ namespace futils::fnet {
                     io.l.unlock();
                     return unexpect(error::Error("unsupported address type", error::Category::lib, error::fnet_usage_error));
                 }
-                io.epoll_lock = true;
-                const auto d = helper::defer([&] { io.epoll_lock = false; });  // anyway, release finally
+                io.reg.begin();
+                const auto d = helper::defer([&] { io.reg.end(); });  // anyway, release finally
                 cb.set_notify(c, notify, call);
                 t->incr();  // increment, released by Socket passed to notify() or on_success()
 
@@ -242,6 +234,9 @@ namespace futils::fnet {
 
     expected<AsyncResult> Socket::read_async(view::wvec buffer, void* c, stream_notify_t notify, std::uint32_t flag) {
         return get_tbl(ctx).and_then([&](EpollTable* t) {
+            if (t->uring) {
+                return uring::read_async(t, buffer, c, notify, flag);
+            }
             return async_stream_operation(t, buffer, flag, c, notify, false, call_stream, [](auto sock, auto buffer, auto flag) {
                 return lazy::recv_(sock, (char*)buffer.as_char(), buffer.size(), flag);
             });
@@ -250,6 +245,9 @@ namespace futils::fnet {
 
     expected<AsyncResult> Socket::write_async(view::rvec buffer, void* c, stream_notify_t notify, std::uint32_t flag) {
         return get_tbl(ctx).and_then([&](EpollTable* t) {
+            if (t->uring) {
+                return uring::write_async(t, buffer, c, notify, flag);
+            }
             return async_stream_operation(t, buffer, flag, c, notify, true, call_stream, [](auto sock, auto buffer, auto flag) {
                 return lazy::send_(sock, (const char*)buffer.as_char(), buffer.size(), flag);
             });
@@ -258,6 +256,9 @@ namespace futils::fnet {
 
     expected<AsyncResult> Socket::readfrom_async(view::wvec buffer, NetAddrPort& addr, void* c, recvfrom_notify_t notify, std::uint32_t flag) {
         return get_tbl(ctx).and_then([&](EpollTable* t) -> expected<AsyncResult> {
+            if (t->uring) {
+                return uring::readfrom_async(t, buffer, addr, c, notify, flag);
+            }
             sockaddr_storage storage;
             socklen_t size = sizeof(storage);
             return async_packet_operation(
@@ -274,7 +275,10 @@ namespace futils::fnet {
     }
 
     expected<AsyncResult> Socket::writeto_async(view::rvec buffer, const NetAddrPort& addr, void* c, stream_notify_t notify, std::uint32_t flag) {
-        return get_tbl(ctx).and_then([&](EpollTable* t) {
+        return get_tbl(ctx).and_then([&](EpollTable* t) -> expected<AsyncResult> {
+            if (t->uring) {
+                return uring::writeto_async(t, buffer, addr, c, notify, flag);
+            }
             sockaddr_storage storage;
             socklen_t size = sizeof(storage);
             return async_packet_operation(
@@ -293,11 +297,14 @@ namespace futils::fnet {
 
     expected<AcceptAsyncResult<Socket>> Socket::accept_async(NetAddrPort& addr, void* c, accept_notify_t notify, std::uint32_t flag) {
         return get_tbl(ctx).and_then([&](EpollTable* t) -> expected<AcceptAsyncResult<Socket>> {
+            if (t->uring) {
+                return uring::accept_async(t, addr, c, notify, flag);
+            }
             sockaddr_storage storage;
+            socklen_t size = sizeof(storage);  // must outlive do_io
             auto r = async_packet_operation(
                 t, view::rvec(), flag, c, notify,
                 [&](EpollIOTableHeader& hdr) -> std::pair<sockaddr*, socklen_t*> {
-                    socklen_t size = sizeof(storage);
                     return std::make_pair((sockaddr*)&storage, &size);
                 },
                 false, call_accept,
@@ -317,7 +324,7 @@ namespace futils::fnet {
                     return unexpect(r.error());
                 }
                 result.socket = std::move(*r);
-                addr = sockaddr_to_NetAddrPort((sockaddr*)&storage, sizeof(storage));
+                addr = sockaddr_to_NetAddrPort((sockaddr*)&storage, size);
             }
             return result;
         });
@@ -328,7 +335,10 @@ namespace futils::fnet {
     }
 
     expected<AsyncResult> Socket::connect_async(const NetAddrPort& addr, void* c, stream_notify_t notify, std::uint32_t flag) {
-        return get_tbl(ctx).and_then([&](EpollTable* t) {
+        return get_tbl(ctx).and_then([&](EpollTable* t) -> expected<AsyncResult> {
+            if (t->uring) {
+                return uring::connect_async(t, addr, c, notify, flag);
+            }
             socklen_t tmp = 0;
             sockaddr_storage storage;
             return async_packet_operation(
@@ -349,11 +359,19 @@ namespace futils::fnet {
         auto tbl = new_glheap(EpollTable);
         tbl->sock = sock;
         tbl->event = event;
+        tbl->uring = event->uring_ring();
+        if (tbl->uring) {
+            tbl->on_last_ref = uring::on_last_ref;
+        }
         return tbl;
     }
 
     void destroy_platform(SockTable* s) {
-        delete_glheap(static_cast<EpollTable*>(s));
+        auto t = static_cast<EpollTable*>(s);
+        if (t->uring) {
+            uring::destroy(t);
+        }
+        delete_glheap(t);
     }
 
     void sockclose(std::uintptr_t sock) {
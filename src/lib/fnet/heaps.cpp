@@ -9,6 +9,15 @@
 #include <fnet/heap.h>
 #include <fnet/dll/glheap.h>
 #include <platform/detect.h>
+#include <thread/lite_lock.h>
+#include <core/byte.h>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <utility>
 #ifdef FUTILS_PLATFORM_WINDOWS
 #include <Windows.h>
 #else
@@ -45,6 +54,311 @@ namespace futils {
         }
 #endif
 
+        // slab allocator used as default objpool allocator
+        // each object has 16 byte header holding its size class, so free and realloc need no size
+        // each thread caches two magazines (fixed size array of free objects) per size class
+        // and exchanges full or empty magazine with global depot, so depot lock is taken once per magazine
+        // (see "Magazines and Vmem" (Bonwick and Adams))
+        // memory of slabs is kept by pool and never returned to heap
+        namespace objpool {
+            struct Header {
+                std::uint32_t cls = 0;
+                std::uint32_t offset = 0;  // from base pointer of large object
+                size_t size = 0;           // size of large object
+            };
+
+            constexpr size_t header_size = 16;
+            static_assert(sizeof(Header) <= header_size);
+            constexpr std::uint32_t large_class = ~std::uint32_t(0);
+            constexpr size_t slab_size = 64 * 1024;
+            constexpr size_t max_magazine = 64;
+            // 16 byte step up to 128, then 4 classes per power of 2 up to 4096
+            constexpr size_t num_classes = 28;
+            constexpr size_t max_class_size = 4096;
+
+            constexpr size_t class_size(size_t cls) {
+                if (cls < 8) {
+                    return 16 * (cls + 1);
+                }
+                auto base = size_t(128) << ((cls - 8) / 4);
+                return base + base / 4 * ((cls - 8) % 4 + 1);
+            }
+
+            constexpr size_t class_index(size_t size) {
+                if (size <= 128) {
+                    return size ? (size + 15) / 16 - 1 : 0;
+                }
+                auto s = size - 1;
+                auto width = std::bit_width(s);
+                auto base = size_t(1) << (width - 1);
+                return 8 + (width - 8) * 4 + (s - base) / (base / 4);
+            }
+
+            static_assert(class_size(num_classes - 1) == max_class_size);
+            static_assert(class_index(129) == 8 && class_size(8) == 160);
+            static_assert(class_index(4096) == num_classes - 1);
+
+            constexpr size_t magazine_size(size_t cls) {
+                return std::clamp<size_t>(8192 / class_size(cls), 8, max_magazine);
+            }
+
+            struct Magazine {
+                Magazine* next = nullptr;
+                size_t count = 0;
+                void* objs[max_magazine];
+            };
+
+            struct alignas(64) Depot {
+                thread::LiteLock lock;
+                Magazine* full = nullptr;  // magazines which have at least one object
+                Magazine* empty = nullptr;
+                void* loose = nullptr;  // objects freed without thread cache. linked through object
+                byte* cur = nullptr;
+                byte* end = nullptr;
+                // statistics
+                size_t slabs = 0;
+                size_t objects = 0;
+                size_t depot_objects = 0;
+                size_t refills = 0;
+                size_t returns = 0;
+            };
+
+            Depot depots[num_classes];
+
+            struct ThreadCache {
+                Magazine* loaded[num_classes];
+                Magazine* previous[num_classes];
+            };
+
+            thread_local ThreadCache cache;
+            thread_local std::uint8_t cache_state = 0;  // 0: not initialized, 1: alive, 2: released
+
+            byte* header_of(void* p) {
+                return static_cast<byte*>(p) - header_size;
+            }
+
+            // lock must be held
+            Magazine* get_empty(Depot& d) {
+                if (d.empty) {
+                    auto m = d.empty;
+                    d.empty = m->next;
+                    return m;
+                }
+                auto m = simple_heap_alloc(nullptr, sizeof(Magazine), alignof(Magazine), nullptr);
+                return m ? new (m) Magazine{} : nullptr;
+            }
+
+            // lock must be held
+            void put_magazine(Depot& d, Magazine* m) {
+                if (!m) {
+                    return;
+                }
+                if (m->count) {
+                    m->next = d.full;
+                    d.full = m;
+                    d.depot_objects += m->count;
+                }
+                else {
+                    m->next = d.empty;
+                    d.empty = m;
+                }
+            }
+
+            // lock must be held
+            void* carve(Depot& d, std::uint32_t cls) {
+                if (d.loose) {
+                    auto p = d.loose;
+                    d.loose = *static_cast<void**>(p);
+                    d.depot_objects--;
+                    return p;
+                }
+                const auto stride = header_size + class_size(cls);
+                if (d.cur == d.end) {
+                    auto slab = static_cast<byte*>(simple_heap_alloc(nullptr, slab_size, header_size, nullptr));
+                    if (!slab) {
+                        return nullptr;
+                    }
+                    d.cur = slab;
+                    d.end = slab + slab_size / stride * stride;
+                    d.slabs++;
+                }
+                auto h = new (d.cur) Header{.cls = cls};
+                d.cur += stride;
+                d.objects++;
+                return reinterpret_cast<byte*>(h) + header_size;
+            }
+
+            void release_cache() {
+                for (size_t i = 0; i < num_classes; i++) {
+                    if (!cache.loaded[i] && !cache.previous[i]) {
+                        continue;
+                    }
+                    std::lock_guard l{depots[i].lock};
+                    put_magazine(depots[i], std::exchange(cache.loaded[i], nullptr));
+                    put_magazine(depots[i], std::exchange(cache.previous[i], nullptr));
+                }
+                cache_state = 2;
+            }
+
+            struct CacheReleaser {
+                ~CacheReleaser() {
+                    release_cache();
+                }
+            };
+
+            // returns nullptr after thread cache is released at thread exit
+            ThreadCache* thread_cache() {
+                if (cache_state == 1) [[likely]] {
+                    return &cache;
+                }
+                if (cache_state == 2) {
+                    return nullptr;
+                }
+                thread_local CacheReleaser releaser;  // registers release_cache on thread exit
+                cache_state = 1;
+                return &cache;
+            }
+
+            void* large_alloc(size_t size, size_t align) {
+                const auto pad = align > header_size ? align : 0;
+                auto base = static_cast<byte*>(simple_heap_alloc(nullptr, header_size + size + pad, header_size, nullptr));
+                if (!base) {
+                    return nullptr;
+                }
+                auto obj = base + header_size;
+                if (pad) {
+                    obj = reinterpret_cast<byte*>((std::uintptr_t(obj) + align - 1) & ~(std::uintptr_t(align) - 1));
+                }
+                new (obj - header_size) Header{.cls = large_class, .offset = std::uint32_t(obj - base), .size = size};
+                return obj;
+            }
+
+            void* alloc_slow(ThreadCache* c, std::uint32_t cls) {
+                auto& l = c->loaded[cls];
+                auto& p = c->previous[cls];
+                if (p && p->count) {
+                    std::swap(l, p);
+                    return l->objs[--l->count];
+                }
+                auto& d = depots[cls];
+                std::lock_guard g{d.lock};
+                if (d.full) {
+                    // keep one empty magazine for next free
+                    put_magazine(d, p);
+                    p = l;
+                    l = d.full;
+                    d.full = l->next;
+                    d.depot_objects -= l->count;
+                    d.refills++;
+                    return l->objs[--l->count];
+                }
+                if (!l) {
+                    l = get_empty(d);
+                    if (!l) {
+                        return carve(d, cls);
+                    }
+                }
+                // fill magazine from slab by batch
+                for (auto n = magazine_size(cls); l->count < n;) {
+                    auto obj = carve(d, cls);
+                    if (!obj) {
+                        break;
+                    }
+                    l->objs[l->count++] = obj;
+                }
+                return l->count ? l->objs[--l->count] : nullptr;
+            }
+
+            void free_slow(ThreadCache* c, std::uint32_t cls, void* obj) {
+                auto& l = c->loaded[cls];
+                auto& p = c->previous[cls];
+                if (p && p->count == 0) {
+                    std::swap(l, p);
+                    l->objs[l->count++] = obj;
+                    return;
+                }
+                auto& d = depots[cls];
+                std::lock_guard g{d.lock};
+                if (l) {
+                    put_magazine(d, l);
+                    d.returns++;
+                }
+                l = get_empty(d);
+                if (!l) {
+                    *static_cast<void**>(obj) = d.loose;
+                    d.loose = obj;
+                    d.depot_objects++;
+                    return;
+                }
+                l->objs[l->count++] = obj;
+            }
+
+            void* alloc(void*, size_t size, size_t align, DebugInfo*) {
+                if (size > max_class_size || align > header_size) {
+                    return large_alloc(size, align);
+                }
+                auto cls = std::uint32_t(class_index(size));
+                auto c = thread_cache();
+                if (!c) {
+                    std::lock_guard g{depots[cls].lock};
+                    return carve(depots[cls], cls);
+                }
+                auto l = c->loaded[cls];
+                if (l && l->count) [[likely]] {
+                    return l->objs[--l->count];
+                }
+                return alloc_slow(c, cls);
+            }
+
+            void free(void*, void* p, DebugInfo*) {
+                if (!p) {
+                    return;
+                }
+                auto h = reinterpret_cast<Header*>(header_of(p));
+                auto cls = h->cls;
+                if (cls == large_class) {
+                    simple_heap_free(nullptr, static_cast<byte*>(p) - h->offset, nullptr);
+                    return;
+                }
+                auto c = thread_cache();
+                if (!c) {
+                    auto& d = depots[cls];
+                    std::lock_guard g{d.lock};
+                    *static_cast<void**>(p) = d.loose;
+                    d.loose = p;
+                    d.depot_objects++;
+                    return;
+                }
+                auto l = c->loaded[cls];
+                if (l && l->count < magazine_size(cls)) [[likely]] {
+                    l->objs[l->count++] = p;
+                    return;
+                }
+                free_slow(c, cls, p);
+            }
+
+            void* realloc(void* ctx, void* p, size_t size, size_t align, DebugInfo* info) {
+                if (!p) {
+                    return alloc(ctx, size, align, info);
+                }
+                if (size == 0) {
+                    return nullptr;
+                }
+                auto h = reinterpret_cast<Header*>(header_of(p));
+                auto old = h->cls == large_class ? h->size : class_size(h->cls);
+                if (h->cls != large_class && size <= old && align <= header_size) {
+                    return p;
+                }
+                auto n = alloc(ctx, size, align, info);
+                if (!n) {
+                    return nullptr;
+                }
+                std::memcpy(n, p, std::min(old, size));
+                free(ctx, p, info);
+                return n;
+            }
+        }  // namespace objpool
+
         static Allocs normal_hold;
         static Allocs objpool_hold;
         fnet_dll_implement(void) set_normal_allocs(Allocs set) {
@@ -76,10 +390,32 @@ namespace futils {
         }
 
         Allocs* get_objpool_alloc() {
-            static Allocs alloc = get_(objpool_hold);
+            static Allocs alloc = [] {
+                if (!objpool_hold.alloc_ptr || !objpool_hold.realloc_ptr || !objpool_hold.free_ptr) {
+                    return Allocs{nullptr, objpool::alloc, objpool::realloc, objpool::free};
+                }
+                return objpool_hold;
+            }();
             return &alloc;
         }
 
+        fnet_dll_implement(size_t) get_objpool_stats(ObjpoolClassStats* stats, size_t n) {
+            for (size_t i = 0; i < n && i < objpool::num_classes; i++) {
+                auto& d = objpool::depots[i];
+                std::lock_guard l{d.lock};
+                stats[i] = ObjpoolClassStats{
+                    .object_size = objpool::class_size(i),
+                    .magazine_size = objpool::magazine_size(i),
+                    .slabs = d.slabs,
+                    .objects = d.objects,
+                    .depot_objects = d.depot_objects,
+                    .refills = d.refills,
+                    .returns = d.returns,
+                };
+            }
+            return objpool::num_classes;
+        }
+
         inline void* do_alloc(Allocs* a, size_t sz, size_t align, DebugInfo info) {
             return a->alloc_ptr(a->ctx, sz, align, &info);
         }
@@ -139,7 +139,7 @@ namespace futils::fnet::http {
         static void do_tls_handshake(SelfPtr self, std::shared_ptr<Response::AbstractResponse> resp);
 
         Response get_response(uri::URIRange range, futils::view::rvec raw_uri, UserCallback cb) {
-            auto r = std::allocate_shared<Response::AbstractResponse>(glheap_allocator<Response::AbstractResponse>{});
+            auto r = std::allocate_shared<Response::AbstractResponse>(glheap_objpool_allocator<Response::AbstractResponse>{});
             range_to_uri(r->uri, range, raw_uri);
             uri::normalize_uri(r->uri, uri::NormalizeFlag::host | uri::NormalizeFlag::path);
             r->cb = std::move(cb);
@@ -258,7 +258,7 @@ namespace futils::fnet::http {
         init_client(client);
         auto exists = client->clients.find(target);
         if (exists == client->clients.end()) {
-            auto dest = std::allocate_shared<Destination>(glheap_allocator<Destination>{});
+            auto dest = std::allocate_shared<Destination>(glheap_objpool_allocator<Destination>{});
             dest->client = client;
             client->clients[target] = dest;
             return dest->handle_request(dest, range, uri_, uri, std::move(cb));
@@ -732,7 +732,7 @@ namespace futils::fnet::http {
 
     void Destination::init_http2(SelfPtr self, std::shared_ptr<Response::AbstractResponse> resp) {
         if (!self->h2_handler) {
-            self->h2_handler = std::allocate_shared<http2::FrameHandler>(glheap_allocator<http2::FrameHandler>(), http2::HTTP2Role::client);
+            self->h2_handler = std::allocate_shared<http2::FrameHandler>(glheap_objpool_allocator<http2::FrameHandler>(), http2::HTTP2Role::client);
             auto err = self->h2_handler->send_settings({.enable_push = false});
             if (err) {
                 resp->handle_error(std::move(err));
@@ -10,14 +10,21 @@
 #include <fnet/dll/lazy/sockdll.h>
 #include <fnet/dll/allocator.h>
 #include <fnet/plthead.h>
+#include <fnet/sock_internal.h>
 #include <platform/detect.h>
+#include <helper/defer.h>
+#include <cstdlib>
+#include <string_view>
 
 namespace futils::fnet::event {
 #ifdef FUTILS_PLATFORM_WINDOWS
-    fnet_dll_implement(expected<IOEvent>) make_io_event(void (*f)(void*, void*), void* rt) {
+    fnet_dll_implement(expected<IOEvent>) make_io_event(void (*f)(void*, void*), void* rt, IOBackend backend) {
         if (!f) {
             return unexpect(error::Error("need non-null pointer handler", error::Category::lib, error::fnet_usage_error));
         }
+        if (backend != IOBackend::platform_default && backend != IOBackend::iocp) {
+            return unexpect(error::Error("unsupported io backend", error::Category::lib, error::fnet_usage_error));
+        }
         auto h = lazy::CreateIoCompletionPort_(INVALID_HANDLE_VALUE, nullptr, 0, 0);
         if (h == nullptr) {
             return unexpect(error::Errno());
@@ -41,12 +48,26 @@ namespace futils::fnet::event {
         }
         int ev = 0;
         for (auto i = 0; i < rem; i++) {
+            if (!ent[i].lpOverlapped) {
+                continue;  // posted by notify
+            }
             f(&ent[i], this->rt);
             ev++;
         }
         return ev;
     }
 
+    expected<void> IOEvent::notify() {
+        if (!lazy::PostQueuedCompletionStatus_(HANDLE(handle), 0, 0, nullptr)) {
+            return unexpect(error::Errno());
+        }
+        return {};
+    }
+
+    IOBackend IOEvent::backend() const noexcept {
+        return IOBackend::iocp;
+    }
+
     IOEvent::~IOEvent() {
         if (handle != invalid_handle) {
             CloseHandle(HANDLE(handle));
@@ -69,18 +90,52 @@ namespace futils::fnet::event {
     }
 
 #elif defined(FUTILS_PLATFORM_LINUX)
-    fnet_dll_implement(expected<IOEvent>) make_io_event(void (*f)(void*, void*), void* rt) {
+    fnet_dll_implement(expected<IOEvent>) make_io_event(void (*f)(void*, void*), void* rt, IOBackend backend) {
         if (!f) {
             return unexpect(error::Error("need non-null pointer handler", error::Category::lib, error::fnet_usage_error));
         }
+        if (backend == IOBackend::iocp) {
+            return unexpect(error::Error("unsupported io backend", error::Category::lib, error::fnet_usage_error));
+        }
+        if (backend == IOBackend::platform_default) {
+            auto env = std::getenv("FNET_IO_BACKEND");
+            backend = env && std::string_view(env) == "io_uring" ? IOBackend::io_uring : IOBackend::epoll;
+        }
+        if (backend == IOBackend::io_uring) {
+            // if kernel is too old or io_uring is disabled, fallback to epoll
+            if (auto ring = fnet::uring::make_ring()) {
+                return IOEvent(invalid_handle, f, rt, *ring);
+            }
+        }
         auto h = lazy::epoll_create1_(EPOLL_CLOEXEC);
         if (h == -1) {
             return unexpect(error::Errno());
         }
-        return IOEvent(std::uintptr_t(h), f, rt);
+        auto d = helper::defer([&] {
+            lazy::close_(h);
+        });
+        auto w = lazy::eventfd_(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (w == -1) {
+            return unexpect(error::Errno());
+        }
+        // edge triggered, so counter of eventfd is never read
+        // each write makes one waiter ready again
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.u64 = fnet::uring::kind_wakeup;
+        if (lazy::epoll_ctl_(h, EPOLL_CTL_ADD, w, &ev) != 0) {
+            auto err = error::Errno();
+            lazy::close_(w);
+            return unexpect(err);
+        }
+        d.cancel();
+        return IOEvent(std::uintptr_t(h), f, rt, nullptr, std::uintptr_t(w));
     }
 
     expected<void> IOEvent::register_handle(std::uintptr_t handle, void* ptr) {
+        if (uring) {
+            return {};  // io_uring needs no registration
+        }
         epoll_event ev{};
         ev.events = EPOLLIN | EPOLLOUT | EPOLLET | EPOLLEXCLUSIVE;
         ev.data.ptr = ptr;
@@ -91,6 +146,9 @@ namespace futils::fnet::event {
     }
 
     expected<size_t> IOEvent::wait(std::uint32_t timeout) {
+        if (uring) {
+            return fnet::uring::wait(uring, timeout, f, rt);
+        }
         int t = timeout;
         epoll_event ev[64]{};
         sigset_t set;
@@ -100,12 +158,36 @@ namespace futils::fnet::event {
         }
         int proc = 0;
         for (auto i = 0; i < res; i++) {
+            if (ev[i].data.u64 == fnet::uring::kind_wakeup) {
+                continue;  // notified
+            }
             f(&ev[i], rt);
         }
         return proc;
     }
 
+    expected<void> IOEvent::notify() {
+        if (uring) {
+            return fnet::uring::notify(uring);
+        }
+        if (lazy::eventfd_write_(int(wake), 1) != 0) {
+            return unexpect(error::Errno());
+        }
+        return {};
+    }
+
+    IOBackend IOEvent::backend() const noexcept {
+        return uring ? IOBackend::io_uring : IOBackend::epoll;
+    }
+
     IOEvent::~IOEvent() {
+        if (uring) {
+            fnet::uring::destroy_ring(uring);
+            return;
+        }
+        if (wake != invalid_handle) {
+            lazy::close_(wake);
+        }
         lazy::close_(handle);
     }
 
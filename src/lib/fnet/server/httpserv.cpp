@@ -20,6 +20,17 @@ namespace futils {
                 return req.response_sent;
             }
 
+            // prepare for next request on keep-alive connection
+            void reset_request(Requester& req) {
+                req.user_data.reset();
+                req.arena_.reset();
+                req.response_sent = false;
+            }
+
+            FileBody take_file_body(Requester& req) {
+                return std::exchange(req.file_body, FileBody{});
+            }
+
             void http_handler_impl(HTTPServ* serv, std::shared_ptr<Transport>&& req, StateContext as);
 
             struct read_buffer_getter {
@@ -100,6 +111,75 @@ namespace futils {
                 cb(serv, std::move(req), std::move(as));
             }
 
+            // limit of bytes transferred by one sendfile call on linux
+            constexpr size_t max_write_file_size = 0x7ffff000;
+
+            // write write_buf and then file body
+            // on plaintext, file body is sent by write_file until it would block
+            // otherwise (and on would block to wait for writable), next chunk is read into write_buf
+            void do_write_file(HTTPServ* serv, std::shared_ptr<Transport>&& req, StateContext& as, auto&& cb) {
+                auto& body = req->file_body;
+                auto on_error = [&](auto&& err) {
+                    as.log(log_level::err, &req->client.addr, err);
+                    body = {};
+                    req->client.sock.shutdown();
+                };
+                while (true) {
+                    view::rvec remain = req->write_buf;
+                    while (remain.size()) {
+                        auto res = req->client.sock.write(remain);
+                        if (!res) {
+                            if (isSysBlock(res.error())) {
+                                call_write_async(serv, std::move(req), remain, as, [cb](HTTPServ* s, std::shared_ptr<Transport>&& t, StateContext&& c) {
+                                    t->write_buf.clear();
+                                    do_write_file(s, std::move(t), c, cb);
+                                });
+                                return;
+                            }
+                            on_error(res.error());
+                            return;
+                        }
+                        remain = *res;
+                    }
+                    req->write_buf.clear();
+                    req->may_enable_ktls_send(as);
+                    if (req->write_buf.size()) {
+                        continue;  // records left in TLS library must be sent before kTLS is enabled
+                    }
+                    if (!body) {
+                        break;
+                    }
+                    if ((!req->tls || req->ktls_send) && !body.no_write_file) {
+                        auto res = req->client.sock.write_file(body.handle, body.offset, size_t((std::min)(body.remain, std::uint64_t(max_write_file_size))));
+                        if (res && *res) {
+                            body.advance(*res);
+                            continue;
+                        }
+                        if (res) {
+                            on_error(error::Error("file is shorter than expected", error::Category::app));
+                            return;
+                        }
+                        if (!isSysBlock(res.error())) {
+                            as.log(log_level::debug, req->client.addr, "write_file failed. fallback to read: ", res.error());
+                            body.no_write_file = true;
+                        }
+                    }
+                    byte buf[file_body_chunk_size];
+                    auto chunk = body.read_chunk(buf);
+                    if (!chunk) {
+                        on_error(chunk.error());
+                        return;
+                    }
+                    if (chunk->empty()) {
+                        on_error(error::Error("file is shorter than expected", error::Category::app));
+                        return;
+                    }
+                    req->flush(as, *chunk);
+                }
+                body = {};
+                cb(serv, std::move(req), std::move(as));
+            }
+
             void handle_http2_streams(std::shared_ptr<Transport>&& req, StateContext as, std::shared_ptr<http2::FrameHandler>&& h) {
                 slib::set<std::shared_ptr<http2::stream::Stream>> streams;
                 auto err = h->add_data_and_read_frames(req->read_buf, [&](auto&& s) {
@@ -114,7 +194,7 @@ namespace futils {
                 for (auto& s : streams) {
                     auto r = s->get_or_set_application_data<Requester>([&](std::shared_ptr<Requester>&& r, auto&& set) {
                         if (!r) {
-                            r = std::allocate_shared<Requester>(glheap_allocator<Requester>());
+                            r = std::allocate_shared<Requester>(glheap_objpool_allocator<Requester>());
                             set(r);
                             r->addr = req->client.addr;
                             r->http = http::HTTP(http2::HTTP2(s));
@@ -132,14 +212,14 @@ namespace futils {
                 if (!req->version_specific) {
                     auto init_http1 = [&]() {
                         req->version = http::HTTPVersion::http1;
-                        auto requester = std::allocate_shared<Requester>(glheap_allocator<Requester>());
+                        auto requester = std::allocate_shared<Requester>(glheap_objpool_allocator<Requester>());
                         requester->addr = req->client.addr;
                         requester->http = http::HTTP(http1::HTTP1());
                         req->version_specific = requester;
                     };
                     auto init_http2 = [&]() {
                         req->version = http::HTTPVersion::http2;
-                        auto h2 = std::allocate_shared<http2::FrameHandler>(glheap_allocator<http2::FrameHandler>(), http2::HTTP2Role::server);
+                        auto h2 = std::allocate_shared<http2::FrameHandler>(glheap_objpool_allocator<http2::FrameHandler>(), http2::HTTP2Role::server);
                         req->version_specific = h2;
                         auto err = h2->send_settings({.enable_push = false});
                         if (err) {
@@ -158,6 +238,7 @@ namespace futils {
                         if (auto version = req->tls.get_tls_version()) {
                             as.log(log_level::debug, req->client.addr, "tls version ", *version);
                         }
+                        req->ktls_pending = serv->ktls;
                         auto alpn = req->tls.get_selected_alpn();
                         if (!alpn || alpn == "http/1.1") {
                             init_http1();
@@ -208,6 +289,7 @@ namespace futils {
                         serv->next(serv->c, std::move(h1), as);
                         auto h1c = h1->http.http1();
                         req->flush(as, h1c->get_output());
+                        req->file_body = take_file_body(*h1);
                         h1c->adjust_input();
                         h1c->clear_output();
                     }
@@ -218,7 +300,7 @@ namespace futils {
                                 auto h = h1->http.http1();
                                 if (h->read_ctx.on_no_body_semantics() && response_sent(*h1) && h->read_ctx.is_keep_alive()) {
                                     c.log(log_level::debug, "connection keep-alive via http1", t->client.addr);
-                                    response_sent(*h1) = false;
+                                    reset_request(*h1);
                                     h->read_ctx.reset();
                                     h->write_ctx.reset();
                                     do_read(s, std::move(t), std::move(c));
@@ -241,7 +323,11 @@ namespace futils {
                                 }
                             }
                         };
-                        if (req->write_buf.size()) {
+                        if (req->file_body) {
+                            as.log(log_level::debug, "write data and file", req->client.addr);
+                            do_write_file(serv, std::move(req), as, after);
+                        }
+                        else if (req->write_buf.size()) {
                             as.log(log_level::debug, "write data", req->client.addr);
                             do_write(serv, std::move(req), req->write_buf, as, after);
                         }
@@ -254,6 +340,7 @@ namespace futils {
 
             void do_read(HTTPServ* serv, std::shared_ptr<Transport> req, StateContext s) {
                 s.log(log_level::debug, "start reading", req->client.addr);
+                req->may_enable_ktls_send(s);
 
                 // bool done = false;
                 socket_read_common(
@@ -295,7 +382,7 @@ namespace futils {
             fnetserv_dll_internal(void) http_handler(void* v, Client&& cl, StateContext s) {
                 s.log(log_level::perf, start_timing, cl.addr);
                 auto serv = static_cast<HTTPServ*>(v);
-                auto req = std::allocate_shared<Transport>(glheap_allocator<Transport>());
+                auto req = std::allocate_shared<Transport>(glheap_objpool_allocator<Transport>());
                 req->internal_ = serv;
                 req->client = std::move(cl);
                 auto addr = req->client.sock.get_local_addr();
@@ -10,7 +10,13 @@
 #include <fnet/http3/http3.h>
 #include <fnet/http3/mux.h>
 #include <fnet/server/httpserv.h>
+#include <fnet/gso.h>
+#include <platform/detect.h>
 #include <thread>
+#include <cerrno>
+#ifdef FUTILS_PLATFORM_LINUX
+#include <fnet/plthead.h>
+#endif
 
 namespace futils::fnet::server {
 
@@ -18,6 +24,92 @@ namespace futils::fnet::server {
         return static_cast<QUICServerState*>(app_ctx.get());
     }
 
+    // buffer size that any udp datagram can be placed
+    constexpr size_t quic_max_datagram = 65536;
+
+    // control buffer size for each datagram. this has room for cmsg other than UDP_GRO
+    constexpr size_t quic_control_size = 64;
+
+#ifdef FUTILS_PLATFORM_LINUX
+    // async read only peeks to wait for readiness and every datagram is read by readfrom_many
+    // because datagram received by async read has no control message (UDP_GRO)
+    // (recvfrom of epoll backend and RECVMSG of io_uring backend)
+    constexpr std::uint32_t quic_async_read_flag = MSG_PEEK;
+    constexpr size_t quic_async_read_size = 1;
+#else
+    // GRO is not available so first datagram is received by async read directly
+    constexpr std::uint32_t quic_async_read_flag = 0;
+    constexpr size_t quic_async_read_size = quic_max_datagram;
+#endif
+
+    struct QUICRecvBatch {
+        static constexpr size_t count = 16;
+        byte buffer[count][quic_max_datagram];
+        byte control[count][quic_control_size];
+        Datagram<view::wvec> msgs[count];
+    };
+
+    static bool same_peer(const NetAddrPort& a, const NetAddrPort& b) {
+        return a.port().u16() == b.port().u16() && a.addr.type() == b.addr.type() &&
+               view::rvec(a.addr.data(), a.addr.size()) == view::rvec(b.addr.data(), b.addr.size());
+    }
+
+    // send buffer of socket or device queue is full for now. datagram can be sent again later
+    static bool is_send_busy(const error::Error& err) {
+        if (isSysBlock(err)) {
+            return true;
+        }
+#ifdef FUTILS_PLATFORM_WINDOWS
+        return false;
+#else
+        return err.category() == error::Category::os && err.type() == error::ErrorType::number && err.code() == ENOBUFS;
+#endif
+    }
+
+    // kernel or NIC rejects UDP_SEGMENT itself. other errors are specific to the datagram (e.g. unreachable peer)
+    static bool is_gso_rejected(const error::Error& err) {
+#ifdef FUTILS_PLATFORM_LINUX
+        if (err.category() != error::Category::os || err.type() != error::ErrorType::number) {
+            return false;
+        }
+        return err.code() == EIO || err.code() == EINVAL || err.code() == EOPNOTSUPP;
+#else
+        return false;
+#endif
+    }
+
+    // coalesce_packets merges consecutive packets to same peer into one GSO datagram
+    // packets must be contiguous in memory
+    // all segments in a datagram have same size except last one
+    // returns number of datagrams written to out
+    static size_t coalesce_packets(view::rspan<Datagram<view::rvec>> packets, Datagram<view::rvec>* out, byte (*control)[quic_control_size]) {
+        size_t n = 0;
+        for (size_t i = 0; i < packets.size();) {
+            auto& first = packets[i];
+            auto segment = first.data.size();
+            auto total = segment;
+            size_t j = i + 1;
+            while (j < packets.size() && j - i < gso::max_segments) {
+                auto& p = packets[j];
+                if (p.data.size() > segment || total + p.data.size() > gso::max_total_size ||
+                    p.data.data() != first.data.data() + total || !same_peer(p.addr, first.addr)) {
+                    break;
+                }
+                total += p.data.size();
+                j++;
+                if (p.data.size() < segment) {
+                    break;  // shorter segment must be last
+                }
+            }
+            out[n].data = view::rvec(first.data.data(), total);
+            out[n].addr = first.addr;
+            out[n].control = j - i > 1 ? gso::encode_segment_size(control[n], std::uint16_t(segment)) : view::rvec{};
+            n++;
+            i = j;
+        }
+        return n;
+    }
+
     void State::add_quic_thread(Socket&& listener, std::shared_ptr<quic_handler> handler,
                                 fnet::quic::context::Config&& conf,
                                 quic_server_config serv_conf) {
@@ -40,61 +132,143 @@ namespace futils::fnet::server {
         };
         handler->set_server_config(std::move(conf), std::move(serv_conf));
         auto sock = std::move(listener);
+        sock.set_gro(true);  // optional. quic_recv_handler works without it
         auto state = shared_from_this();
         std::thread(quic_send_thread, state, sock.clone(), handler).detach();
         std::thread(quic_send_scheduler, state, handler).detach();
         std::thread(quic_recv_scheduler, state, handler).detach();
 
         // this is async so it will not block
-        quic_recv_handler(state, std::move(sock), handler);
+        quic_recv_handler(state, std::move(sock), handler, std::allocate_shared<QUICRecvBatch>(glheap_allocator<QUICRecvBatch>()));
 
         check_and_start();  // start GetQueuedCompletionStatus/epoll_wait thread
     }
 
     void State::quic_send_thread(std::shared_ptr<State> state, fnet::Socket sock, std::shared_ptr<quic_handler> handler) {
-        byte buf[65536];
+        // packets are packed into buf while max size datagram can be placed
+        // and sent by one writeto_many (sendmmsg) call
+        // each packet must have whole quic_max_datagram space,
+        // otherwise context creates packet on its internal buffer that is overwritten by next packet
+        constexpr size_t max_batch = 32;
+        constexpr size_t buf_size = quic_max_datagram * 2;
+        auto buf = std::make_unique<byte[]>(buf_size);
+        Datagram<view::rvec> packets[max_batch];
+        // consecutive packets to same peer are coalesced into one datagram with UDP_SEGMENT cmsg
+        // if kernel rejects it, GSO is disabled and packets are sent separately
+        // datagram failed with busy socket is retried up to max_busy_retry times before dropped
+        constexpr size_t max_busy_retry = 8;
+        bool use_gso = gso::cmsg_compatible;
+        Datagram<view::rvec> datagrams[max_batch];
+        byte control[max_batch][quic_control_size];
         while (!state->state().end_flag.test()) {
-            auto [packet, addr, exist] = handler->create_packet(view::wvec(buf), true);
-            if (!exist) {
+            size_t count = 0, offset = 0;
+            while (count < max_batch && buf_size - offset >= quic_max_datagram) {
+                // block only for first packet
+                auto [packet, addr, exist] = handler->create_packet(view::wvec(buf.get() + offset, quic_max_datagram), count == 0);
+                if (!exist) {
+                    break;
+                }
+                packets[count++] = {packet, std::move(addr)};
+                offset += packet.size();
+            }
+            if (count == 0) {
                 std::this_thread::yield();
                 continue;
             }
-            auto res = sock.writeto(addr, packet);
-            if (!res) {
-                state->log(log_level::err, &addr, res.error());
+            auto msgs = packets;
+            if (use_gso) {
+                count = coalesce_packets(view::rspan<Datagram<view::rvec>>(packets, count), datagrams, control);
+                msgs = datagrams;
+            }
+            size_t sent = 0, busy_retry = 0;
+            while (sent < count) {
+                auto res = sock.writeto_many(view::rspan<Datagram<view::rvec>>(msgs + sent, count - sent));
+                if (res) {
+                    sent += *res;
+                    busy_retry = 0;
+                    continue;
+                }
+                if (is_send_busy(res.error()) && busy_retry < max_busy_retry) {
+                    busy_retry++;
+                    sock.wait_writable(0, 1000);  // ENOBUFS is not notified as writable so this also works as short sleep
+                    continue;                      // retry same datagram
+                }
+                busy_retry = 0;
+                auto& failed = msgs[sent++];
+                if (failed.control.empty() || !is_gso_rejected(res.error())) {
+                    // drop failed datagram. peer recovers it as lost packet
+                    state->log(is_send_busy(res.error()) ? log_level::warn : log_level::err, &failed.addr, res.error());
+                    continue;
+                }
+                use_gso = false;
+                error::Error err = error::ErrList{
+                    .err = res.error(),
+                    .before = error::Error("failed to send with GSO. GSO is disabled", error::Category::app),
+                };
+                state->log(log_level::warn, &failed.addr, err);
+                auto segment = gso::find_segment_size(failed.control);
+                gso::split_segments(failed.data, segment.value_or(0), [&](view::rvec data) {
+                    if (auto res = sock.writeto(failed.addr, data); !res) {
+                        state->log(log_level::err, &failed.addr, res.error());
+                    }
+                });
             }
         }
     }
 
-    void State::quic_recv_handler(std::shared_ptr<State> state, fnet::Socket sock, std::shared_ptr<quic_handler> handler) {
+    void State::quic_recv_handler(std::shared_ptr<State> state, fnet::Socket sock, std::shared_ptr<quic_handler> handler, std::shared_ptr<QUICRecvBatch> batch) {
         while (true) {
             auto res = sock.readfrom_async_deferred(fnet::async_notify_addr_then(
-                BufferManager<byte[65536]>{},
+                BufferManager<byte[quic_async_read_size]>{},
                 [state](fnet::DeferredCallback&& cb) { state->enqueue_callback(std::move(cb)); },
-                [=](fnet::Socket&& sock, fnet::BufferManager<byte[65536]>& mgr, fnet::NetAddrPort&& addr, fnet::NotifyResult&& r) {
+                [=](fnet::Socket&& sock, fnet::BufferManager<byte[quic_async_read_size]>& mgr, fnet::NetAddrPort&& addr, fnet::NotifyResult&& r) {
                     state->count.waiting_async_read--;
-                    auto expected = r.readfrom_unwrap(mgr.get_buffer(), addr, [&](view::wvec buf) {
-                        return sock.readfrom(buf);
-                    });
-                    if (!expected) {
+                    if (auto& res = r.value(); !res) {
                         error::Error err = error::ErrList{
-                            .err = expected.error(),
+                            .err = res.error(),
                             .before = error::Error("failed to read from udp socket", error::Category::app),
                         };
                         state->log(log_level::err, &addr, err);
                         return;
                     }
                     auto msg = error::Error("received udp packet", error::Category::app);
-                    state->log(log_level::debug, &expected->second, msg);
-                    handler->parse_udp_payload(expected->first, expected->second);
+                    auto parse = [&](view::wvec data, NetAddrPort& addr, std::optional<std::uint16_t> segment) {
+                        gso::split_segments(data, segment.value_or(0), [&](view::wvec packet) {
+                            state->log(log_level::debug, &addr, msg);
+                            handler->parse_udp_payload(packet, addr);
+                        });
+                    };
+                    if (quic_async_read_flag == 0 && *r.value()) {
+                        parse(view::wvec(mgr.get_buffer()).substr(0, **r.value()), addr, std::nullopt);
+                    }
 
-                    sock.readfrom_until_block(mgr.get_buffer(), [&](view::wvec data, fnet::NetAddrPort addr) {
-                        state->log(log_level::debug, &addr, msg);
-                        handler->parse_udp_payload(data, addr);
-                    });
+                    // drain socket by readfrom_many (recvmmsg)
+                    // with GRO, a datagram may contain segments of multiple packets
+                    // batch is not shared because next read is not started until this callback returns
+                    while (true) {
+                        for (size_t i = 0; i < batch->count; i++) {
+                            batch->msgs[i].data = view::wvec(batch->buffer[i], quic_max_datagram);
+                            batch->msgs[i].control = view::wvec(batch->control[i], quic_control_size);
+                        }
+                        auto recv = sock.readfrom_many(batch->msgs);
+                        if (!recv) {
+                            if (!isSysBlock(recv.error())) {
+                                state->log(log_level::err, nullptr, recv.error());
+                            }
+                            break;
+                        }
+                        for (size_t i = 0; i < *recv; i++) {
+                            auto& m = batch->msgs[i];
+                            parse(m.data, m.addr, gso::find_gro_size(m.control));
+                        }
+                        if (*recv < batch->count) {
+                            break;
+                        }
+                    }
 
-                    quic_recv_handler(state, std::move(sock), handler);
-                }));
+                    quic_recv_handler(state, std::move(sock), handler, std::move(batch));
+                }),
+                false, quic_async_read_flag);
             if (!res) {
                 state->count.total_failed_read_async++;
                 error::Error err = error::ErrList{
@@ -9,12 +9,51 @@
 #include <fnet/server/servcpp.h>
 #include <fnet/socket.h>
 #include <thread>
+#include <deque>
 #include <fnet/server/state.h>
+#include <fnet/dll/allocator.h>
+#include <platform/detect.h>
+#ifdef FUTILS_PLATFORM_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace futils {
     namespace fnet {
         namespace server {
 
+            // dequeue callbacks by batch so that one synchronization runs many of them
+            static void run_queued(Counter& count, thread::RecvChan<Queued>& deq) {
+                constexpr size_t batch = 16;
+                Queued q[batch];
+                size_t n = 0;
+                if (!deq.recv_batch(q, batch, n)) {
+                    return;
+                }
+                count.current_enqueued -= n;
+                Enter active(count.current_handling_handler_thread);
+                for (size_t i = 0; i < n; i++) {
+                    q[i].runner.invoke();
+                }
+            }
+
+            // true while handler thread is in wait_io_event
+            // callbacks enqueued from completion handler are run by same thread right after wait
+            // so wake up of other thread is not needed
+            thread_local bool handler_waiting = false;
+
+            void State::wake_handler() {
+                if (handler_waiting) {
+                    return;
+                }
+                // counters of queue are incremented before this load
+                // and handler thread checks them after incrementing sleeping count
+                // so either of them sees another
+                if (count.sleeping_handler_thread != 0) {
+                    notify_io_event();
+                }
+            }
+
             void State::handler_thread(std::shared_ptr<State> state) {
                 auto recv = state->recv;
                 recv.set_blocking(false);
@@ -23,16 +62,27 @@ namespace futils {
                 auto decr_count = helper::defer([&] {
                     state->count.current_handler_thread--;
                 });
+                auto wait = [&](std::uint32_t timeout) {
+                    handler_waiting = true;
+                    wait_io_event(timeout);
+                    handler_waiting = false;
+                };
                 std::uint32_t skip = 0;
+                bool idle = false;
                 while (!state->count.end_flag.test()) {
                     Client cl;
-                    wait_io_event(1);
-                    Queued q;
-                    if (deq >> q) {
-                        state->count.current_enqueued--;
-                        Enter active(state->count.current_handling_handler_thread);
-                        q.runner.invoke();
+                    if (idle) {
+                        // block until io completion, enqueue_callback or accept_thread wakes this thread
+                        Enter sleeping(state->count.sleeping_handler_thread);
+                        if (state->count.current_enqueued == 0 && state->count.current_waiting_client == 0) {
+                            auto timeout = state->count.thread_sleep.load();
+                            wait(timeout ? timeout : default_thread_sleep);
+                        }
                     }
+                    else {
+                        wait(0);
+                    }
+                    run_queued(state->count, deq);
                     auto res = recv >> cl;
                     if (!res) {
                         if (state->count.should_reduce()) {
@@ -47,14 +97,11 @@ namespace futils {
                                 skip++;
                             }
                         }
-                        if (state->count.thread_sleep == 0) {
-                            std::this_thread::yield();
-                        }
-                        else {
-                            std::this_thread::sleep_for(std::chrono::milliseconds(state->count.thread_sleep));
-                        }
+                        idle = true;
                         continue;
                     }
+                    state->count.current_waiting_client--;
+                    idle = false;
                     skip = 0;
                     Enter active(state->count.current_handling_handler_thread);
                     if (state->handler) {
@@ -68,10 +115,13 @@ namespace futils {
                 auto handle = [&](Socket&& sock, NetAddrPort&& addr) {
                     state->count.total_accepted++;
                     state->check_and_start();
+                    state->count.current_waiting_client++;
                     state->send << Client{std::move(sock), std::move(addr)};
+                    state->wake_handler();
                 };
                 while (!state->count.end_flag.test()) {
-                    auto new_socks = listener.accept_select(0, 1000);
+                    // timeout is for checking end_flag
+                    auto new_socks = listener.accept_select(0, default_thread_sleep * 1000);
                     if (new_socks) {
                         handle(std::move(new_socks->first), std::move(new_socks->second));
                     }
@@ -79,7 +129,6 @@ namespace futils {
                         state->count.total_failed_accept++;
                         state->log(log_level::warn, nullptr, new_socks.error());
                     }
-                    std::this_thread::yield();
                 }
             }
 
@@ -98,12 +147,7 @@ namespace futils {
                 };
                 while (true) {
                     wait_io_event(1);
-                    Queued q;
-                    if (deq >> q) {
-                        count.current_enqueued--;
-                        Enter active(count.current_handling_handler_thread);
-                        q.runner.invoke();
-                    }
+                    run_queued(count, deq);
                     auto new_socks = listener(listener_p);
                     if (new_socks) {
                         handle(std::move(new_socks->first), std::move(new_socks->second));
@@ -120,6 +164,185 @@ namespace futils {
                 }
             }
 
+            struct Shard {
+                event::IOEvent event;
+                Socket listener;
+                Canceler accept_cancel;
+                std::atomic_bool accepting = false;
+                // true while arm_shard_accept is looping
+                // accept callback completed synchronously must not re-arm by itself
+                bool arming = false;
+                std::uint32_t cpu = 0;
+                bool pin_cpu = false;
+                // callbacks enqueued on this shard thread
+                // swapped with running queue so that callbacks can enqueue next ones
+                std::deque<DeferredCallback, glheap_allocator<DeferredCallback>> local;
+                std::deque<DeferredCallback, glheap_allocator<DeferredCallback>> running;
+
+                explicit Shard(event::IOEvent&& e)
+                    : event(std::move(e)) {}
+            };
+
+            thread_local Shard* current_shard = nullptr;
+
+            bool State::enqueue_local(DeferredCallback& w) {
+                if (!current_shard) {
+                    return false;
+                }
+                current_shard->local.push_back(std::move(w));
+                return true;
+            }
+
+            void State::handle_accepted(Client&& cl) {
+                count.total_accepted++;
+                Enter active(count.current_handling_handler_thread);
+                if (handler) {
+                    handler(ctx, std::move(cl), StateContext{shared_from_this()});
+                }
+            }
+
+            void State::arm_shard_accept(Shard* shard) {
+                // loop instead of recursion so that stack does not grow
+                // while accept_async completes synchronously (e.g. io_uring multishot accept queue is not empty)
+                shard->arming = true;
+                const auto d = helper::defer([&] { shard->arming = false; });
+                while (!count.end_flag.test()) {
+                    shard->accepting = true;
+                    auto res = shard->listener.accept_async(async_accept_then([th = shared_from_this(), shard](Socket&& listener, Socket&& accepted, NetAddrPort&& addr, NotifyResult&& r) {
+                        shard->accepting = false;
+                        if (th->count.end_flag.test()) {
+                            return;  // canceled by shard_thread
+                        }
+                        if (accepted) {
+                            th->handle_accepted(Client{std::move(accepted), std::move(addr)});
+                        }
+                        else if (auto& res = r.value(); !res && !isSysBlock(res.error())) {
+                            th->count.total_failed_accept++;
+                            th->log(log_level::warn, nullptr, res.error());
+                        }
+                        // drain accept queue before waiting next event
+                        while (!th->count.end_flag.test()) {
+                            auto next = listener.accept();
+                            if (!next) {
+                                if (!isSysBlock(next.error())) {
+                                    th->count.total_failed_accept++;
+                                    th->log(log_level::warn, nullptr, next.error());
+                                }
+                                break;
+                            }
+                            th->handle_accepted(Client{std::move(next->first), std::move(next->second)});
+                        }
+                        if (!shard->arming && !th->count.end_flag.test()) {
+                            th->arm_shard_accept(shard);
+                        }
+                    }));
+                    if (!res) {
+                        shard->accepting = false;
+                        count.total_failed_accept++;
+                        log(log_level::warn, nullptr, res.error());
+                        return;
+                    }
+                    if (res->state == NotifyState::wait) {
+                        shard->accept_cancel = std::move(res->cancel);
+                        return;
+                    }
+                    // done means callback already ran synchronously, so accept next one
+                }
+            }
+
+            void State::shard_thread(std::shared_ptr<Shard> shard, std::shared_ptr<State> state) {
+                Enter start{state->count.current_shard_thread};
+#ifdef FUTILS_PLATFORM_LINUX
+                if (shard->pin_cpu) {
+                    cpu_set_t set;
+                    CPU_ZERO(&set);
+                    CPU_SET(shard->cpu, &set);
+                    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);  // best effort
+                }
+#endif
+                current_shard = shard.get();
+                const auto d = helper::defer([&] { current_shard = nullptr; });
+                state->arm_shard_accept(shard.get());
+                auto run_local = [&] {
+                    std::swap(shard->local, shard->running);
+                    if (shard->running.empty()) {
+                        return;
+                    }
+                    Enter active(state->count.current_handling_handler_thread);
+                    for (auto& cb : shard->running) {
+                        cb.invoke();
+                    }
+                    shard->running.clear();
+                };
+                while (!state->count.end_flag.test()) {
+                    // wait only if nothing to run, timeout is for checking end_flag
+                    shard->event.wait(shard->local.empty() ? 100 : 0);
+                    run_local();
+                }
+                // release reference to state held by accept callback
+                shard->accept_cancel.cancel();
+                for (auto i = 0; i < 100 && shard->accepting; i++) {
+                    shard->event.wait(10);
+                }
+                run_local();
+                shard->listener = Socket();
+            }
+
+            expected<NetAddrPort> State::add_sharded_listener(const SockAddr& addr, ShardConfig conf) {
+#ifdef FUTILS_PLATFORM_LINUX
+                auto n = conf.shards ? conf.shards : std::thread::hardware_concurrency();
+                if (n == 0) {
+                    n = 1;
+                }
+                std::vector<std::shared_ptr<Shard>> added;
+                auto bind_addr = addr.addr;
+                for (std::uint32_t i = 0; i < n; i++) {
+                    auto event = event::make_io_event(event::fnet_handle_completion, nullptr, conf.backend);
+                    if (!event) {
+                        return unexpect(event.error());
+                    }
+                    auto shard = std::allocate_shared<Shard>(glheap_allocator<Shard>{}, std::move(*event));
+                    shard->cpu = i;
+                    shard->pin_cpu = conf.pin_cpu;
+                    auto sock = make_socket(addr.attr, &shard->event)
+                                    .and_then([&](Socket&& s) -> expected<Socket> {
+                                        s.set_ipv6only(conf.ipv6only);  // ignore errors; best effort
+                                        s.set_reuse_addr(true);         // ignore errors; best effort
+                                        if (conf.incoming_cpu) {
+                                            s.set_incoming_cpu(int(i));  // ignore errors; hint only
+                                        }
+                                        return s.set_reuse_port(true).transform([&] { return std::move(s); });
+                                    })
+                                    .and_then([&](Socket&& s) {
+                                        return s.bind(bind_addr).transform([&] { return std::move(s); });
+                                    })
+                                    .and_then([&](Socket&& s) {
+                                        return s.listen(conf.backlog).transform([&] { return std::move(s); });
+                                    });
+                    if (!sock) {
+                        return unexpect(sock.error());
+                    }
+                    if (i == 0) {
+                        auto local = sock->get_local_addr();
+                        if (!local) {
+                            return unexpect(local.error());
+                        }
+                        bind_addr = std::move(*local);  // share chosen port
+                    }
+                    shard->listener = std::move(*sock);
+                    added.push_back(std::move(shard));
+                }
+                // launch after all listeners are ready so that failure leaves nothing running
+                for (auto& shard : added) {
+                    std::thread(shard_thread, shard, shared_from_this()).detach();
+                    shards.push_back(std::move(shard));
+                }
+                return bind_addr;
+#else
+                return unexpect(error::Error("sharded listener is not supported on this platform", error::Category::lib, error::fnet_usage_error));
+#endif
+            }
+
             void State::check_and_start() {
                 if (count.should_start()) {
                     auto c = ++count.current_handler_thread;
@@ -140,6 +140,13 @@ namespace futils {
 
         expected<view::wvec> Socket::read(view::wvec data, int flag, bool is_stream) {
             return get_raw().and_then([&](std::uintptr_t sock) -> expected<view::wvec> {
+#ifdef FUTILS_PLATFORM_LINUX
+                if (flag == 0) {
+                    if (auto queued = uring::read_queued(static_cast<SockTable*>(ctx), data, is_stream)) {
+                        return std::move(*queued);
+                    }
+                }
+#endif
                 auto sub = data.substr(0, (std::numeric_limits<socklen_t>::max)());
                 auto res = lazy::recv_(sock, sub.as_char(), sub.size(), flag);
                 if (res < 0) {
@@ -282,6 +289,147 @@ namespace futils {
             });
         }
 
+        constexpr auto errWriteFileNotSupport = error::Error("write_file is not supported on this platform", error::Category::lib, error::fnet_usage_error);
+
+        expected<size_t> Socket::write_file(std::uintptr_t file, std::uint64_t offset, size_t len) {
+#ifdef FUTILS_PLATFORM_LINUX
+            return get_raw().and_then([&](std::uintptr_t sock) -> expected<size_t> {
+                off_t off = offset;
+                auto res = lazy::sendfile_(sock, int(file), &off, len);
+                if (res < 0) {
+                    return unexpect(error::Errno());
+                }
+                return size_t(res);
+            });
+#else
+            return unexpect(errWriteFileNotSupport);
+#endif
+        }
+
+        // number of datagrams passed to sendmmsg/recvmmsg at once
+        constexpr size_t mmsg_batch = 64;
+
+        expected<size_t> Socket::writeto_many(view::rspan<Datagram<view::rvec>> msgs, int flag) {
+#ifdef FUTILS_PLATFORM_LINUX
+            return get_raw().and_then([&](std::uintptr_t sock) -> expected<size_t> {
+                sockaddr_storage st[mmsg_batch];
+                iovec iov[mmsg_batch];
+                mmsghdr hdr[mmsg_batch];
+                size_t sent = 0;
+                while (sent < msgs.size()) {
+                    auto n = (std::min)(msgs.size() - sent, mmsg_batch);
+                    for (size_t i = 0; i < n; i++) {
+                        auto& m = msgs[sent + i];
+                        auto [addrptr, addrlen] = NetAddrPort_to_sockaddr(&st[i], m.addr);
+                        if (!addrptr) {
+                            if (sent == 0 && i == 0) {
+                                return unexpect(errAddrNotSupport);
+                            }
+                            n = i;  // send before unsupported address
+                            break;
+                        }
+                        iov[i].iov_base = (void*)m.data.as_char();
+                        iov[i].iov_len = m.data.size();
+                        hdr[i] = {};
+                        hdr[i].msg_hdr.msg_name = (void*)addrptr;
+                        hdr[i].msg_hdr.msg_namelen = addrlen;
+                        hdr[i].msg_hdr.msg_iov = &iov[i];
+                        hdr[i].msg_hdr.msg_iovlen = 1;
+                        hdr[i].msg_hdr.msg_control = (void*)m.control.as_char();
+                        hdr[i].msg_hdr.msg_controllen = m.control.size();
+                    }
+                    auto res = lazy::sendmmsg_(sock, hdr, n, flag);
+                    if (res < 0) {
+                        if (sent == 0) {
+                            return unexpect(error::Errno());
+                        }
+                        break;
+                    }
+                    sent += res;
+                    if (size_t(res) < n || n < mmsg_batch) {
+                        break;
+                    }
+                }
+                return sent;
+            });
+#else
+            size_t sent = 0;
+            for (auto& m : msgs) {
+                auto res = writeto(m.addr, m.data, flag);
+                if (!res) {
+                    if (sent == 0) {
+                        return unexpect(res.error());
+                    }
+                    break;
+                }
+                sent++;
+            }
+            return sent;
+#endif
+        }
+
+        expected<size_t> Socket::readfrom_many(view::wspan<Datagram<view::wvec>> msgs, int flag) {
+#ifdef FUTILS_PLATFORM_LINUX
+            return get_raw().and_then([&](std::uintptr_t sock) -> expected<size_t> {
+                sockaddr_storage st[mmsg_batch];
+                iovec iov[mmsg_batch];
+                mmsghdr hdr[mmsg_batch];
+                size_t recv = 0;
+                while (recv < msgs.size()) {
+                    auto n = (std::min)(msgs.size() - recv, mmsg_batch);
+                    for (size_t i = 0; i < n; i++) {
+                        auto& m = msgs[recv + i];
+                        iov[i].iov_base = m.data.as_char();
+                        iov[i].iov_len = m.data.size();
+                        hdr[i] = {};
+                        hdr[i].msg_hdr.msg_name = &st[i];
+                        hdr[i].msg_hdr.msg_namelen = sizeof(st[i]);
+                        hdr[i].msg_hdr.msg_iov = &iov[i];
+                        hdr[i].msg_hdr.msg_iovlen = 1;
+                        hdr[i].msg_hdr.msg_control = m.control.as_char();
+                        hdr[i].msg_hdr.msg_controllen = m.control.size();
+                    }
+                    // blocking socket waits only for the first datagram
+                    // following batches must not block because some datagrams are already received
+                    auto res = lazy::recvmmsg_(sock, hdr, n, flag | (recv == 0 ? MSG_WAITFORONE : MSG_DONTWAIT), nullptr);
+                    if (res < 0) {
+                        if (recv == 0) {
+                            return unexpect(error::Errno());
+                        }
+                        break;
+                    }
+                    for (size_t i = 0; i < size_t(res); i++) {
+                        auto& m = msgs[recv + i];
+                        m.data = m.data.substr(0, hdr[i].msg_len);
+                        m.control = m.control.substr(0, hdr[i].msg_hdr.msg_controllen);
+                        m.addr = sockaddr_to_NetAddrPort((sockaddr*)&st[i], hdr[i].msg_hdr.msg_namelen);
+                    }
+                    recv += res;
+                    if (size_t(res) < n) {
+                        break;
+                    }
+                }
+                return recv;
+            });
+#else
+            size_t recv = 0;
+            for (auto& m : msgs) {
+                auto res = readfrom(m.data, flag);
+                if (!res) {
+                    if (recv == 0) {
+                        return unexpect(res.error());
+                    }
+                    break;
+                }
+                m.data = res->first;
+                m.addr = std::move(res->second);
+                m.control = {};
+                recv++;
+            }
+            return recv;
+#endif
+        }
+
 #ifdef FUTILS_PLATFORM_WINDOWS
         constexpr auto shutdown_recv = SD_RECEIVE;
         constexpr auto shutdown_send = SD_SEND;
@@ -343,10 +491,12 @@ namespace futils {
             });
         }
 
-        expected<Socket> setup_socket(std::uintptr_t sock, event::IOEvent* event) {
+        expected<Socket> setup_socket(std::uintptr_t sock, event::IOEvent* event, bool nonblock) {
             // prevent leak by exception
             auto d = helper::defer([&] { sockclose(sock); });
-            set_nonblock(sock);
+            if (!nonblock) {
+                set_nonblock(sock);
+            }
             auto tbl = make_sock_table(sock, event);
             d.cancel();  // now sock transferred to tbl
             auto registered = event->register_handle(sock, tbl);
@@ -371,15 +521,27 @@ namespace futils {
 
         expected<std::pair<Socket, NetAddrPort>> Socket::accept() {
             return get_raw().and_then([&](std::uintptr_t sock) -> expected<std::pair<Socket, NetAddrPort>> {
+#ifdef FUTILS_PLATFORM_LINUX
+                if (auto queued = uring::accept_queued(static_cast<SockTable*>(ctx))) {
+                    return std::move(*queued);
+                }
+#endif
                 sockaddr_storage st{};
                 socklen_t addrlen = sizeof(st);
                 auto ptr = reinterpret_cast<sockaddr*>(&st);
+#ifdef FUTILS_PLATFORM_LINUX
+                // set flags at once instead of fcntl after accept
+                auto new_sock = lazy::accept4_(sock, ptr, &addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                constexpr bool nonblock = true;
+#else
                 auto new_sock = lazy::accept_(sock, ptr, &addrlen);
+                constexpr bool nonblock = false;
+#endif
                 if (new_sock == -1) {
                     return unexpect(error::Errno());
                 }
                 // register IOCP
-                return setup_socket(new_sock, static_cast<SockTable*>(ctx)->event)
+                return setup_socket(new_sock, static_cast<SockTable*>(ctx)->event, nonblock)
                     .transform([&](Socket&& s) {
                         return std::make_pair(std::move(s), sockaddr_to_NetAddrPort(ptr, addrlen));
                     });
@@ -401,6 +563,12 @@ namespace futils {
             });
         }
 
+        fnet_dll_implement(expected<void>) notify_io_event() {
+            return init_event().and_then([&](event::IOEvent& event) {
+                return event.notify();
+            });
+        }
+
         fnet_dll_implement(expected<Socket>) make_socket(SockAttr attr, event::IOEvent* event) {
             set_error(0);
             if (!lazy::load_socket()) {
@@ -11,6 +11,7 @@
 #include <fnet/dll/lazy/sockdll.h>
 #include <fnet/sock_internal.h>
 #include <platform/detect.h>
+#include <atomic>
 
 namespace futils {
     namespace fnet {
@@ -112,6 +113,51 @@ namespace futils {
 #endif
         }
 
+        expected<void> Socket::set_reuse_port(bool reuse) {
+#ifdef FUTILS_PLATFORM_LINUX
+            int yes = reuse ? 1 : 0;
+            return set_option(SOL_SOCKET, SO_REUSEPORT, yes);
+#else
+            return unexpect(error::Error("SO_REUSEPORT is not supported on this platform", error::Category::lib, error::fnet_usage_error));
+#endif
+        }
+
+        expected<void> Socket::set_incoming_cpu(int cpu) {
+#ifdef FUTILS_PLATFORM_LINUX
+            return set_option(SOL_SOCKET, SO_INCOMING_CPU, cpu);
+#else
+            return unexpect(error::Error("SO_INCOMING_CPU is not supported on this platform", error::Category::lib, error::fnet_usage_error));
+#endif
+        }
+
+        constexpr auto errKTLSNotSupport = error::Error("kernel TLS (tls ULP) is not available", error::Category::lib, error::fnet_usage_error);
+
+        // set when kernel has no tls ULP (tls module is not available)
+        // so that following connections skip setsockopt
+        // this is deliberately latched for process lifetime and never reset:
+        // on each failed TCP_ULP kernel tries request_module (runs modprobe) before returning ENOENT,
+        // so retrying per connection is expensive. tls module loaded after first failure is not used until restart
+        static std::atomic_bool ktls_unavailable = false;
+
+        expected<void> Socket::set_ktls_send(view::rvec crypto_info) {
+#ifdef FUTILS_PLATFORM_LINUX
+            if (ktls_unavailable.load(std::memory_order_relaxed)) {
+                return unexpect(errKTLSNotSupport);
+            }
+            auto res = set_option(SOL_TCP, TCP_ULP, "tls", 3);
+            if (!res) {
+                auto& err = res.error();
+                if (err.category() == error::Category::os && err.code() == ENOENT) {
+                    ktls_unavailable.store(true, std::memory_order_relaxed);
+                }
+                return res;
+            }
+            return set_option(SOL_TLS, TLS_TX, crypto_info.data(), crypto_info.size());
+#else
+            return unexpect(errKTLSNotSupport);
+#endif
+        }
+
         expected<void> Socket::set_mtu_discover(MTUConfig conf) {
             int val = 0;
             if (conf == mtu_default) {
@@ -285,6 +331,24 @@ namespace futils {
 #endif
         }
 
+        expected<void> Socket::set_gro(bool enable) {
+#ifdef FUTILS_PLATFORM_LINUX
+            int val = enable ? 1 : 0;
+            return set_option(IPPROTO_UDP, UDP_GRO, val);
+#else
+            return unexpect(error::Error("GRO is not supported", error::Category::lib, error::fnet_usage_error));
+#endif
+        }
+
+        expected<bool> Socket::get_gro() {
+#ifdef FUTILS_PLATFORM_LINUX
+            int val = 0;
+            return get_option(IPPROTO_UDP, UDP_GRO, val).transform([&] { return val != 0; });
+#else
+            return unexpect(error::Error("GRO is not supported", error::Category::lib, error::fnet_usage_error));
+#endif
+        }
+
         expected<void> Socket::set_recv_packet_info_v4(bool enable) {
             // TODO(on-keyday): in other unix like platform,
             // use IP_RECVPKTINFO instead of IP_PKTINFO
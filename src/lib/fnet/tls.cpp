@@ -12,7 +12,10 @@
 #include <fnet/dll/glheap.h>
 #include <cstring>
 #include <fnet/tls/liberr.h>
+#include <fnet/quic/crypto/crypto.h>
+#include <number/char_range.h>
 #include <limits>
+#include <string_view>
 
 namespace futils {
 
@@ -53,6 +56,14 @@ namespace futils {
             void* user = nullptr;
             int (*quic_cb)(void* user, quic::crypto::MethodArgs) = nullptr;
 
+            // kTLS send state (see TLSConfig::set_ktls_enabled)
+            byte ktls_write_secret[32]{};
+            bool ktls_has_secret = false;
+            // true after Finished is written (application traffic key is used)
+            bool ktls_app_key = false;
+            bool ktls_key_updated = false;
+            std::uint64_t ktls_write_seq = 0;
+
             ~SSLContexts() {
                 if (ssl) {
                     lazy::ssl::SSL_free_(ssl);
@@ -67,6 +78,9 @@ namespace futils {
             delete_glheap(static_cast<SSLContexts*>(opt));
         }
 
+        // defined in tlsopt.cpp
+        bool is_ktls_enabled(ssl_import::SSL_CTX* c);
+
         fnet_dll_implement(expected<TLS>) create_tls_with_error(const TLSConfig& conf) {
             if (!conf.ctx) {
                 return unexpect(errConfigNotInitialized);
@@ -86,6 +100,18 @@ namespace futils {
             auto r = helper::defer([&]() {
                 lazy::ssl::SSL_free_(ssl);
             });
+            // for kTLS callbacks
+            if (!lazy::ssl::SSL_set_ex_data_(ssl, ssl_import::ssl_appdata_index, c)) {
+                return unexpect(libError("SSL_set_ex_data", "failed to set SSL ex data", ssl, 0));
+            }
+            // kTLS send info is provided only for TLS_AES_128_GCM_SHA256 (see TLS::get_ktls_send_info)
+            // it is mandatory cipher suite of TLS 1.3 (RFC8446 section 9.1) so every peer supports it
+            // on BoringSSL, TLS 1.3 cipher suites are not configurable
+            if (is_ktls_enabled(static_cast<ssl_import::SSL_CTX*>(conf.ctx)) && lazy::ssl::ossl::sp::SSL_set_ciphersuites_.find()) {
+                if (!lazy::ssl::ossl::sp::SSL_set_ciphersuites_(ssl, "TLS_AES_128_GCM_SHA256")) {
+                    return unexpect(libError("SSL_set_ciphersuites", "failed to set TLS 1.3 cipher suites", ssl, 0));
+                }
+            }
             ssl_import::BIO *pass = nullptr, *hold = nullptr;
             lazy::crypto::BIO_new_bio_pair_(&pass, 0, &hold, 0);
             if (!pass || !hold) {
@@ -544,6 +570,117 @@ namespace futils {
             return view::rvec(ver, futils::strlen(ver));
         }
 
+        // called from key log callback when TLSConfig::set_ktls_enabled(true)
+        // line is NSS key log format like `SERVER_TRAFFIC_SECRET_0 <client random> <secret>`
+        void ktls_keylog_callback(const ssl_import::SSL* ssl, const char* line) {
+            auto c = static_cast<SSLContexts*>(lazy::ssl::SSL_get_ex_data_(ssl, ssl_import::ssl_appdata_index));
+            if (!c) {
+                return;
+            }
+            std::string_view label = lazy::ssl::SSL_is_server_(ssl) ? "SERVER_TRAFFIC_SECRET_0 " : "CLIENT_TRAFFIC_SECRET_0 ";
+            std::string_view l = line;
+            if (!l.starts_with(label)) {
+                return;
+            }
+            auto pos = l.find(' ', label.size());
+            if (pos == l.npos) {
+                return;
+            }
+            auto secret = l.substr(pos + 1);
+            // only 32 byte secret (SHA256 cipher suites) is supported
+            if (secret.size() != sizeof(c->ktls_write_secret) * 2) {
+                return;
+            }
+            for (auto s : secret) {
+                if (!number::is_hex(s)) {
+                    return;
+                }
+            }
+            for (size_t i = 0; i < sizeof(c->ktls_write_secret); i++) {
+                c->ktls_write_secret[i] = number::number_transform[byte(secret[i * 2])] << 4 |
+                                          number::number_transform[byte(secret[i * 2 + 1])];
+            }
+            c->ktls_has_secret = true;
+        }
+
+        // called from message callback when TLSConfig::set_ktls_enabled(true)
+        // counts records written with application traffic key
+        void ktls_msg_callback(int write_p, int version, int content_type, const void* buf, size_t len, ssl_import::SSL* ssl, void* arg) {
+            if (!write_p) {
+                return;
+            }
+            auto c = static_cast<SSLContexts*>(lazy::ssl::SSL_get_ex_data_(ssl, ssl_import::ssl_appdata_index));
+            if (!c) {
+                return;
+            }
+            if (content_type == ssl_import::SSL3_RT_HEADER_) {
+                // header of each record is reported before handshake message in it
+                if (c->ktls_app_key) {
+                    c->ktls_write_seq++;
+                }
+            }
+            else if (content_type == ssl_import::SSL3_RT_HANDSHAKE_ && len > 0) {
+                constexpr byte finished = 20, key_update = 24;
+                auto type = static_cast<const byte*>(buf)[0];
+                if (type == finished) {
+                    c->ktls_app_key = true;
+                }
+                else if (type == key_update) {
+                    c->ktls_key_updated = true;
+                }
+            }
+        }
+
+        // same layout as linux struct tls12_crypto_info_aes_gcm_128
+        struct KTLSCryptoInfoAESGCM128 {
+            std::uint16_t version = 0;
+            std::uint16_t cipher_type = 0;
+            byte iv[8]{};
+            byte key[16]{};
+            byte salt[4]{};
+            byte rec_seq[8]{};
+        };
+
+        static_assert(sizeof(KTLSCryptoInfoAESGCM128) == ktls_crypto_info_size);
+
+        expected<view::wvec> TLS::get_ktls_send_info(view::wvec buffer) {
+            CHECK_TLS_CONN(c)
+            if (buffer.size() < ktls_crypto_info_size) {
+                return unexpect(error::Error("buffer is too small for kTLS crypto info", error::Category::lib, error::fnet_tls_usage_error));
+            }
+            if (lazy::ssl::SSL_in_init_(c->ssl) || !c->ktls_has_secret || !c->ktls_app_key) {
+                return unexpect(error::Error("application traffic secret is not available. kTLS is not enabled or handshake is not done", error::Category::lib, error::fnet_tls_usage_error));
+            }
+            if (c->ktls_key_updated) {
+                return unexpect(error::Error("kTLS is not supported after KeyUpdate", error::Category::lib, error::fnet_tls_not_supported));
+            }
+            const char* ver = lazy::ssl::SSL_get_version_(c->ssl);
+            if (!ver || std::string_view(ver) != "TLSv1.3") {
+                return unexpect(error::Error("kTLS is supported only on TLS 1.3", error::Category::lib, error::fnet_tls_not_supported));
+            }
+            auto cipher = make_cipher(lazy::ssl::SSL_get_current_cipher_(c->ssl));
+            if (!cipher || !cipher.is_algorithm("TLS_AES_128_GCM_SHA256")) {
+                return unexpect(error::Error("kTLS is supported only with TLS_AES_128_GCM_SHA256", error::Category::lib, error::fnet_tls_not_supported));
+            }
+            // refer RFC8446 section 7.3
+            byte tmp[64], key[16], iv[12];
+            if (!quic::crypto::HKDF_Expand_label(tmp, key, c->ktls_write_secret, view::rvec("key", 3)) ||
+                !quic::crypto::HKDF_Expand_label(tmp, iv, c->ktls_write_secret, view::rvec("iv", 2))) {
+                return unexpect(error::Error("failed to derive traffic key", error::Category::lib, error::fnet_tls_error));
+            }
+            KTLSCryptoInfoAESGCM128 info;
+            info.version = 0x0304;  // TLS_1_3_VERSION
+            info.cipher_type = 51;  // TLS_CIPHER_AES_GCM_128
+            std::memcpy(info.salt, iv, 4);
+            std::memcpy(info.iv, iv + 4, 8);
+            std::memcpy(info.key, key, 16);
+            for (size_t i = 0; i < 8; i++) {
+                info.rec_seq[i] = byte(c->ktls_write_seq >> (56 - i * 8));
+            }
+            std::memcpy(buffer.data(), &info, sizeof(info));
+            return buffer.substr(0, sizeof(info));
+        }
+
         fnet_dll_export(view::rvec) get_alert_desc(futils::byte alert_code) {
             return view::rvec(lazy::ssl::SSL_alert_desc_string_long_(alert_code));
         }
@@ -162,8 +162,26 @@ namespace futils {
             void* sess_callback_arg = nullptr;
             void (*keylog_callback)(view::rvec line, void*) = nullptr;
             void* keylog_callback_arg = nullptr;
+            bool ktls_enabled = false;
         };
 
+        // defined in tls.cpp
+        void ktls_keylog_callback(const ssl_import::SSL* ssl, const char* line);
+        void ktls_msg_callback(int write_p, int version, int content_type, const void* buf, size_t len, ssl_import::SSL* ssl, void* arg);
+
+        void keylog_callback(const ssl_import::SSL* ssl, const char* line) {
+            auto ctx = lazy::ssl::SSL_get_SSL_CTX_(ssl);
+            auto holder = static_cast<SSLContextHolder*>(lazy::ssl::SSL_CTX_get_ex_data_(ctx, ssl_import::ssl_appdata_index));
+            assert(ctx == holder->ctx);
+            if (holder->ktls_enabled) {
+                ktls_keylog_callback(ssl, line);
+            }
+            if (!holder->keylog_callback) {
+                return;
+            }
+            holder->keylog_callback(line, holder->keylog_callback_arg);
+        }
+
         fnet_dll_implement(expected<TLSConfig>) configure_with_error() {
             TLSConfig conf;
             set_error(0);
@@ -348,18 +366,32 @@ namespace futils {
             auto holder = static_cast<SSLContextHolder*>(lazy::ssl::SSL_CTX_get_ex_data_(c, ssl_import::ssl_appdata_index));
             holder->keylog_callback = global_log;
             holder->keylog_callback_arg = v;
-            lazy::ssl::SSL_CTX_set_keylog_callback_(c, [](const ssl_import::SSL* ssl, const char* line) {
-                auto ctx = lazy::ssl::SSL_get_SSL_CTX_(ssl);
-                auto holder = static_cast<SSLContextHolder*>(lazy::ssl::SSL_CTX_get_ex_data_(ctx, ssl_import::ssl_appdata_index));
-                assert(ctx == holder->ctx);
-                if (!holder->keylog_callback) {
-                    return;
-                }
-                holder->keylog_callback(line, holder->keylog_callback_arg);
-            });
+            lazy::ssl::SSL_CTX_set_keylog_callback_(c, keylog_callback);
             return {};
         }
 
+        expected<void> TLSConfig::set_ktls_enabled(bool enable) {
+            CHECK_CTX(c)
+            auto holder = static_cast<SSLContextHolder*>(lazy::ssl::SSL_CTX_get_ex_data_(c, ssl_import::ssl_appdata_index));
+            holder->ktls_enabled = enable;
+            // traffic secret is taken from key log and record sequence number is counted by message callback
+            if (enable || holder->keylog_callback) {
+                lazy::ssl::SSL_CTX_set_keylog_callback_(c, keylog_callback);
+            }
+            else {
+                lazy::ssl::SSL_CTX_set_keylog_callback_(c, nullptr);
+            }
+            lazy::ssl::SSL_CTX_set_msg_callback_(c, enable ? ktls_msg_callback : nullptr);
+            // cipher suites are limited per connection by create_tls_with_error
+            // so that suites of ctx are kept as is when kTLS is toggled
+            return {};
+        }
+
+        bool is_ktls_enabled(ssl_import::SSL_CTX* c) {
+            auto holder = static_cast<SSLContextHolder*>(lazy::ssl::SSL_CTX_get_ex_data_(c, ssl_import::ssl_appdata_index));
+            return holder && holder->ktls_enabled;
+        }
+
         expected<void> TLSConfig::set_session_callback(bool (*cb)(Session&& sess, void* arg), void* arg) {
             CHECK_CTX(c)
             auto holder = static_cast<SSLContextHolder*>(lazy::ssl::SSL_CTX_get_ex_data_(c, ssl_import::ssl_appdata_index));
@@ -0,0 +1,1009 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+// uring - io_uring completion backend of IOEvent
+// completion queue entries are converted to epoll_event (data.u64 = user_data, events = res)
+// so fnet_handle_completion and convert_completion work for both backends
+// see also io_uring(7)
+#include <fnet/dll/dllcpp.h>
+#include <fnet/sock_internal.h>
+#include <fnet/dll/lazy/sockdll.h>
+#include <fnet/dll/errno.h>
+#include <fnet/dll/glheap.h>
+#include <fnet/dll/allocator.h>
+#include <fnet/socket.h>
+#include <helper/defer.h>
+#include <thread/lite_lock.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <atomic>
+#include <cassert>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+namespace futils::fnet {
+    // defined in epoll2.cpp
+    Canceler make_canceler(std::uint64_t code, bool w, void* b);
+    AsyncResult on_success(EpollTable* t, std::uint64_t code, bool w, size_t bytes);
+    void call_stream(void (*notify_base)(), void* user, IOTableHeader* base, NotifyResult&& result);
+
+    // state of multishot recv or accept of a socket
+    // completions are queued here until read_async/accept_async or read/accept takes them
+    struct UringMultishot {
+        struct Entry {
+            std::int32_t res = 0;  // received bytes, accepted socket or -errno
+            std::uint16_t bid = 0;
+            std::uint32_t offset = 0;
+        };
+        thread::LiteLock lock;
+        bool is_accept = false;
+        bool armed = false;      // operation is in kernel and holds reference of table
+        bool canceling = false;  // cancel is submitted by on_last_ref
+        bool waiting = false;    // callback is set and waits queue
+        std::deque<Entry, glheap_allocator<Entry>> queue;
+    };
+
+    namespace uring {
+        constexpr unsigned sq_entries = 256;
+        constexpr unsigned cq_entries = 4096;
+        constexpr unsigned reap_batch = 64;
+
+        // provided buffer ring used by multishot recv
+        constexpr std::uint16_t buffer_group = 0;
+        constexpr unsigned buffer_entries = 512;
+        constexpr unsigned buffer_size = 4096;
+
+        struct Ring {
+            int fd = -1;
+            void* sq_ptr = nullptr;
+            size_t sq_map_size = 0;
+            void* cq_ptr = nullptr;
+            size_t cq_map_size = 0;
+            io_uring_sqe* sqes = nullptr;
+            size_t sqes_size = 0;
+
+            unsigned* sq_head = nullptr;
+            unsigned* sq_tail = nullptr;
+            unsigned* sq_array = nullptr;
+            unsigned sq_mask = 0;
+            unsigned sq_size = 0;
+            unsigned* cq_head = nullptr;
+            unsigned* cq_tail = nullptr;
+            io_uring_cqe* cqes = nullptr;
+            unsigned cq_mask = 0;
+
+            thread::LiteLock sq_lock;
+            unsigned pending = 0;  // submission entries not yet passed to kernel
+            thread::LiteLock cq_lock;
+
+            io_uring_buf_ring* br = nullptr;
+            byte* buffers = nullptr;
+            thread::LiteLock br_lock;
+            bool multishot = false;  // multishot recv/accept with provided buffers are available
+        };
+
+        // ring which current thread is dispatching completions of
+        // submissions while dispatching are passed to kernel together after dispatch
+        thread_local Ring* dispatching = nullptr;
+
+        int sys_setup(unsigned entries, io_uring_params* p) {
+            return int(::syscall(__NR_io_uring_setup, entries, p));
+        }
+
+        int sys_enter(int fd, unsigned submit, unsigned min_complete, unsigned flags, void* arg, size_t arg_size) {
+            return int(::syscall(__NR_io_uring_enter, fd, submit, min_complete, flags, arg, arg_size));
+        }
+
+        int sys_register(int fd, unsigned op, void* arg, unsigned nr) {
+            return int(::syscall(__NR_io_uring_register, fd, op, arg, nr));
+        }
+
+        unsigned load_acquire(unsigned* p) {
+            return std::atomic_ref<unsigned>(*p).load(std::memory_order_acquire);
+        }
+
+        void store_release(unsigned* p, unsigned v) {
+            std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+        }
+
+        bool probe_opcodes(int fd) {
+            constexpr std::uint8_t required[] = {
+                IORING_OP_SEND,
+                IORING_OP_RECV,
+                IORING_OP_SENDMSG,
+                IORING_OP_RECVMSG,
+                IORING_OP_ACCEPT,
+                IORING_OP_CONNECT,
+                IORING_OP_ASYNC_CANCEL,
+            };
+            constexpr auto probe_size = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+            alignas(io_uring_probe) byte storage[probe_size]{};
+            auto probe = reinterpret_cast<io_uring_probe*>(storage);
+            if (sys_register(fd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+                return false;
+            }
+            for (auto op : required) {
+                if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // multishot recv requires linux 6.0 and it cannot be probed
+        bool kernel_supports_multishot() {
+            utsname u;
+            if (::uname(&u) != 0) {
+                return false;
+            }
+            int major = 0;
+            if (std::sscanf(u.release, "%d.", &major) != 1) {
+                return false;
+            }
+            return major >= 6;
+        }
+
+        void recycle_buffer(Ring* r, std::uint16_t bid) {
+            std::lock_guard l{r->br_lock};
+            auto tail = r->br->tail;
+            // io_uring_buf_ring::bufs is not at offset 0 in C++ because __DECLARE_FLEX_ARRAY has an empty struct
+            auto& buf = reinterpret_cast<io_uring_buf*>(r->br)[tail & (buffer_entries - 1)];
+            // don't assign whole struct. resv of first entry is tail
+            buf.addr = std::uint64_t(r->buffers + size_t(bid) * buffer_size);
+            buf.len = buffer_size;
+            buf.bid = bid;
+            std::atomic_ref<std::uint16_t>(r->br->tail).store(tail + 1, std::memory_order_release);
+        }
+
+        bool setup_buffers(Ring* r) {
+            const auto ring_size = buffer_entries * sizeof(io_uring_buf);
+            auto br = ::mmap(nullptr, ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (br == MAP_FAILED) {
+                return false;
+            }
+            auto buffers = ::mmap(nullptr, buffer_entries * buffer_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (buffers == MAP_FAILED) {
+                ::munmap(br, ring_size);
+                return false;
+            }
+            io_uring_buf_reg reg{};
+            reg.ring_addr = std::uint64_t(br);
+            reg.ring_entries = buffer_entries;
+            reg.bgid = buffer_group;
+            if (sys_register(r->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+                ::munmap(buffers, buffer_entries * buffer_size);
+                ::munmap(br, ring_size);
+                return false;
+            }
+            r->br = static_cast<io_uring_buf_ring*>(br);
+            r->buffers = static_cast<byte*>(buffers);
+            for (unsigned i = 0; i < buffer_entries; i++) {
+                recycle_buffer(r, std::uint16_t(i));
+            }
+            return true;
+        }
+
+        void destroy_ring(void* ptr) {
+            auto r = static_cast<Ring*>(ptr);
+            if (r->buffers) {
+                ::munmap(r->buffers, buffer_entries * buffer_size);
+            }
+            if (r->br) {
+                ::munmap(r->br, buffer_entries * sizeof(io_uring_buf));
+            }
+            if (r->sqes) {
+                ::munmap(r->sqes, r->sqes_size);
+            }
+            if (r->cq_ptr && r->cq_ptr != r->sq_ptr) {
+                ::munmap(r->cq_ptr, r->cq_map_size);
+            }
+            if (r->sq_ptr) {
+                ::munmap(r->sq_ptr, r->sq_map_size);
+            }
+            if (r->fd != -1) {
+                lazy::close_(r->fd);
+            }
+            delete_glheap(r);
+        }
+
+        expected<void*> make_ring() {
+            io_uring_params p{};
+            p.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+            p.cq_entries = cq_entries;
+            auto fd = sys_setup(sq_entries, &p);
+            if (fd < 0) {
+                return unexpect(error::Errno());
+            }
+            auto r = new_glheap(Ring);
+            r->fd = fd;
+            auto d = helper::defer([&] { destroy_ring(r); });
+            // NODROP: completions are never lost even if completion queue is full
+            // EXT_ARG: wait with timeout without timeout operation
+            if (!(p.features & IORING_FEAT_NODROP) || !(p.features & IORING_FEAT_EXT_ARG) || !probe_opcodes(fd)) {
+                return unexpect(error::Error("kernel does not support required io_uring features", error::Category::lib, error::fnet_usage_error));
+            }
+            r->sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+            r->cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+            const bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+            if (single_mmap) {
+                r->sq_map_size = r->cq_map_size = (std::max)(r->sq_map_size, r->cq_map_size);
+            }
+            auto sq = ::mmap(nullptr, r->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sq == MAP_FAILED) {
+                return unexpect(error::Errno());
+            }
+            r->sq_ptr = sq;
+            if (single_mmap) {
+                r->cq_ptr = sq;
+            }
+            else {
+                auto cq = ::mmap(nullptr, r->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                if (cq == MAP_FAILED) {
+                    return unexpect(error::Errno());
+                }
+                r->cq_ptr = cq;
+            }
+            r->sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+            auto sqes = ::mmap(nullptr, r->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (sqes == MAP_FAILED) {
+                return unexpect(error::Errno());
+            }
+            r->sqes = static_cast<io_uring_sqe*>(sqes);
+            auto sq_base = static_cast<byte*>(r->sq_ptr);
+            r->sq_head = reinterpret_cast<unsigned*>(sq_base + p.sq_off.head);
+            r->sq_tail = reinterpret_cast<unsigned*>(sq_base + p.sq_off.tail);
+            r->sq_array = reinterpret_cast<unsigned*>(sq_base + p.sq_off.array);
+            r->sq_mask = *reinterpret_cast<unsigned*>(sq_base + p.sq_off.ring_mask);
+            r->sq_size = p.sq_entries;
+            auto cq_base = static_cast<byte*>(r->cq_ptr);
+            r->cq_head = reinterpret_cast<unsigned*>(cq_base + p.cq_off.head);
+            r->cq_tail = reinterpret_cast<unsigned*>(cq_base + p.cq_off.tail);
+            r->cqes = reinterpret_cast<io_uring_cqe*>(cq_base + p.cq_off.cqes);
+            r->cq_mask = *reinterpret_cast<unsigned*>(cq_base + p.cq_off.ring_mask);
+            // without provided buffers, all operations are single shot
+            r->multishot = kernel_supports_multishot() && setup_buffers(r);
+            d.cancel();
+            return r;
+        }
+
+        // sq_lock must be held
+        void flush_locked(Ring* r) {
+            while (r->pending) {
+                auto res = sys_enter(r->fd, r->pending, 0, 0, nullptr, 0);
+                if (res < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    // EBUSY or EAGAIN: entries stay in queue and are passed by next flush
+                    return;
+                }
+                r->pending -= res;
+            }
+        }
+
+        // sq_lock must be held
+        io_uring_sqe* get_sqe(Ring* r) {
+            for (auto i = 0; i < 2; i++) {
+                auto head = load_acquire(r->sq_head);
+                auto tail = *r->sq_tail;
+                if (tail - head < r->sq_size) {
+                    auto index = tail & r->sq_mask;
+                    auto sqe = &r->sqes[index];
+                    std::memset(sqe, 0, sizeof(*sqe));
+                    r->sq_array[index] = index;
+                    return sqe;
+                }
+                flush_locked(r);
+            }
+            return nullptr;
+        }
+
+        expected<void> submit(Ring* r, auto&& fill) {
+            std::lock_guard l{r->sq_lock};
+            auto sqe = get_sqe(r);
+            if (!sqe) {
+                return unexpect(error::Error("io_uring submission queue is full", error::Category::lib, error::fnet_async_error));
+            }
+            fill(sqe);
+            store_release(r->sq_tail, *r->sq_tail + 1);
+            r->pending++;
+            if (dispatching != r) {
+                flush_locked(r);
+            }
+            return {};
+        }
+
+        expected<void> submit_cancel(Ring* r, std::uint64_t target) {
+            return submit(r, [&](io_uring_sqe* sqe) {
+                sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                sqe->fd = -1;
+                sqe->addr = target;
+                sqe->user_data = 0;  // ignored
+            });
+        }
+
+        Ring* get_ring(EpollTable* t) {
+            return static_cast<Ring*>(t->uring);
+        }
+
+        std::uint64_t multishot_user_data(EpollTable* t, UringMultishot* ms) {
+            return std::uint64_t(t) | (ms->is_accept ? kind_accept : kind_recv);
+        }
+
+        static_assert(alignof(EpollIOTableHeader) > kind_mask && alignof(EpollTable) > kind_mask, "low bits of pointer are used as tag");
+
+        UringMultishot* get_multishot(EpollTable* t, bool accept) {
+            auto ms = t->multishot.load(std::memory_order_acquire);
+            if (!ms) {
+                // r.l is held so no other thread makes it
+                ms = new_glheap(UringMultishot);
+                ms->is_accept = accept;
+                t->multishot.store(ms, std::memory_order_release);
+            }
+            return ms;
+        }
+
+        // ms->lock must be held
+        expected<void> arm_multishot(EpollTable* t, UringMultishot* ms) {
+            t->incr();  // released by last completion of multishot operation
+            auto res = submit(get_ring(t), [&](io_uring_sqe* sqe) {
+                sqe->fd = int(t->sock);
+                if (ms->is_accept) {
+                    sqe->opcode = IORING_OP_ACCEPT;
+                    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+                    sqe->accept_flags = SOCK_CLOEXEC | SOCK_NONBLOCK;
+                }
+                else {
+                    sqe->opcode = IORING_OP_RECV;
+                    sqe->ioprio = IORING_RECV_MULTISHOT;
+                    sqe->flags = IOSQE_BUFFER_SELECT;
+                    sqe->buf_group = buffer_group;
+                }
+                sqe->user_data = multishot_user_data(t, ms);
+            });
+            if (!res) {
+                t->decr();  // caller also holds references so this never reaches on_last_ref
+                return res;
+            }
+            ms->armed = true;
+            return {};
+        }
+
+        // copy queued data into buffer. ms->lock must be held
+        // returns 0 on end of stream and keeps it for next read
+        expected<size_t> pop_data(Ring* r, UringMultishot* ms, view::wvec buffer) {
+            size_t n = 0;
+            while (!ms->queue.empty() && n < buffer.size()) {
+                auto& e = ms->queue.front();
+                if (e.res <= 0) {
+                    if (n != 0 || e.res == 0) {
+                        break;  // deliver received data first
+                    }
+                    auto err = -e.res;
+                    ms->queue.pop_front();
+                    return unexpect(error::Error(err, error::Category::os));
+                }
+                auto len = (std::min)(size_t(e.res) - e.offset, buffer.size() - n);
+                std::memcpy(buffer.data() + n, r->buffers + size_t(e.bid) * buffer_size + e.offset, len);
+                n += len;
+                e.offset += len;
+                if (e.offset == std::uint32_t(e.res)) {
+                    recycle_buffer(r, e.bid);
+                    ms->queue.pop_front();
+                }
+            }
+            return n;
+        }
+
+        NetAddrPort peer_addr(std::uintptr_t sock) {
+            sockaddr_storage st{};
+            socklen_t len = sizeof(st);
+            if (lazy::getpeername_(sock, reinterpret_cast<sockaddr*>(&st), &len) != 0) {
+                return NetAddrPort();
+            }
+            return sockaddr_to_NetAddrPort(reinterpret_cast<sockaddr*>(&st), len);
+        }
+
+        expected<std::pair<Socket, NetAddrPort>> setup_accepted(EpollTable* t, std::int32_t res, NetAddrPort&& addr) {
+            if (res < 0) {
+                return unexpect(error::Error(-res, error::Category::os));
+            }
+            return setup_socket(std::uintptr_t(res), t->event, true).transform([&](Socket&& s) {
+                return std::make_pair(std::move(s), std::move(addr));
+            });
+        }
+
+        std::optional<expected<view::wvec>> read_queued(SockTable* s, view::wvec data, bool is_stream) {
+            auto t = static_cast<EpollTable*>(s);
+            if (!t->uring) {
+                return std::nullopt;
+            }
+            auto ms = t->multishot.load(std::memory_order_acquire);
+            if (!ms || ms->is_accept) {
+                return std::nullopt;
+            }
+            std::lock_guard l{ms->lock};
+            if (ms->queue.empty()) {
+                if (ms->armed) {
+                    // reading socket directly breaks order of data
+                    return expected<view::wvec>(unexpect(error::Error(EAGAIN, error::Category::os)));
+                }
+                return std::nullopt;
+            }
+            auto res = pop_data(get_ring(t), ms, data);
+            if (!res) {
+                return expected<view::wvec>(unexpect(res.error()));
+            }
+            if (*res == 0 && is_stream) {
+                return expected<view::wvec>(unexpect(error::eof));
+            }
+            return expected<view::wvec>(data.substr(0, *res));
+        }
+
+        std::optional<expected<std::pair<Socket, NetAddrPort>>> accept_queued(SockTable* s) {
+            auto t = static_cast<EpollTable*>(s);
+            if (!t->uring) {
+                return std::nullopt;
+            }
+            auto ms = t->multishot.load(std::memory_order_acquire);
+            if (!ms || !ms->is_accept) {
+                return std::nullopt;
+            }
+            std::int32_t res = 0;
+            {
+                std::lock_guard l{ms->lock};
+                if (ms->queue.empty()) {
+                    if (ms->armed) {
+                        return expected<std::pair<Socket, NetAddrPort>>(unexpect(error::Error(EAGAIN, error::Category::os)));
+                    }
+                    return std::nullopt;
+                }
+                res = ms->queue.front().res;
+                ms->queue.pop_front();
+            }
+            auto addr = res >= 0 ? peer_addr(res) : NetAddrPort();
+            return setup_accepted(t, res, std::move(addr));
+        }
+
+        // call functions are called with result of completion
+        // std::nullopt means that data is queued by multishot operation
+
+        void call_read(void (*notify_base)(), void* user, IOTableHeader* base, NotifyResult&& result) {
+            auto hdr = static_cast<EpollIOTableHeader*>(base);
+            auto sock = make_socket(hdr->base);
+            auto notify = reinterpret_cast<stream_notify_t>(notify_base);
+            auto& res = result.value();
+            if (res && !*res) {
+                auto buffer = view::wvec(static_cast<byte*>(hdr->uring.iov.iov_base), hdr->uring.iov.iov_len);
+                auto queued = read_queued(hdr->base, buffer, true);
+                hdr->l.unlock();  // release, so can do next IO
+                if (!queued) {
+                    notify(std::move(sock), user, unexpect(error::Error(EAGAIN, error::Category::os)));
+                }
+                else if (!*queued) {
+                    notify(std::move(sock), user, unexpect(queued->error()));
+                }
+                else {
+                    notify(std::move(sock), user, (*queued)->size());
+                }
+                return;
+            }
+            hdr->l.unlock();  // release, so can do next IO
+            if (res && **res == 0) {
+                notify(std::move(sock), user, unexpect(error::eof));
+                return;
+            }
+            notify(std::move(sock), user, std::move(result));
+        }
+
+        void call_recvmsg(void (*notify_base)(), void* user, IOTableHeader* base, NotifyResult&& result) {
+            auto hdr = static_cast<EpollIOTableHeader*>(base);
+            auto sock = make_socket(hdr->base);
+            NetAddrPort addr;
+            if (result.value()) {
+                addr = sockaddr_to_NetAddrPort(reinterpret_cast<sockaddr*>(&hdr->uring.addr), hdr->uring.msg.msg_namelen);
+            }
+            hdr->l.unlock();  // release, so can do next IO
+            auto notify = reinterpret_cast<recvfrom_notify_t>(notify_base);
+            notify(std::move(sock), std::move(addr), user, std::move(result));
+        }
+
+        void call_accept(void (*notify_base)(), void* user, IOTableHeader* base, NotifyResult&& result) {
+            auto hdr = static_cast<EpollIOTableHeader*>(base);
+            auto listener = make_socket(hdr->base);
+            auto notify = reinterpret_cast<accept_notify_t>(notify_base);
+            auto& res = result.value();
+            expected<std::pair<Socket, NetAddrPort>> accepted;
+            if (!res) {
+                accepted = unexpect(res.error());
+            }
+            else if (*res) {
+                // single shot accept returns new socket
+                auto addr = sockaddr_to_NetAddrPort(reinterpret_cast<sockaddr*>(&hdr->uring.addr), hdr->uring.addr_len);
+                accepted = setup_accepted(hdr->base, std::int32_t(**res), std::move(addr));
+            }
+            else if (auto queued = accept_queued(hdr->base)) {
+                accepted = std::move(*queued);
+            }
+            else {
+                accepted = unexpect(error::Error(EAGAIN, error::Category::os));
+            }
+            hdr->l.unlock();  // release, so can do next IO
+            if (!accepted) {
+                notify(std::move(listener), Socket(), NetAddrPort(), user, unexpect(accepted.error()));
+                return;
+            }
+            notify(std::move(listener), std::move(accepted->first), std::move(accepted->second), user, std::nullopt);
+        }
+
+        void call_connect(void (*notify_base)(), void* user, IOTableHeader* base, NotifyResult&& result) {
+            auto hdr = static_cast<EpollIOTableHeader*>(base);
+            auto sock = make_socket(hdr->base);
+            hdr->l.unlock();  // release, so can do next IO
+            auto notify = reinterpret_cast<stream_notify_t>(notify_base);
+            notify(std::move(sock), user, std::move(result));
+        }
+
+        void handle_completion(std::uint64_t user_data, std::int32_t res) {
+            auto kind = user_data & kind_mask;
+            auto ptr = user_data & ~kind_mask;
+            EpollIOTableHeader* io = nullptr;
+            if (kind == kind_single) {
+                io = reinterpret_cast<EpollIOTableHeader*>(ptr);
+            }
+            else if (kind == kind_recv || kind == kind_accept) {
+                io = &reinterpret_cast<EpollTable*>(ptr)->r;
+            }
+            else {
+                return;
+            }
+            auto call = io->cb.call.exchange(nullptr);
+            if (kind == kind_single) {
+                // after exchange, so Canceler never takes callback of completed operation
+                io->uring.inflight = false;
+            }
+            if (!call) {
+                return;  // canceled
+            }
+            auto notify = io->cb.notify;
+            auto user = io->cb.user;
+            if (kind != kind_single) {
+                call(notify, user, io, std::nullopt);
+            }
+            else if (res == -ECANCELED) {
+                call(notify, user, io, unexpect("operation canceled", error::Category::lib, error::fnet_async_error));
+            }
+            else if (res < 0) {
+                call(notify, user, io, unexpect(error::Error(-res, error::Category::os)));
+            }
+            else {
+                call(notify, user, io, size_t(res));
+            }
+        }
+
+        expected<AsyncResult> submit_single(EpollTable* t, EpollIOTableHeader& io, std::uint64_t cancel_code, bool is_write, auto&& fill) {
+            // make canceler before submit because completion may release table on other thread
+            auto cancel = make_canceler(cancel_code, is_write, t);
+            io.uring.inflight = true;
+            auto res = submit(get_ring(t), [&](io_uring_sqe* sqe) {
+                fill(sqe);
+                sqe->fd = int(t->sock);
+                sqe->user_data = std::uint64_t(&io) | kind_single;
+            });
+            if (!res) {
+                io.uring.inflight = false;
+                io.cb.call = nullptr;
+                auto dec = t->decr();
+                assert(dec != 0);
+                io.l.unlock();
+                return unexpect(res.error());
+            }
+            return AsyncResult{std::move(cancel), NotifyState::wait, 0};
+        }
+
+        void fill_recv(io_uring_sqe* sqe, EpollIOTableHeader& io, std::uint32_t flag) {
+            sqe->opcode = IORING_OP_RECV;
+            sqe->addr = std::uint64_t(io.uring.iov.iov_base);
+            sqe->len = std::uint32_t(io.uring.iov.iov_len);
+            sqe->msg_flags = flag;
+        }
+
+        // returns true if pending callback should be called
+        bool on_multishot(Ring* r, EpollTable* t, const io_uring_cqe& cqe) {
+            auto ms = t->multishot.load(std::memory_order_acquire);
+            const bool more = cqe.flags & IORING_CQE_F_MORE;
+            bool fire = false, fallback = false;
+            {
+                std::lock_guard l{ms->lock};
+                if (cqe.flags & IORING_CQE_F_BUFFER) {
+                    ms->queue.push_back({cqe.res, std::uint16_t(cqe.flags >> IORING_CQE_BUFFER_SHIFT), 0});
+                }
+                else if (cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+                    // accepted socket, end of stream or error
+                    ms->queue.push_back({cqe.res, 0, 0});
+                }
+                if (!more) {
+                    ms->armed = false;
+                    ms->canceling = false;
+                }
+                if (ms->waiting && !ms->queue.empty()) {
+                    ms->waiting = false;
+                    fire = true;
+                }
+                else if (ms->waiting && !more) {
+                    // stopped without data because provided buffers are exhausted
+                    if (ms->is_accept) {
+                        if (!arm_multishot(t, ms)) {
+                            ms->waiting = false;
+                            fire = true;  // reported as EAGAIN
+                        }
+                    }
+                    else {
+                        ms->waiting = false;
+                        t->r.uring.inflight = true;
+                        fallback = true;
+                    }
+                }
+            }
+            if (fallback) {
+                // read directly into buffer of pending read
+                auto res = submit(r, [&](io_uring_sqe* sqe) {
+                    fill_recv(sqe, t->r, 0);
+                    sqe->fd = int(t->sock);
+                    sqe->user_data = std::uint64_t(&t->r) | kind_single;
+                });
+                if (!res) {
+                    t->r.uring.inflight = false;
+                    fire = true;  // reported as EAGAIN
+                }
+            }
+            if (!more) {
+                // if pending callback exists, it holds another reference
+                t->decr();
+            }
+            return fire;
+        }
+
+        expected<size_t> wait(void* ptr, std::uint32_t timeout, void (*f)(void*, void*), void* rt) {
+            auto r = static_cast<Ring*>(ptr);
+            {
+                std::lock_guard l{r->sq_lock};
+                flush_locked(r);
+            }
+            if (*r->cq_head == load_acquire(r->cq_tail)) {
+                __kernel_timespec ts{};
+                ts.tv_sec = timeout / 1000;
+                ts.tv_nsec = (timeout % 1000) * 1000000;
+                io_uring_getevents_arg arg{};
+                arg.sigmask_sz = _NSIG / 8;
+                arg.ts = timeout == ~std::uint32_t(0) ? 0 : std::uint64_t(&ts);  // same as infinite timeout of epoll_wait
+                auto res = sys_enter(r->fd, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+                if (res < 0 && errno != ETIME && errno != EINTR && errno != EBUSY) {
+                    return unexpect(error::Errno());
+                }
+            }
+            io_uring_cqe cqes[reap_batch];
+            size_t n = 0;
+            {
+                std::lock_guard l{r->cq_lock};
+                auto head = *r->cq_head;
+                auto tail = load_acquire(r->cq_tail);
+                for (; head != tail && n < reap_batch; head++) {
+                    cqes[n++] = r->cqes[head & r->cq_mask];
+                }
+                store_release(r->cq_head, head);
+            }
+            auto prev = std::exchange(dispatching, r);
+            for (size_t i = 0; i < n; i++) {
+                auto kind = cqes[i].user_data & kind_mask;
+                if (kind == 0 || kind == kind_wakeup) {
+                    continue;  // cancel request or notify
+                }
+                if (kind != kind_single &&
+                    !on_multishot(r, reinterpret_cast<EpollTable*>(cqes[i].user_data & ~kind_mask), cqes[i])) {
+                    continue;
+                }
+                epoll_event ev{};
+                ev.data.u64 = cqes[i].user_data;
+                ev.events = std::uint32_t(cqes[i].res);
+                f(&ev, rt);
+            }
+            dispatching = prev;
+            {
+                std::lock_guard l{r->sq_lock};
+                flush_locked(r);
+            }
+            return n;
+        }
+
+        expected<void> notify(void* ptr) {
+            return submit(static_cast<Ring*>(ptr), [&](io_uring_sqe* sqe) {
+                sqe->opcode = IORING_OP_NOP;
+                sqe->fd = -1;
+                sqe->user_data = kind_wakeup;
+            });
+        }
+
+        expected<void> cancel(EpollTable* t, EpollIOTableHeader& io, std::uint64_t cancel_code) {
+            void (*notify)() = nullptr;
+            void* user = nullptr;
+            NotifyCallback::call_t call = nullptr;
+            auto result = io.l.interrupt(cancel_code, [&]() -> expected<void> {
+                auto ms = &io == &t->r ? t->multishot.load(std::memory_order_acquire) : nullptr;
+                std::unique_lock<thread::LiteLock> l;
+                if (ms) {
+                    l = std::unique_lock{ms->lock};
+                }
+                if (io.uring.inflight) {
+                    // callback is called by completion with ECANCELED
+                    return submit_cancel(get_ring(t), std::uint64_t(&io) | kind_single);
+                }
+                // waiting queue of multishot operation. no kernel operation refers buffer
+                if (ms) {
+                    ms->waiting = false;
+                }
+                if (auto call_ = io.cb.call.exchange(nullptr)) {
+                    call = call_;
+                    notify = io.cb.notify;
+                    user = io.cb.user;
+                    return expected<void>();
+                }
+                return unexpect("operation already done", error::Category::lib, error::fnet_async_error);
+            });
+            if (!result) {
+                return unexpect(result.error());
+            }
+            if (call) {
+                call(notify, user, &io, unexpect("operation canceled", error::Category::lib, error::fnet_async_error));
+            }
+            return {};
+        }
+
+        void on_last_ref(SockTable* s) {
+            auto t = static_cast<EpollTable*>(s);
+            auto ms = t->multishot.load(std::memory_order_acquire);
+            if (!ms) {
+                return;
+            }
+            std::lock_guard l{ms->lock};
+            // while armed, the last reference is held by multishot operation
+            if (!ms->armed || ms->canceling || t->refs != 1) {
+                return;
+            }
+            if (submit_cancel(get_ring(t), multishot_user_data(t, ms))) {
+                ms->canceling = true;
+            }
+        }
+
+        void destroy(EpollTable* t) {
+            auto ms = t->multishot.exchange(nullptr);
+            if (!ms) {
+                return;
+            }
+            for (auto& e : ms->queue) {
+                if (ms->is_accept) {
+                    if (e.res >= 0) {
+                        sockclose(e.res);
+                    }
+                }
+                else if (e.res > 0) {
+                    recycle_buffer(get_ring(t), e.bid);
+                }
+            }
+            delete_glheap(ms);
+        }
+
+        expected<AsyncResult> read_async(EpollTable* t, view::wvec buffer, void* c, stream_notify_t notify, std::uint32_t flag) {
+            auto& io = t->r;
+            return io.l.try_lock()  // lock released by call_read
+                .and_then([&](std::uint64_t cancel_code) -> expected<AsyncResult> {
+                    io.base = t;
+                    io.uring.iov.iov_base = buffer.data();
+                    io.uring.iov.iov_len = buffer.size();
+                    t->incr();  // increment, released by Socket passed to notify() or on_success()
+                    if (!get_ring(t)->multishot || flag != 0) {
+                        io.cb.set_notify(c, notify, call_read);
+                        return submit_single(t, io, cancel_code, false, [&](io_uring_sqe* sqe) {
+                            fill_recv(sqe, io, flag);
+                        });
+                    }
+                    auto ms = get_multishot(t, false);
+                    auto cancel = make_canceler(cancel_code, false, t);
+                    std::unique_lock l{ms->lock};
+                    if (!ms->queue.empty()) {
+                        auto res = pop_data(get_ring(t), ms, buffer);
+                        l.unlock();
+                        if (!res) {
+                            auto dec = t->decr();
+                            assert(dec != 0);
+                            io.l.unlock();
+                            return unexpect(res.error());
+                        }
+                        return on_success(t, cancel_code, false, *res);
+                    }
+                    io.cb.set_notify(c, notify, call_read);
+                    if (!ms->armed) {
+                        if (auto res = arm_multishot(t, ms); !res) {
+                            io.cb.call = nullptr;
+                            l.unlock();
+                            auto dec = t->decr();
+                            assert(dec != 0);
+                            io.l.unlock();
+                            return unexpect(res.error());
+                        }
+                    }
+                    ms->waiting = true;
+                    return AsyncResult{std::move(cancel), NotifyState::wait, 0};
+                });
+        }
+
+        expected<AsyncResult> write_async(EpollTable* t, view::rvec buffer, void* c, stream_notify_t notify, std::uint32_t flag) {
+            auto& io = t->w;
+            return io.l.try_lock()  // lock released by call_stream
+                .and_then([&](std::uint64_t cancel_code) -> expected<AsyncResult> {
+                    io.base = t;
+                    t->incr();  // increment, released by Socket passed to notify() or on_success()
+                    // most of writes complete immediately so try it before submission
+                    auto res = lazy::send_(t->sock, buffer.as_char(), buffer.size(), flag);
+                    if (res >= 0) {
+                        return on_success(t, cancel_code, true, res);
+                    }
+                    if (get_error() != EWOULDBLOCK && get_error() != EAGAIN) {
+                        auto dec = t->decr();
+                        assert(dec != 0);
+                        io.l.unlock();
+                        return unexpect(error::Errno());
+                    }
+                    io.cb.set_notify(c, notify, call_stream);
+                    return submit_single(t, io, cancel_code, true, [&](io_uring_sqe* sqe) {
+                        sqe->opcode = IORING_OP_SEND;
+                        sqe->addr = std::uint64_t(buffer.data());
+                        sqe->len = std::uint32_t(buffer.size());
+                        sqe->msg_flags = flag;
+                    });
+                });
+        }
+
+        expected<AsyncResult> readfrom_async(EpollTable* t, view::wvec buffer, NetAddrPort& addr, void* c, recvfrom_notify_t notify, std::uint32_t flag) {
+            auto& io = t->r;
+            return io.l.try_lock()  // lock released by call_recvmsg
+                .and_then([&](std::uint64_t cancel_code) -> expected<AsyncResult> {
+                    io.base = t;
+                    io.uring.iov.iov_base = buffer.data();
+                    io.uring.iov.iov_len = buffer.size();
+                    io.uring.msg = {};
+                    io.uring.msg.msg_name = &io.uring.addr;
+                    io.uring.msg.msg_namelen = sizeof(io.uring.addr);
+                    io.uring.msg.msg_iov = &io.uring.iov;
+                    io.uring.msg.msg_iovlen = 1;
+                    t->incr();  // increment, released by Socket passed to notify()
+                    io.cb.set_notify(c, notify, call_recvmsg);
+                    return submit_single(t, io, cancel_code, false, [&](io_uring_sqe* sqe) {
+                        sqe->opcode = IORING_OP_RECVMSG;
+                        sqe->addr = std::uint64_t(&io.uring.msg);
+                        sqe->len = 1;
+                        sqe->msg_flags = flag;
+                    });
+                });
+        }
+
+        expected<AsyncResult> writeto_async(EpollTable* t, view::rvec buffer, const NetAddrPort& addr, void* c, stream_notify_t notify, std::uint32_t flag) {
+            auto& io = t->w;
+            return io.l.try_lock()  // lock released by call_stream
+                .and_then([&](std::uint64_t cancel_code) -> expected<AsyncResult> {
+                    io.base = t;
+                    auto [ptr, len] = NetAddrPort_to_sockaddr(&io.uring.addr, addr);
+                    if (!ptr) {
+                        io.l.unlock();
+                        return unexpect(error::Error("unsupported address type", error::Category::lib, error::fnet_usage_error));
+                    }
+                    t->incr();  // increment, released by Socket passed to notify() or on_success()
+                    auto res = lazy::sendto_(t->sock, buffer.as_char(), buffer.size(), flag, ptr, len);
+                    if (res >= 0) {
+                        return on_success(t, cancel_code, true, res);
+                    }
+                    if (get_error() != EWOULDBLOCK && get_error() != EAGAIN) {
+                        auto dec = t->decr();
+                        assert(dec != 0);
+                        io.l.unlock();
+                        return unexpect(error::Errno());
+                    }
+                    io.uring.iov.iov_base = const_cast<byte*>(buffer.data());
+                    io.uring.iov.iov_len = buffer.size();
+                    io.uring.msg = {};
+                    io.uring.msg.msg_name = ptr;
+                    io.uring.msg.msg_namelen = len;
+                    io.uring.msg.msg_iov = &io.uring.iov;
+                    io.uring.msg.msg_iovlen = 1;
+                    io.cb.set_notify(c, notify, call_stream);
+                    return submit_single(t, io, cancel_code, true, [&](io_uring_sqe* sqe) {
+                        sqe->opcode = IORING_OP_SENDMSG;
+                        sqe->addr = std::uint64_t(&io.uring.msg);
+                        sqe->len = 1;
+                        sqe->msg_flags = flag;
+                    });
+                });
+        }
+
+        expected<AcceptAsyncResult<Socket>> accept_async(EpollTable* t, NetAddrPort& addr, void* c, accept_notify_t notify, std::uint32_t flag) {
+            auto& io = t->r;
+            auto r = io.l.try_lock()  // lock released by call_accept
+                         .and_then([&](std::uint64_t cancel_code) -> expected<AcceptAsyncResult<Socket>> {
+                             io.base = t;
+                             t->incr();  // increment, released by Socket passed to notify() or on_success()
+                             if (!get_ring(t)->multishot) {
+                                 io.uring.addr_len = sizeof(io.uring.addr);
+                                 io.cb.set_notify(c, notify, call_accept);
+                                 return submit_single(t, io, cancel_code, false, [&](io_uring_sqe* sqe) {
+                                            sqe->opcode = IORING_OP_ACCEPT;
+                                            sqe->addr = std::uint64_t(&io.uring.addr);
+                                            sqe->addr2 = std::uint64_t(&io.uring.addr_len);
+                                            sqe->accept_flags = SOCK_CLOEXEC | SOCK_NONBLOCK;
+                                        })
+                                     .transform([](AsyncResult&& r) {
+                                         return AcceptAsyncResult<Socket>{std::move(r.cancel), r.state};
+                                     });
+                             }
+                             auto ms = get_multishot(t, true);
+                             auto cancel = make_canceler(cancel_code, false, t);
+                             std::unique_lock l{ms->lock};
+                             if (!ms->queue.empty()) {
+                                 auto res = ms->queue.front().res;
+                                 ms->queue.pop_front();
+                                 l.unlock();
+                                 on_success(t, cancel_code, false, 0);
+                                 auto peer = res >= 0 ? peer_addr(res) : NetAddrPort();
+                                 auto accepted = setup_accepted(t, res, std::move(peer));
+                                 if (!accepted) {
+                                     return unexpect(accepted.error());
+                                 }
+                                 addr = std::move(accepted->second);
+                                 return AcceptAsyncResult<Socket>{Canceler(), NotifyState::done, std::move(accepted->first)};
+                             }
+                             io.cb.set_notify(c, notify, call_accept);
+                             if (!ms->armed) {
+                                 if (auto res = arm_multishot(t, ms); !res) {
+                                     io.cb.call = nullptr;
+                                     l.unlock();
+                                     auto dec = t->decr();
+                                     assert(dec != 0);
+                                     io.l.unlock();
+                                     return unexpect(res.error());
+                                 }
+                             }
+                             ms->waiting = true;
+                             return AcceptAsyncResult<Socket>{std::move(cancel), NotifyState::wait};
+                         });
+            return r;
+        }
+
+        expected<AsyncResult> connect_async(EpollTable* t, const NetAddrPort& addr, void* c, stream_notify_t notify, std::uint32_t flag) {
+            auto& io = t->w;
+            return io.l.try_lock()  // lock released by call_connect
+                .and_then([&](std::uint64_t cancel_code) -> expected<AsyncResult> {
+                    io.base = t;
+                    auto [ptr, len] = NetAddrPort_to_sockaddr(&io.uring.addr, addr);
+                    if (!ptr) {
+                        io.l.unlock();
+                        return unexpect(error::Error("unsupported address type", error::Category::lib, error::fnet_usage_error));
+                    }
+                    t->incr();  // increment, released by Socket passed to notify()
+                    io.cb.set_notify(c, notify, call_connect);
+                    return submit_single(t, io, cancel_code, true, [&](io_uring_sqe* sqe) {
+                        sqe->opcode = IORING_OP_CONNECT;
+                        sqe->addr = std::uint64_t(ptr);
+                        sqe->off = std::uint64_t(len);
+                    });
+                });
+        }
+    }  // namespace uring
+}  // namespace futils::fnet
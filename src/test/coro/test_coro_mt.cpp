@@ -0,0 +1,103 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <coro/coro.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <thread>
+
+constexpr size_t task_count = 200;
+constexpr size_t step_count = 10;
+
+std::atomic_size_t steps = 0;
+
+// simulates blocking I/O between suspends
+void io_task(futils::coro::C* c, void*) {
+    for (size_t i = 0; i < step_count; i++) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        steps++;
+        c->suspend();
+    }
+}
+
+std::chrono::milliseconds bench(futils::coro::C& c) {
+    steps = 0;
+    futils::test::Timer t;
+    for (size_t i = 0; i < task_count;) {
+        while (i < task_count && c.add_coroutine(nullptr, io_task)) {
+            i++;
+        }
+        c.run();
+    }
+    while (c.run()) {
+    }
+    auto d = t.next_step<std::chrono::milliseconds>();
+    assert(steps == task_count * step_count);
+    return d;
+}
+
+void test_thread_context() {
+    auto c = futils::coro::make_coro_mt(4, 4, 4);
+    int shared = 0;
+    c.set_thread_context(&shared);
+    std::atomic_size_t ok = 0;
+    for (size_t i = 0; i < 8; i++) {
+        c.add_coroutine(&ok, +[](futils::coro::C* c, std::atomic_size_t* ok) {
+            thread_local int local = 0;
+            // context set on non-worker thread is visible until worker sets own
+            auto prev = c->get_thread_context();
+            assert(prev != nullptr);
+            if (prev != &local) {
+                c->set_thread_context(&local);
+            }
+            c->suspend();
+            (*ok)++;
+        });
+    }
+    while (c.run()) {
+    }
+    assert(ok == 8);
+    assert(c.get_thread_context() == &shared);
+}
+
+void test_nest() {
+    auto c = futils::coro::make_coro_mt(3);
+    std::atomic_size_t count = 0;
+    c.add_coroutine(&count, +[](futils::coro::C* c, std::atomic_size_t* count) {
+        for (auto i = 0; i < 5; i++) {
+            while (!c->add_coroutine(count, +[](futils::coro::C* c, std::atomic_size_t* count) {
+                c->suspend();
+                (*count)++;
+            })) {
+                c->suspend();
+            }
+        }
+        (*count)++;
+    });
+    while (c.run()) {
+    }
+    assert(count == 6);
+}
+
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    test_thread_context();
+    test_nest();
+    const size_t max_thread = argc > 1 ? std::stoull(argv[1]) : 8;
+    {
+        auto c = futils::coro::make_coro(10, 10);
+        cout << "make_coro: " << bench(c).count() << "ms\n";
+    }
+    for (size_t n = 1; n <= max_thread; n *= 2) {
+        auto c = futils::coro::make_coro_mt(n, 10, 10);
+        cout << "make_coro_mt(" << n << "): " << bench(c).count() << "ms\n";
+    }
+}
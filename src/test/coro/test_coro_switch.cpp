@@ -0,0 +1,102 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <coro/coro.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <cassert>
+#include <ucontext.h>
+#include <sys/mman.h>
+
+constexpr size_t switch_count = 1000000;
+constexpr size_t create_count = 100000;
+
+// reference: raw swapcontext ping-pong (previous implementation of coro_linux.cpp)
+ucontext_t main_ctx, sub_ctx;
+
+void ucontext_sub() {
+    while (true) {
+        swapcontext(&sub_ctx, &main_ctx);
+    }
+}
+
+double ucontext_switch_per_sec() {
+    auto stack = ::mmap(nullptr, 8192, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    getcontext(&sub_ctx);
+    sub_ctx.uc_stack.ss_sp = stack;
+    sub_ctx.uc_stack.ss_size = 8192;
+    sub_ctx.uc_link = nullptr;
+    makecontext(&sub_ctx, ucontext_sub, 0);
+    futils::test::Timer t;
+    for (size_t i = 0; i < switch_count / 2; i++) {
+        swapcontext(&main_ctx, &sub_ctx);
+    }
+    auto d = t.next_step<std::chrono::nanoseconds>();
+    ::munmap(stack, 8192);
+    return switch_count / (d.count() / 1e9);
+}
+
+// reference: mmap + mprotect + munmap for each stack
+double mmap_stack_per_sec() {
+    futils::test::Timer t;
+    for (size_t i = 0; i < create_count; i++) {
+        auto p = ::mmap(nullptr, 12288, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+        ::mprotect(p, 4096, PROT_NONE);
+        static_cast<char*>(p)[12287] = 0;  // touch
+        ::munmap(p, 12288);
+    }
+    auto d = t.next_step<std::chrono::nanoseconds>();
+    return create_count / (d.count() / 1e9);
+}
+
+double coro_switch_per_sec() {
+    auto c = futils::coro::make_coro();
+    size_t count = 0;
+    auto fn = [](futils::coro::C* c, size_t* count) {
+        for (size_t i = 0; i < switch_count / 2; i++) {
+            (*count)++;
+            c->suspend();
+        }
+    };
+    c.add_coroutine(&count, +fn);
+    c.add_coroutine(&count, +fn);
+    futils::test::Timer t;
+    while (c.run()) {
+    }
+    auto d = t.next_step<std::chrono::nanoseconds>();
+    assert(count == switch_count);
+    return switch_count / (d.count() / 1e9);
+}
+
+double coro_create_per_sec() {
+    auto c = futils::coro::make_coro(10, 10);
+    size_t done = 0;
+    auto fn = [](futils::coro::C*, size_t* done) {
+        (*done)++;
+    };
+    futils::test::Timer t;
+    for (size_t i = 0; i < create_count;) {
+        while (i < create_count && c.add_coroutine(&done, +fn)) {
+            i++;
+        }
+        while (c.run()) {
+        }
+    }
+    auto d = t.next_step<std::chrono::nanoseconds>();
+    assert(done == create_count);
+    return create_count / (d.count() / 1e9);
+}
+
+int main() {
+    auto& cout = futils::wrap::cout_wrap();
+    cout << "switch/sec\n";
+    cout << "  swapcontext: " << std::uint64_t(ucontext_switch_per_sec()) << "\n";
+    cout << "  futils::coro: " << std::uint64_t(coro_switch_per_sec()) << "\n";
+    cout << "create/sec\n";
+    cout << "  mmap stack per coroutine: " << std::uint64_t(mmap_stack_per_sec()) << "\n";
+    cout << "  futils::coro (add_coroutine + run): " << std::uint64_t(coro_create_per_sec()) << "\n";
+}
@@ -0,0 +1,109 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <file/dir_walk.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <atomic>
+#include <cassert>
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// per file open + stat on single thread
+void naive_walk(const fs::path& dir, size_t& files, size_t& bytes) {
+    for (auto& ent : fs::directory_iterator(dir)) {
+        auto f = futils::file::File::open(ent.path().c_str());
+        if (!f) {
+            continue;
+        }
+        auto s = f->stat();
+        if (!s) {
+            continue;
+        }
+        if (s->mode.directory()) {
+            naive_walk(ent.path(), files, bytes);
+        }
+        else {
+            files++;
+            bytes += s->size;
+        }
+    }
+}
+
+void make_tree(const fs::path& root, size_t width, size_t depth, size_t files) {
+    fs::create_directories(root);
+    for (size_t i = 0; i < files; i++) {
+        auto f = futils::file::File::create((root / ("f" + std::to_string(i))).c_str()).value();
+        f.write_file_all(futils::view::rvec("hello")).value();
+    }
+    if (depth == 0) {
+        return;
+    }
+    for (size_t i = 0; i < width; i++) {
+        make_tree(root / ("d" + std::to_string(i)), width, depth - 1, files);
+    }
+}
+
+// usage: dir_walk [root (default: generated tree)] [threads]
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    fs::path root = "./dir_walk_bench";
+    bool generated = false;
+    if (argc > 1) {
+        root = argv[1];
+    }
+    else {
+        fs::remove_all(root);
+        make_tree(root, 8, 3, 20);
+        generated = true;
+    }
+    futils::file::WalkOption opt;
+    opt.threads = argc > 2 ? std::stoull(argv[2]) : 0;
+    futils::test::Timer t;
+    size_t naive_files = 0, naive_bytes = 0;
+    naive_walk(root, naive_files, naive_bytes);
+    auto naive_time = t.next_step<std::chrono::microseconds>();
+
+    std::atomic_size_t files = 0, bytes = 0;
+    opt.stat = true;
+    auto res = futils::file::walk_directory(root.string(), opt, [&](const futils::file::DirEntry& e) {
+        if (e.type != futils::file::FileType::directory) {
+            files++;
+            bytes += e.stat->size;
+        }
+    });
+    auto walk_time = t.next_step<std::chrono::microseconds>();
+    assert(res && "walk failed");
+    assert(files == naive_files && bytes == naive_bytes && "result mismatch");
+
+    // d_type only and filter out d1 subtree
+    std::atomic_size_t filtered = 0;
+    opt.stat = false;
+    res = futils::file::walk_directory(
+        root.string(), opt,
+        [](const futils::file::DirEntry& e) {
+            return !(e.depth == 0 && std::string_view(e.name.data(), e.name.size()) == "d1");
+        },
+        [&](const futils::file::DirEntry& e) {
+            assert(e.stat == nullptr);
+            if (e.type != futils::file::FileType::directory) {
+                filtered++;
+            }
+        });
+    auto dtype_time = t.next_step<std::chrono::microseconds>();
+    assert(res && "walk failed");
+    if (generated) {
+        assert(filtered < files && "filter not applied");
+        fs::remove_all(root);
+    }
+    cout << "files: " << files.load() << "\n";
+    cout << "naive open+stat walk: " << naive_time.count() << "us\n";
+    cout << "walk_directory (stat): " << walk_time.count() << "us\n";
+    cout << "walk_directory (d_type, filtered): " << dtype_time.count() << "us\n";
+}
@@ -0,0 +1,44 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <file/file.h>
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+int main() {
+    constexpr auto path = "./file_vec_test.txt";
+    std::string_view pieces[] = {"GET ", "/index.html", " HTTP/1.1\r\n", "", "Host: example.com\r\n\r\n"};
+    futils::view::rvec vec[5];
+    std::string expect;
+    for (size_t i = 0; i < 5; i++) {
+        vec[i] = futils::view::rvec(pieces[i]);
+        expect.append(pieces[i]);
+    }
+    {
+        auto f = futils::file::File::create(std::string_view(path)).value();
+        f.write_vec_all(vec, 5).value();
+        // overwrite head without moving file position
+        futils::view::rvec post[] = {futils::view::rvec("PO"), futils::view::rvec("ST")};
+        f.write_vec_at_all(post, 2, 0).value();
+    }
+    expect.replace(0, 4, "POST");
+    auto f = futils::file::File::open(std::string_view(path)).value();
+    assert(f.size() == expect.size());
+    std::string head(4, 0), rest(expect.size() - 4, 0);
+    futils::view::wvec rvec[] = {futils::view::wvec(head.data(), head.size()), futils::view::wvec(rest.data(), rest.size())};
+    auto n = f.read_vec(rvec, 2).value();
+    assert(n == expect.size());
+    assert(head + rest == expect);
+    std::string tail(6, 0);
+    futils::view::wvec tvec[] = {futils::view::wvec(tail.data(), 2), futils::view::wvec(tail.data() + 2, 4)};
+    n = f.read_vec_at(tvec, 2, expect.size() - 6).value();
+    assert(n == 6 && tail == expect.substr(expect.size() - 6));
+    f.close();
+    std::remove(path);
+}
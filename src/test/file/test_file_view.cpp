@@ -27,6 +27,22 @@ void test_file_view() {
     assert(view.match("\r\n") && "expect to open on binary mode but not");
 }
 
+void test_window_view() {
+    futils::file::View file;
+    file.open("src/test/file/test.txt", futils::file::MMapOption{.advice = futils::file::MMapAdvice::sequential}).value();
+    assert(file.prefetch(0, file.size()) && "prefetch failed");
+    futils::file::WindowView window;
+    // minimum window size is used
+    window.open("src/test/file/test.txt", 1).value();
+    assert(window.size() == file.size() && "size mismatch");
+    for (size_t i = 0; i < file.size(); i++) {
+        assert(window[i] == file[i] && "content mismatch");
+    }
+    futils::Sequencer<futils::file::WindowView&> seq(window);
+    assert(seq.seek_if(u8"𠮷野家") && "file seek failed");
+}
+
 int main() {
     test_file_view();
+    test_window_view();
 }
@@ -0,0 +1,101 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <file/line_scan.h>
+#include <file/file_view.h>
+#include <strutil/per_line.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <cassert>
+#include <string>
+#include <string_view>
+#include <cstdlib>
+#include <cstdio>
+#include <filesystem>
+
+struct Count {
+    size_t lines = 0;
+    size_t bytes = 0;
+};
+
+void merge(Count& acc, Count&& c) {
+    acc.lines += c.lines;
+    acc.bytes += c.bytes;
+}
+
+void test_split() {
+    std::string_view text = "a\nbb\r\nccc\n\ndddd";
+    auto data = futils::view::rvec(text);
+    for (size_t n = 1; n < 10; n++) {
+        auto chunks = futils::file::split_line_chunks(data, n);
+        size_t total = 0;
+        for (auto& c : chunks) {
+            total += c.size();
+        }
+        assert(total == data.size() && "chunks must cover data");
+        auto count = futils::file::scan_lines<Count>(
+            data, n, [](Count& c, futils::view::rvec line) {
+                c.lines++;
+                c.bytes += line.size();
+            },
+            merge);
+        assert(count.lines == 5 && count.bytes == 10 && "unexpected line count");
+    }
+}
+
+// usage: line_scan [size in MiB (default 64)] [threads (default hardware_concurrency)]
+// benchmark file is created in temporary directory and removed after run
+int main(int argc, char** argv) {
+    test_split();
+    auto& cout = futils::wrap::cout_wrap();
+    size_t mib = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 0;
+    const auto path = (std::filesystem::temp_directory_path() / "futils_line_scan_bench.txt").string();
+    {
+        auto f = futils::file::File::create(std::string_view(path)).value();
+        std::string block;
+        for (size_t i = 0; block.size() < 1024 * 1024; i++) {
+            block.append("line ");
+            block.append(std::to_string(i));
+            block.append(i % 3 ? " some log text here\n" : " x\r\n");
+        }
+        for (size_t i = 0; i < mib; i++) {
+            f.write_file_all(futils::view::rvec(block)).value();
+        }
+    }
+    futils::test::Timer t;
+    Count single;
+    {
+        futils::file::View view;
+        view.open(path, futils::file::MMapOption{.advice = futils::file::MMapAdvice::sequential}).value();
+        t.reset();
+        futils::strutil::per_line(
+            std::string_view(reinterpret_cast<const char*>(view.data()), view.size()),
+            [&](std::string_view line) {
+                single.lines++;
+                single.bytes += line.size();
+            },
+            [] {});
+    }
+    auto single_time = t.next_step();
+    auto f = futils::file::File::open(path).value();
+    t.reset();
+    auto parallel = futils::file::scan_file_lines<Count>(
+                        f, threads, [](Count& c, futils::view::rvec line) {
+                            c.lines++;
+                            c.bytes += line.size();
+                        },
+                        merge)
+                        .value();
+    auto parallel_time = t.next_step();
+    assert(single.lines == parallel.lines && single.bytes == parallel.bytes && "result mismatch");
+    cout << "size: " << mib << "MiB lines: " << parallel.lines << "\n";
+    cout << "per_line (1 thread): " << single_time.count() << "ms\n";
+    cout << "scan_file_lines: " << parallel_time.count() << "ms\n";
+    f.close();
+    std::remove(path.c_str());
+}
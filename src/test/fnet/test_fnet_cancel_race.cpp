@@ -0,0 +1,160 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <fnet/socket.h>
+#include <fnet/addrinfo.h>
+#include <fnet/event/io.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <atomic>
+#include <cassert>
+#include <string>
+#include <thread>
+
+namespace fnet = futils::fnet;
+namespace view = futils::view;
+
+// stress test for cancel racing with completion
+// writer thread makes socket readable while main thread cancels pending read
+// and event thread dispatches completion, so exactly one of them must call back
+
+fnet::Socket make_tcp(fnet::event::IOEvent* event) {
+    auto s = fnet::make_socket(fnet::sockattr_tcp(fnet::ip::Version::ipv6), event).value();
+    s.set_ipv6only(false).value();
+    s.set_nodelay(true).value();
+    return s;
+}
+
+struct ReadState {
+    futils::byte buf[64];
+    std::atomic_uint32_t called = 0;
+    size_t bytes = 0;
+    bool canceled = false;
+};
+
+void on_read(fnet::Socket&& sock, void* c, fnet::NotifyResult&& r) {
+    auto st = static_cast<ReadState*>(c);
+    auto res = r.read_unwrap(view::wvec(st->buf, sizeof(st->buf)), [&](view::wvec w) {
+        return sock.read(w);
+    });
+    if (res) {
+        st->bytes = res->size();
+    }
+    else {
+        st->canceled = !fnet::isSysBlock(res.error());
+    }
+    auto prev = st->called.fetch_add(1);
+    assert(prev == 0 && "callback called twice");
+    st->called.notify_all();
+}
+
+struct Result {
+    size_t cancel_won = 0, completion_won = 0, sync_done = 0;
+};
+
+Result run(fnet::event::IOEvent* event, size_t rounds) {
+    auto listener = make_tcp(event);
+    listener.set_reuse_addr(true).value();
+    listener.bind(fnet::to_ipv6("::ffff:127.0.0.1", 0, true).value()).value();
+    listener.listen().value();
+    auto client = make_tcp(event);
+    auto c = client.connect(listener.get_local_addr().value());
+    assert(c || fnet::isSysBlock(c.error()));
+    listener.wait_readable(1, 0);
+    auto server = listener.accept().value().first;
+    client.wait_writable(1, 0);
+
+    std::atomic_bool stop = false;
+    std::thread loop([&] {
+        while (!stop) {
+            event->wait(1).value();
+        }
+    });
+    std::atomic_size_t epoch = 0;
+    std::thread writer([&] {
+        for (size_t i = 1; i <= rounds; i++) {
+            epoch.wait(i - 1);
+            futils::byte b = futils::byte(i);
+            client.write(view::rvec(&b, 1)).value();
+        }
+    });
+
+    Result result;
+    size_t total = 0;
+    for (size_t i = 0; i < rounds; i++) {
+        ReadState st;
+        auto r = server.read_async(view::wvec(st.buf, sizeof(st.buf)), &st, on_read);
+        assert(r && "read_async failed");
+        epoch.store(i + 1);
+        epoch.notify_one();
+        if (r->state == fnet::NotifyState::done) {
+            // data of canceled round remains
+            total += r->processed_bytes;
+            result.sync_done++;
+            continue;
+        }
+        // vary timing so that both sides win sometimes
+        for (size_t y = 0; y < i % 4; y++) {
+            std::this_thread::yield();
+        }
+        r->cancel.cancel();  // either cancel or completion wins
+        st.called.wait(0);
+        if (st.canceled) {
+            result.cancel_won++;
+        }
+        else {
+            total += st.bytes;
+            result.completion_won++;
+        }
+    }
+    writer.join();
+    futils::byte buf[64];
+    while (total < rounds) {
+        auto r = server.read(buf);
+        if (!r) {
+            assert(fnet::isSysBlock(r.error()));
+            server.wait_readable(0, 1000);  // io_uring backend may have data in queue
+            continue;
+        }
+        total += r->size();
+    }
+    assert(total == rounds);
+    stop = true;
+    loop.join();
+    return result;
+}
+
+// notify wakes up wait without calling completion handler
+// even if it is called before wait
+void test_notify(fnet::event::IOBackend backend) {
+    auto event = fnet::event::make_io_event([](void*, void*) { assert(false && "notify must not call handler"); }, nullptr, backend).value();
+    futils::test::Timer t;
+    event.notify().value();
+    event.wait(10000).value();
+    std::thread notifier([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        event.notify().value();
+    });
+    event.wait(10000).value();
+    notifier.join();
+    assert(t.next_step<std::chrono::milliseconds>().count() < 5000 && "wait is not woken up by notify");
+}
+
+// usage: fnet_cancel_race [rounds]
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    const size_t rounds = argc > 1 ? std::stoull(argv[1]) : 20000;
+    for (auto backend : {fnet::event::IOBackend::platform_default, fnet::event::IOBackend::io_uring}) {
+        test_notify(backend);
+        auto event = fnet::event::make_io_event(fnet::event::fnet_handle_completion, nullptr, backend).value();
+        futils::test::Timer t;
+        auto res = run(&event, rounds);
+        auto time = t.next_step<std::chrono::microseconds>();
+        cout << (event.backend() == fnet::event::IOBackend::io_uring ? "io_uring" : "epoll") << " " << rounds << " rounds " << time.count() << "us\n";
+        cout << "  cancel won: " << res.cancel_won << " completion won: " << res.completion_won << " completed synchronously: " << res.sync_done << "\n";
+    }
+}
@@ -0,0 +1,198 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <fnet/awaitable.h>
+#include <fnet/addrinfo.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace fnet = futils::fnet;
+namespace view = futils::view;
+
+std::atomic_size_t glheap_calls = 0;
+
+void* count_alloc(void*, size_t size, size_t, fnet::DebugInfo*) {
+    glheap_calls++;
+    return std::malloc(size);
+}
+
+void* count_realloc(void*, void* p, size_t size, size_t, fnet::DebugInfo*) {
+    glheap_calls++;
+    return std::realloc(p, size);
+}
+
+void count_free(void*, void* p, fnet::DebugInfo*) {
+    std::free(p);
+}
+
+constexpr size_t msg_size = 64, buf_size = 4096;
+
+fnet::Socket make_tcp(fnet::event::IOEvent* event) {
+    auto s = fnet::make_socket(fnet::sockattr_tcp(fnet::ip::Version::ipv6), event).value();
+    s.set_ipv6only(false).value();
+    s.set_nodelay(true).value();
+    return s;
+}
+
+// coroutine style server
+fnet::Task<> coro_echo(fnet::Socket sock) {
+    futils::byte buf[buf_size];
+    while (true) {
+        auto r = co_await fnet::async_read(sock, buf);
+        if (!r) {
+            co_return;  // eof or error
+        }
+        if (!co_await fnet::async_write(sock, *r)) {
+            co_return;
+        }
+    }
+}
+
+fnet::Task<> coro_accept(fnet::Socket& listener, size_t conns) {
+    for (size_t i = 0; i < conns; i++) {
+        auto a = co_await fnet::async_accept(listener);
+        assert(a && "accept failed");
+        a->first.set_nodelay(true).value();
+        fnet::spawn(coro_echo(std::move(a->first)));
+    }
+}
+
+// callback style server
+struct CallbackConn {
+    futils::byte buf[buf_size];
+};
+
+void callback_echo(fnet::Socket&& sock, std::shared_ptr<CallbackConn> conn);
+
+void callback_write(fnet::Socket&& sock, view::rvec data, std::shared_ptr<CallbackConn> conn) {
+    sock.write_async(fnet::async_then(
+        fnet::BufferManager<view::rvec>(data),
+        [conn](fnet::Socket&& sock, fnet::BufferManager<view::rvec>& buf, fnet::NotifyResult&& r) {
+            auto res = r.write_unwrap(buf.get_buffer(), [&](view::rvec w) {
+                return sock.write(w);
+            });
+            if (!res && !fnet::isSysBlock(res.error())) {
+                return;
+            }
+            auto remain = res ? *res : buf.get_buffer();
+            if (remain.size()) {
+                callback_write(std::move(sock), remain, std::move(conn));
+                return;
+            }
+            callback_echo(std::move(sock), std::move(conn));
+        }));
+}
+
+void callback_echo(fnet::Socket&& sock, std::shared_ptr<CallbackConn> conn) {
+    auto buf = view::wvec(conn->buf, buf_size);
+    sock.read_async(fnet::async_then(
+        fnet::BufferManager<view::wvec>(buf),
+        [conn](fnet::Socket&& sock, fnet::BufferManager<view::wvec>& buf, fnet::NotifyResult&& r) {
+            auto res = r.read_unwrap(buf.get_buffer(), [&](view::wvec w) {
+                return sock.read(w);
+            });
+            if (!res) {
+                if (fnet::isSysBlock(res.error())) {
+                    callback_echo(std::move(sock), conn);
+                }
+                return;
+            }
+            if (res->empty()) {
+                return;  // eof
+            }
+            callback_write(std::move(sock), *res, std::move(conn));
+        }));
+}
+
+void callback_accept(fnet::Socket& listener, size_t conns) {
+    if (conns == 0) {
+        return;
+    }
+    listener.accept_async(fnet::async_accept_then([=](fnet::Socket&& listener, fnet::Socket&& accepted, fnet::NetAddrPort&&, fnet::NotifyResult&& r) {
+                assert(accepted && "accept failed");
+                accepted.set_nodelay(true).value();
+                callback_echo(std::move(accepted), std::make_shared<CallbackConn>());
+                callback_accept(listener, conns - 1);
+            }))
+        .value();
+}
+
+// client is same for both
+fnet::Task<> client(fnet::event::IOEvent* event, const fnet::NetAddrPort& addr, size_t round_trip, std::atomic_size_t& done) {
+    auto sock = make_tcp(event);
+    auto c = co_await fnet::async_connect(sock, addr);
+    assert(c && "connect failed");
+    futils::byte msg[msg_size], buf[msg_size];
+    for (size_t i = 0; i < msg_size; i++) {
+        msg[i] = futils::byte(i);
+    }
+    for (size_t i = 0; i < round_trip; i++) {
+        auto w = co_await fnet::async_write(sock, view::rvec(msg, msg_size));
+        assert(w && "write failed");
+        size_t recv = 0;
+        while (recv < msg_size) {
+            auto r = co_await fnet::async_read(sock, view::wvec(buf + recv, msg_size - recv));
+            assert(r && "read failed");
+            recv += r->size();
+        }
+        assert(view::rvec(buf, msg_size) == view::rvec(msg, msg_size));
+    }
+    done++;
+}
+
+auto run(fnet::event::IOEvent* event, bool coro, size_t conns, size_t round_trip) {
+    auto listener = make_tcp(event);
+    listener.set_reuse_addr(true).value();
+    listener.bind(fnet::to_ipv6("::ffff:127.0.0.1", 0, true).value()).value();
+    listener.listen(int(conns)).value();
+    auto addr = listener.get_local_addr().value();
+    glheap_calls = 0;
+    futils::test::Timer t;
+    std::atomic_size_t done = 0;
+    auto acceptor = coro ? coro_accept(listener, conns) : fnet::Task<>{};
+    if (coro) {
+        fnet::spawn(std::move(acceptor));
+    }
+    else {
+        callback_accept(listener, conns);
+    }
+    for (size_t i = 0; i < conns; i++) {
+        fnet::spawn(client(event, addr, round_trip, done));
+    }
+    while (done < conns) {
+        event->wait(1000).value();
+    }
+    return std::make_pair(t.next_step<std::chrono::microseconds>(), glheap_calls.load());
+}
+
+// usage: fnet_coro_echo [connections] [round trips per connection]
+int main(int argc, char** argv) {
+    fnet::set_normal_allocs(fnet::Allocs{
+        .alloc_ptr = count_alloc,
+        .realloc_ptr = count_realloc,
+        .free_ptr = count_free,
+    });
+    auto& cout = futils::wrap::cout_wrap();
+    const size_t conns = argc > 1 ? std::stoull(argv[1]) : 32;
+    const size_t round_trip = argc > 2 ? std::stoull(argv[2]) : 2000;
+    const auto total = conns * round_trip;
+    cout << "echo " << conns << " connections x " << round_trip << " round trips\n";
+    // io_uring falls back to epoll if it is not available
+    for (auto backend : {fnet::event::IOBackend::platform_default, fnet::event::IOBackend::io_uring}) {
+        auto event = fnet::event::make_io_event(fnet::event::fnet_handle_completion, nullptr, backend).value();
+        auto [cb_time, cb_alloc] = run(&event, false, conns, round_trip);
+        auto [co_time, co_alloc] = run(&event, true, conns, round_trip);
+        cout << (event.backend() == fnet::event::IOBackend::io_uring ? "io_uring" : "epoll") << "\n";
+        cout << "  callback:  " << cb_time.count() << "us (" << cb_time.count() * 1000 / total << "ns/rt) glheap allocs: " << cb_alloc << "\n";
+        cout << "  coroutine: " << co_time.count() << "us (" << co_time.count() * 1000 / total << "ns/rt) glheap allocs: " << co_alloc << "\n";
+    }
+}
@@ -0,0 +1,175 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <fnet/socket.h>
+#include <fnet/addrinfo.h>
+#include <fnet/gso.h>
+#include <fnet/event/io.h>
+#include <fnet/plthead.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fnet = futils::fnet;
+namespace view = futils::view;
+namespace gso = fnet::gso;
+
+constexpr size_t batch = 32, packet_size = 1200, slot_size = 65536;
+
+void test_cmsg() {
+    futils::byte buf[gso::segment_cmsg_space];
+    auto control = gso::encode_segment_size(buf, 1200);
+    assert(control.size() == gso::segment_cmsg_space);
+    assert(gso::find_segment_size(control) == 1200);
+    assert(!gso::find_gro_size(control));
+    size_t n = 0, total = 0;
+    futils::byte data[2500];
+    gso::split_segments(view::rvec(data, 2500), 1000, [&](view::rvec seg) {
+        assert(seg.size() == (n < 2 ? 1000 : 500));
+        n++;
+        total += seg.size();
+    });
+    assert(n == 3 && total == 2500);
+}
+
+fnet::Socket make_udp() {
+    auto s = fnet::make_socket(fnet::sockattr_udp(fnet::ip::Version::ipv4)).value();
+    s.bind(fnet::to_ipv4("127.0.0.1", 0).value()).value();
+    s.set_recv_buffer_size(4 << 20);
+    return s;
+}
+
+struct Bench {
+    fnet::Socket sender = make_udp();
+    fnet::Socket receiver = make_udp();
+    fnet::NetAddrPort to = receiver.get_local_addr().value();
+    std::vector<futils::byte> send_buf = std::vector<futils::byte>(batch * packet_size);
+    std::unique_ptr<futils::byte[]> recv_buf = std::make_unique<futils::byte[]>(batch * slot_size);
+    futils::byte control[batch][64];
+    futils::byte send_control[gso::segment_cmsg_space];
+    size_t coalesced = 0;
+
+    void fill(size_t round) {
+        for (size_t i = 0; i < batch; i++) {
+            send_buf[i * packet_size] = futils::byte(round + i);
+        }
+    }
+
+    void send(size_t round, bool use_gso) {
+        fill(round);
+        fnet::Datagram<view::rvec> out[batch];
+        size_t n = 0;
+        if (use_gso) {
+            out[n++] = {view::rvec(send_buf), to, gso::encode_segment_size(send_control, packet_size)};
+        }
+        else {
+            for (size_t i = 0; i < batch; i++) {
+                out[n++] = {view::rvec(send_buf).substr(i * packet_size, packet_size), to};
+            }
+        }
+        auto res = sender.writeto_many(view::rspan<fnet::Datagram<view::rvec>>(out, n));
+        assert(res && *res == n);
+    }
+
+    void recv(size_t round) {
+        size_t got = 0;
+        fnet::Datagram<view::wvec> in[batch];
+        while (got < batch) {
+            for (size_t i = 0; i < batch; i++) {
+                in[i].data = view::wvec(recv_buf.get() + i * slot_size, slot_size);
+                in[i].control = view::wvec(control[i], 64);
+            }
+            auto res = receiver.readfrom_many(view::wspan<fnet::Datagram<view::wvec>>(in, batch - got));
+            if (!res) {
+                assert(fnet::isSysBlock(res.error()));
+                receiver.wait_readable(1, 0);
+                continue;
+            }
+            for (size_t i = 0; i < *res; i++) {
+                auto seg = gso::find_gro_size(in[i].control);
+                if (seg) {
+                    coalesced++;
+                }
+                gso::split_segments(in[i].data, seg.value_or(0), [&](view::wvec packet) {
+                    assert(packet.size() == packet_size);
+                    assert(packet[0] == futils::byte(round + got));
+                    got++;
+                });
+            }
+        }
+        assert(got == batch);
+    }
+};
+
+// same as receive path of quic server
+// async read peeks for readiness and readfrom_many receives coalesced datagram with UDP_GRO
+// datagram received by async read itself has no control message on both backends
+void test_async_gro(fnet::event::IOBackend backend) {
+    auto& cout = futils::wrap::cout_wrap();
+    auto event = fnet::event::make_io_event(fnet::event::fnet_handle_completion, nullptr, backend).value();
+    cout << "async GRO receive (" << (event.backend() == fnet::event::IOBackend::io_uring ? "io_uring" : "epoll") << "): ";
+    Bench b;
+    b.receiver = fnet::make_socket(fnet::sockattr_udp(fnet::ip::Version::ipv4), &event).value();
+    b.receiver.bind(fnet::to_ipv4("127.0.0.1", 0).value()).value();
+    b.to = b.receiver.get_local_addr().value();
+    if (!b.receiver.set_gro(true)) {
+        cout << "GRO is not supported\n";
+        return;
+    }
+    bool done = false;
+    // arm before send so that completion (not immediate read) is tested
+    auto res = b.receiver.readfrom_async(fnet::async_addr_then(fnet::BufferManager<futils::byte[1]>{}, [&](fnet::Socket&& sock, auto&, fnet::NetAddrPort&&, fnet::NotifyResult&& r) {
+                                             assert(r.value());
+                                             b.receiver = std::move(sock);
+                                             b.recv(0);
+                                             done = true;
+                                         }),
+                                         false, MSG_PEEK);
+    assert(res);
+    b.send(0, true);
+    while (!done) {
+        event.wait(100);
+    }
+    assert(b.coalesced == 1);
+    cout << "ok\n";
+}
+
+// usage: fnet_gso [rounds]
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    test_cmsg();
+    for (auto backend : {fnet::event::IOBackend::platform_default, fnet::event::IOBackend::io_uring}) {
+        test_async_gro(backend);
+    }
+    const size_t rounds = argc > 1 ? std::stoull(argv[1]) : 20000;
+    const auto packets = rounds * batch;
+
+    Bench plain;
+    futils::test::Timer t;
+    for (size_t r = 0; r < rounds; r++) {
+        plain.send(r, false);
+        plain.recv(r);
+    }
+    auto plain_time = t.next_step<std::chrono::microseconds>();
+    cout << "loopback udp " << packets << " packets x " << packet_size << " bytes\n";
+    cout << "  sendmmsg/recvmmsg:       " << plain_time.count() << "us (" << packets * 1000000 / (plain_time.count() + 1) << " packets/s)\n";
+
+    Bench offload;
+    if (!offload.receiver.set_gro(true)) {
+        cout << "  GRO is not supported\n";
+    }
+    t.next_step<std::chrono::microseconds>();
+    for (size_t r = 0; r < rounds; r++) {
+        offload.send(r, true);
+        offload.recv(r);
+    }
+    auto gso_time = t.next_step<std::chrono::microseconds>();
+    cout << "  GSO/GRO:                 " << gso_time.count() << "us (" << packets * 1000000 / (gso_time.count() + 1) << " packets/s) coalesced datagrams received: " << offload.coalesced << "\n";
+}
@@ -0,0 +1,217 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <fnet/socket.h>
+#include <fnet/addrinfo.h>
+#include <fnet/tls/tls.h>
+#include <fnet/quic/crypto/crypto.h>
+#include <fnet/quic/packet/crypto.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace fnet = futils::fnet;
+namespace tls = fnet::tls;
+namespace view = futils::view;
+using futils::byte;
+
+// move records from one side to another on memory
+void pump(tls::TLS& from, tls::TLS& to, std::string* captured = nullptr) {
+    auto res = from.receive_tls_data_until_block([&](view::wvec d) {
+        if (captured) {
+            captured->append(d.as_char(), d.size());
+        }
+        auto r = to.provide_tls_data(d);
+        assert(r && r->empty());
+    });
+    assert(res);
+}
+
+void handshake(tls::TLS& client, tls::TLS& server) {
+    while (true) {
+        auto c = client.connect();
+        assert(c || tls::isTLSBlock(c.error()));
+        pump(client, server);
+        auto s = server.accept();
+        assert(s || tls::isTLSBlock(s.error()));
+        pump(server, client);
+        if (c && s) {
+            break;
+        }
+    }
+    // receive NewSessionTicket
+    byte buf[100];
+    auto r = client.read(buf);
+    assert(!r && tls::isTLSBlock(r.error()));
+}
+
+// record written after get_ktls_send_info must be decrypted
+// with key, iv and sequence number given to kernel
+void test_record(tls::TLS& sender, tls::TLS& receiver, std::string_view msg) {
+    byte info_buf[tls::ktls_crypto_info_size];
+    auto info = sender.get_ktls_send_info(info_buf);
+    assert(info && info->size() == tls::ktls_crypto_info_size);
+    // struct tls12_crypto_info_aes_gcm_128
+    // version(2) cipher_type(2) iv(8) key(16) salt(4) rec_seq(8)
+    auto iv = info->substr(4, 8), key = info->substr(12, 16), salt = info->substr(28, 4), seq = info->substr(32, 8);
+    assert(info_buf[0] == 0x04 && info_buf[1] == 0x03 && info_buf[2] == 51);
+    auto w = sender.write(view::rvec(msg));
+    assert(w && w->empty());
+    std::string record;
+    pump(sender, receiver, &record);
+    constexpr auto tag_len = 16;
+    assert(record.size() == 5 + msg.size() + 1 + tag_len);
+    byte nonce[12];
+    std::memcpy(nonce, salt.data(), 4);
+    std::memcpy(nonce + 4, iv.data(), 8);
+    for (size_t i = 0; i < 8; i++) {
+        nonce[4 + i] ^= seq[i];
+    }
+    view::wvec rec(reinterpret_cast<byte*>(record.data()), record.size());
+    fnet::quic::packet::CryptoPacketPnKnown p{rec.substr(0, 5), rec.substr(5, msg.size() + 1), rec.substr(5 + msg.size() + 1)};
+    auto err = fnet::quic::crypto::cipher_payload(tls::TLSCipher{}, p, key, nonce, false);
+    assert(!err && "record is not encrypted by offered key");
+    // inner plaintext is content + content type (application_data)
+    assert(p.protected_payload.substr(0, msg.size()) == view::rvec(msg) && p.protected_payload[msg.size()] == 23);
+    byte buf[100];
+    auto r = receiver.read(buf);
+    assert(r && *r == view::rvec(msg));
+}
+
+fnet::Socket make_tcp() {
+    auto s = fnet::make_socket(fnet::sockattr_tcp(fnet::ip::Version::ipv6)).value();
+    s.set_ipv6only(false).value();
+    return s;
+}
+
+void write_all(fnet::Socket& sock, view::rvec data) {
+    while (data.size()) {
+        auto res = sock.write(data);
+        if (!res) {
+            assert(fnet::isSysBlock(res.error()));
+            sock.wait_writable(1, 0);
+            continue;
+        }
+        data = *res;
+    }
+}
+
+// send bytes from server to client over loopback
+// sender encrypts records in user space or in kernel
+// receiver always decrypts in user space
+std::int64_t transfer(tls::TLS& client, tls::TLS& server, size_t size, bool ktls) {
+    auto listener = make_tcp();
+    listener.bind(fnet::to_ipv6("::ffff:127.0.0.1", 0, true).value()).value();
+    listener.listen().value();
+    auto csock = make_tcp();
+    auto c = csock.connect(listener.get_local_addr().value());
+    assert(c || fnet::isSysBlock(c.error()));
+    listener.wait_readable(1, 0);
+    auto ssock = listener.accept().value().first;
+    csock.wait_writable(1, 0);
+    if (ktls) {
+        byte info[tls::ktls_crypto_info_size];
+        auto ok = server.get_ktls_send_info(info).and_then([&](view::wvec i) {
+            return ssock.set_ktls_send(i);
+        });
+        if (!ok) {
+            futils::wrap::cout_wrap() << "  kTLS is not available: " << ok.error().error<std::string>() << "\n";
+            return -1;
+        }
+    }
+    futils::test::Timer t;
+    std::thread sender([&] {
+        std::string chunk(16 * 1024, 'k');
+        for (size_t sent = 0; sent < size; sent += chunk.size()) {
+            if (ktls) {
+                write_all(ssock, view::rvec(chunk));
+                continue;
+            }
+            auto w = server.write(view::rvec(chunk));
+            assert(w && w->empty());
+            server.receive_tls_data_until_block([&](view::wvec d) {
+                write_all(ssock, d);
+            });
+        }
+    });
+    size_t received = 0;
+    byte buf[64 * 1024], plain[64 * 1024];
+    while (received < size) {
+        auto res = csock.read(buf);
+        if (!res) {
+            assert(fnet::isSysBlock(res.error()));
+            csock.wait_readable(1, 0);
+            continue;
+        }
+        assert(res->size() && "connection closed");
+        // BIO buffer is smaller than read buffer
+        for (view::rvec remain = *res; remain.size();) {
+            auto p = client.provide_tls_data(remain);
+            assert(p);
+            remain = *p;
+            auto r = client.read_until_block([&](view::wvec d) {
+                received += d.size();
+            },
+                                             plain);
+            assert(r && "record decryption failed");
+        }
+    }
+    sender.join();
+    return t.next_step<std::chrono::microseconds>().count();
+}
+
+// usage: fnet_ktls <cert.pem> <private.pem> [megabytes]
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    if (argc < 3) {
+        // record test runs without kernel support, so missing certificate must not look like success
+        cout << "fnet_ktls: certificate and private key are required\n";
+        cout << "usage: fnet_ktls <cert.pem> <private.pem> [megabytes]\n";
+        return 1;
+    }
+    const size_t size = (argc > 3 ? std::stoull(argv[3]) : 256) * 1024 * 1024;
+    auto make_conf = [&](bool server) {
+        auto conf = tls::configure_with_error().value();
+        if (server) {
+            conf.set_cert_chain(argv[1], argv[2]).value();
+        }
+        conf.set_ktls_enabled(true).value();
+        return conf;
+    };
+    auto server_conf = make_conf(true), client_conf = make_conf(false);
+    auto make_pair = [&] {
+        auto client = tls::create_tls_with_error(client_conf).value();
+        auto server = tls::create_tls_with_error(server_conf).value();
+        handshake(client, server);
+        return std::make_pair(std::move(client), std::move(server));
+    };
+    {
+        auto [client, server] = make_pair();
+        test_record(server, client, "hello from server");
+        test_record(server, client, "sequence number is incremented");
+        test_record(client, server, "hello from client");
+    }
+    cout << "loopback TLS 1.3 transfer " << size / 1024 / 1024 << "MB\n";
+    auto report = [&](const char* name, std::int64_t us) {
+        cout << "  " << name << us << "us (" << size * 1000000 / (us + 1) / 1024 / 1024 << " MB/s)\n";
+    };
+    {
+        auto [client, server] = make_pair();
+        report("user space encryption: ", transfer(client, server, size, false));
+    }
+    {
+        auto [client, server] = make_pair();
+        auto us = transfer(client, server, size, true);
+        if (us >= 0) {
+            report("kTLS:                  ", us);
+        }
+    }
+}
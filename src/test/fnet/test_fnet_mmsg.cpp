@@ -0,0 +1,115 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <fnet/socket.h>
+#include <fnet/addrinfo.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <cassert>
+#include <string>
+#include <vector>
+
+namespace fnet = futils::fnet;
+namespace view = futils::view;
+
+constexpr size_t batch = 32, packet_size = 1200;
+
+fnet::Socket make_udp() {
+    auto s = fnet::make_socket(fnet::sockattr_udp(fnet::ip::Version::ipv4)).value();
+    s.bind(fnet::to_ipv4("127.0.0.1", 0).value()).value();
+    return s;
+}
+
+struct Bench {
+    fnet::Socket sender = make_udp();
+    fnet::Socket receiver = make_udp();
+    fnet::NetAddrPort to = receiver.get_local_addr().value();
+    fnet::NetAddrPort from = sender.get_local_addr().value();
+    std::vector<futils::byte> send_buf = std::vector<futils::byte>(batch * packet_size);
+    std::vector<futils::byte> recv_buf = std::vector<futils::byte>(batch * 2048);
+
+    void fill(size_t round) {
+        for (size_t i = 0; i < batch; i++) {
+            send_buf[i * packet_size] = futils::byte(round + i);
+        }
+    }
+
+    void check(size_t round, size_t i, view::rvec data) {
+        assert(data.size() == packet_size);
+        assert(data[0] == futils::byte(round + i));
+    }
+
+    // one system call per datagram
+    void single(size_t round) {
+        fill(round);
+        for (size_t i = 0; i < batch; i++) {
+            auto res = sender.writeto(to, view::rvec(send_buf).substr(i * packet_size, packet_size));
+            assert(res && res->empty());
+        }
+        size_t got = 0;
+        while (got < batch) {
+            auto res = receiver.readfrom(view::wvec(recv_buf.data(), 2048));
+            if (!res) {
+                assert(fnet::isSysBlock(res.error()));
+                receiver.wait_readable(1, 0);
+                continue;
+            }
+            check(round, got++, res->first);
+        }
+    }
+
+    // sendmmsg/recvmmsg
+    void many(size_t round) {
+        fill(round);
+        fnet::Datagram<view::rvec> out[batch];
+        for (size_t i = 0; i < batch; i++) {
+            out[i] = {view::rvec(send_buf).substr(i * packet_size, packet_size), to};
+        }
+        auto res = sender.writeto_many(out);
+        assert(res && *res == batch);
+        size_t got = 0;
+        fnet::Datagram<view::wvec> in[batch];
+        while (got < batch) {
+            for (size_t i = got; i < batch; i++) {
+                in[i].data = view::wvec(recv_buf.data() + i * 2048, 2048);
+            }
+            auto res = receiver.readfrom_many(view::wspan<fnet::Datagram<view::wvec>>(in + got, batch - got));
+            if (!res) {
+                assert(fnet::isSysBlock(res.error()));
+                receiver.wait_readable(1, 0);
+                continue;
+            }
+            for (size_t i = 0; i < *res; i++) {
+                check(round, got + i, in[got + i].data);
+                assert(in[got + i].addr.port().u16() == from.port().u16());
+            }
+            got += *res;
+        }
+    }
+};
+
+// usage: fnet_mmsg [rounds]
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    const size_t rounds = argc > 1 ? std::stoull(argv[1]) : 20000;
+    Bench b;
+    b.single(0);
+    b.many(0);
+    futils::test::Timer t;
+    for (size_t r = 0; r < rounds; r++) {
+        b.single(r);
+    }
+    auto single = t.next_step<std::chrono::microseconds>();
+    for (size_t r = 0; r < rounds; r++) {
+        b.many(r);
+    }
+    auto many = t.next_step<std::chrono::microseconds>();
+    const auto packets = rounds * batch;
+    cout << "loopback udp " << packets << " packets x " << packet_size << " bytes\n";
+    cout << "  writeto/readfrom:           " << single.count() << "us (" << packets * 1000000 / (single.count() + 1) << " packets/s)\n";
+    cout << "  writeto_many/readfrom_many: " << many.count() << "us (" << packets * 1000000 / (many.count() + 1) << " packets/s)\n";
+}
@@ -0,0 +1,117 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <fnet/dll/allocator.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fnet = futils::fnet;
+
+void test_alloc() {
+    // every size up to larger than max class
+    std::vector<std::pair<void*, size_t>> ptrs;
+    for (size_t size = 1; size <= 5000; size += 7) {
+        auto p = fnet::alloc_objpool(size, alignof(std::max_align_t), DNET_DEBUG_MEMORY_LOCINFO(true, size, alignof(std::max_align_t)));
+        assert(p && std::uintptr_t(p) % alignof(std::max_align_t) == 0);
+        std::memset(p, int(size & 0xff), size);
+        ptrs.emplace_back(p, size);
+    }
+    for (auto& [p, size] : ptrs) {
+        auto b = static_cast<unsigned char*>(p);
+        assert(b[0] == (size & 0xff) && b[size - 1] == (size & 0xff) && "object overlapped");
+        fnet::free_objpool(p, DNET_DEBUG_MEMORY_LOCINFO(false, 0, 0));
+    }
+    // over aligned object
+    auto a = fnet::alloc_objpool(100, 256, DNET_DEBUG_MEMORY_LOCINFO(true, 100, 256));
+    assert(a && std::uintptr_t(a) % 256 == 0);
+    fnet::free_objpool(a, DNET_DEBUG_MEMORY_LOCINFO(false, 0, 0));
+    // realloc keeps content across size class
+    auto r = static_cast<char*>(fnet::alloc_objpool(10, 1, DNET_DEBUG_MEMORY_LOCINFO(true, 10, 1)));
+    std::memcpy(r, "objpool!!", 10);
+    r = static_cast<char*>(fnet::realloc_objpool(r, 3000, 1, DNET_DEBUG_MEMORY_LOCINFO(true, 3000, 1)));
+    assert(r && std::memcmp(r, "objpool!!", 10) == 0);
+    r = static_cast<char*>(fnet::realloc_objpool(r, 10000, 1, DNET_DEBUG_MEMORY_LOCINFO(true, 10000, 1)));
+    assert(r && std::memcmp(r, "objpool!!", 10) == 0);
+    fnet::free_objpool(r, DNET_DEBUG_MEMORY_LOCINFO(false, 0, 0));
+}
+
+// objects allocated by one thread and freed by another go through depot
+void test_cross_thread() {
+    constexpr size_t count = 100000;
+    std::vector<void*> ptrs(count);
+    std::thread producer([&] {
+        for (auto& p : ptrs) {
+            p = fnet::alloc_objpool(48, 8, DNET_DEBUG_MEMORY_LOCINFO(true, 48, 8));
+            assert(p);
+        }
+    });
+    producer.join();
+    std::thread consumer([&] {
+        for (auto p : ptrs) {
+            fnet::free_objpool(p, DNET_DEBUG_MEMORY_LOCINFO(true, 48, 8));
+        }
+    });
+    consumer.join();
+}
+
+struct Object {
+    std::uint64_t data[8];
+};
+
+template <template <class> class Alloc>
+std::int64_t bench(size_t threads, size_t rounds) {
+    futils::test::Timer t;
+    std::vector<std::thread> th;
+    for (size_t i = 0; i < threads; i++) {
+        th.emplace_back([&] {
+            // keep some objects alive like connections holding streams
+            std::vector<std::shared_ptr<Object>> live(256);
+            for (size_t r = 0; r < rounds; r++) {
+                live[r % live.size()] = std::allocate_shared<Object>(Alloc<Object>{});
+            }
+        });
+    }
+    for (auto& t : th) {
+        t.join();
+    }
+    return t.next_step<std::chrono::microseconds>().count();
+}
+
+// usage: fnet_objpool [threads] [rounds per thread]
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    test_alloc();
+    test_cross_thread();
+    const size_t threads = argc > 1 ? std::stoull(argv[1]) : 4;
+    const size_t rounds = argc > 2 ? std::stoull(argv[2]) : 1000000;
+    const auto total = threads * rounds;
+    cout << "allocate_shared " << sizeof(Object) << " bytes object " << threads << " threads x " << rounds << " rounds\n";
+    auto normal = bench<fnet::glheap_allocator>(threads, rounds);
+    cout << "  glheap_allocator:         " << normal << "us (" << total * 1000000 / (normal + 1) << " allocs/s)\n";
+    auto pool = bench<fnet::glheap_objpool_allocator>(threads, rounds);
+    cout << "  glheap_objpool_allocator: " << pool << "us (" << total * 1000000 / (pool + 1) << " allocs/s)\n";
+    fnet::ObjpoolClassStats stats[64];
+    auto n = fnet::get_objpool_stats(stats, 64);
+    assert(n <= 64);
+    cout << "objpool size classes used:\n";
+    for (size_t i = 0; i < n; i++) {
+        auto& s = stats[i];
+        if (!s.objects) {
+            continue;
+        }
+        cout << "  size " << s.object_size << ": slabs " << s.slabs << " objects " << s.objects << " depot " << s.depot_objects
+             << " refills " << s.refills << " returns " << s.returns << " (magazine " << s.magazine_size << ")\n";
+        assert(s.depot_objects <= s.objects);
+    }
+}
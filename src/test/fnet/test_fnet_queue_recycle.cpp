@@ -0,0 +1,94 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <fnet/dll/allocator.h>
+#include <thread/concurrent_queue.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace fnet = futils::fnet;
+
+std::atomic_size_t glheap_calls = 0;
+
+void* count_alloc(void*, size_t size, size_t, fnet::DebugInfo*) {
+    glheap_calls++;
+    return std::malloc(size);
+}
+
+void* count_realloc(void*, void* p, size_t size, size_t, fnet::DebugInfo*) {
+    glheap_calls++;
+    return std::realloc(p, size);
+}
+
+void count_free(void*, void* p, fnet::DebugInfo*) {
+    glheap_calls++;
+    std::free(p);
+}
+
+// same element and allocator as fnet::quic::server::SenderQue
+using Elem = std::shared_ptr<int>;
+using Queue = futils::thread::MultiProduceSingleConsumeQueue<Elem, fnet::glheap_allocator<Elem>>;
+
+constexpr size_t rounds = 20, per_round = 1 << 14;
+
+int main(int argc, char** argv) {
+    fnet::set_normal_allocs(fnet::Allocs{
+        .alloc_ptr = count_alloc,
+        .realloc_ptr = count_realloc,
+        .free_ptr = count_free,
+    });
+    auto& cout = futils::wrap::cout_wrap();
+    const size_t max_producer = argc > 1 ? std::stoull(argv[1]) : 16;
+    auto elem = std::make_shared<int>(1);
+    for (size_t n = 1; n <= max_producer; n *= 2) {
+        glheap_calls = 0;
+        Queue q;
+        size_t warm_calls = 0;
+        futils::test::Timer t;
+        std::chrono::microseconds steady{};
+        for (size_t r = 0; r < rounds; r++) {
+            if (r == 1) {
+                // first round fills free lists
+                warm_calls = glheap_calls.load();
+                t.reset();
+            }
+            std::vector<std::thread> threads;
+            for (size_t p = 0; p < n; p++) {
+                threads.emplace_back([&] {
+                    for (size_t i = 0; i < per_round / n; i++) {
+                        q.push(elem);
+                    }
+                });
+            }
+            size_t got = 0;
+            while (got < per_round / n * n) {
+                if (auto v = q.pop()) {
+                    assert(**v == 1);
+                    got++;
+                }
+            }
+            for (auto& th : threads) {
+                th.join();
+            }
+        }
+        steady = t.next_step<std::chrono::microseconds>();
+        auto steady_calls = glheap_calls.load() - warm_calls;
+        auto stats = q.stats();
+        cout << "producers: " << n << "\n";
+        cout << "  warm up allocator calls: " << warm_calls << " (" << per_round << " pushes)\n";
+        cout << "  steady allocator calls: " << steady_calls << " (" << per_round * (rounds - 1) << " pushes)\n";
+        cout << "  queue allocations: " << stats.allocations << " deallocations: " << stats.deallocations << "\n";
+        cout << "  steady time: " << steady.count() << "us\n";
+        assert(steady_calls < per_round && "node recycling not working");
+    }
+}
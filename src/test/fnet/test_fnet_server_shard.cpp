@@ -0,0 +1,124 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <fnet/server/state.h>
+#include <fnet/server/httpserv.h>
+#include <fnet/awaitable.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <atomic>
+#include <cassert>
+#include <ctime>
+#include <map>
+#include <string>
+#include <thread>
+
+namespace fnet = futils::fnet;
+namespace serv = fnet::server;
+namespace view = futils::view;
+
+constexpr auto request = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+constexpr auto body = "hello";
+
+void http_serve(void*, std::shared_ptr<serv::Requester>&& req, serv::StateContext s) {
+    std::string method, path;
+    std::map<std::string, std::string> h;
+    if (auto err = req->http.read_request(method, path, fnet::http1::default_header_callback<std::string>([](auto&&, auto&&) {}))) {
+        return;  // incomplete request is resumed by http_handler
+    }
+    req->respond(serv::StatusCode::http_ok, h, body);
+}
+
+fnet::Socket make_tcp(fnet::event::IOEvent* event) {
+    auto s = fnet::make_socket(fnet::sockattr_tcp(fnet::ip::Version::ipv6), event).value();
+    s.set_ipv6only(false).value();
+    s.set_nodelay(true).value();
+    return s;
+}
+
+// keep-alive client sending requests one by one
+fnet::Task<> client(fnet::event::IOEvent* event, const fnet::NetAddrPort& addr, size_t requests, std::atomic_size_t& done) {
+    auto sock = make_tcp(event);
+    auto c = co_await fnet::async_connect(sock, addr);
+    assert(c && "connect failed");
+    futils::byte buf[1024];
+    for (size_t i = 0; i < requests; i++) {
+        auto w = co_await fnet::async_write(sock, view::rvec(request));
+        assert(w && "write failed");
+        std::string resp;
+        // body is at the end of response
+        while (resp.size() < 5 || !resp.ends_with(body)) {
+            auto r = co_await fnet::async_read(sock, buf);
+            assert(r && r->size() && "read failed");
+            resp.append(r->as_char(), r->size());
+        }
+    }
+    done++;
+}
+
+size_t run_clients(const fnet::NetAddrPort& addr, size_t conns, size_t requests) {
+    auto event = fnet::event::make_io_event(fnet::event::fnet_handle_completion, nullptr).value();
+    std::atomic_size_t done = 0;
+    futils::test::Timer t;
+    for (size_t i = 0; i < conns; i++) {
+        fnet::spawn(client(&event, addr, requests, done));
+    }
+    while (done < conns) {
+        event.wait(1000).value();
+    }
+    return t.next_step<std::chrono::microseconds>().count();
+}
+
+// usage: fnet_server_shard [connections] [requests per connection] [shards]
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    const size_t conns = argc > 1 ? std::stoull(argv[1]) : 32;
+    const size_t requests = argc > 2 ? std::stoull(argv[2]) : 1000;
+    const std::uint32_t shards = argc > 3 ? std::stoul(argv[3]) : 0;
+    const auto total = conns * requests;
+    serv::HTTPServ hs;
+    hs.next = http_serve;
+    auto any = fnet::to_ipv6("::ffff:127.0.0.1", 0, true).value();
+    cout << "http/1.1 keep-alive " << conns << " connections x " << requests << " requests\n";
+
+    {
+        // accept_thread + handler_thread
+        auto state = serv::make_state(&hs, serv::http_handler);
+        state->set_max_and_active(std::thread::hardware_concurrency() + 1, 2);
+        auto listener = make_tcp(nullptr);
+        listener.set_reuse_addr(true).value();
+        listener.bind(any).value();
+        listener.listen(10000).value();
+        auto addr = listener.get_local_addr().value();
+        state->add_accept_thread(std::move(listener));
+        auto us = run_clients(addr, conns, requests);
+        cout << "  accept thread + handler threads: " << us << "us (" << total * 1000000 / (us + 1) << " req/s)\n";
+        // idle handler threads block on IOEvent so that they should not consume cpu
+        auto cpu = std::clock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        cout << "  cpu time while idle for 500ms: " << (std::clock() - cpu) * 1000 / CLOCKS_PER_SEC << "ms ("
+             << state->state().current_handler_thread.load() << " handler threads)\n";
+        state->notify();
+    }
+    {
+        // SO_REUSEPORT listener and IOEvent per shard thread
+        auto state = serv::make_state(&hs, serv::http_handler);
+        serv::ShardConfig conf;
+        conf.shards = shards;
+        conf.pin_cpu = true;
+        conf.incoming_cpu = true;
+        auto addr = state->add_sharded_listener(fnet::SockAddr{any, fnet::sockattr_tcp(fnet::ip::Version::ipv6)}, conf);
+        if (!addr) {
+            cout << "  sharded listener is not supported: " << addr.error().error<std::string>() << "\n";
+            return 0;
+        }
+        auto us = run_clients(*addr, conns, requests);
+        cout << "  sharded listeners (" << state->state().current_shard_thread.load() << " shards): " << us << "us (" << total * 1000000 / (us + 1) << " req/s)\n";
+        state->notify();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));  // let threads see end flag
+}
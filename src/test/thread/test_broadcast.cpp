@@ -0,0 +1,241 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <thread/broadcast.h>
+#include <thread/fork_channel.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <atomic>
+#include <chrono>
+#include <cassert>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace thread = futils::thread;
+
+void test_basic() {
+    auto ch = thread::make_broadcast<std::string>(4);
+    auto before = ch.subscribe();
+    assert(ch << "a");
+    auto after = ch.subscribe();  // starts from next element
+    assert(ch << "b");
+    std::string v;
+    assert((before >> v) == thread::BroadcastState::ok && v == "a");
+    assert((before >> v) == thread::BroadcastState::ok && v == "b");
+    assert((before >> v) == thread::BroadcastState::empty);
+    assert((after >> v) == thread::BroadcastState::ok && v == "b");
+    ch.close();
+    assert(!(ch << "c"));
+    assert((after >> v) == thread::BroadcastState::closed);
+}
+
+void test_drop_slow() {
+    auto ch = thread::make_broadcast<std::string>(4, thread::BroadcastPolicy::drop_slow);
+    auto fast = ch.subscribe();
+    auto slow = ch.subscribe();
+    std::string v;
+    for (size_t i = 0; i < 10; i++) {
+        assert(ch << std::to_string(i));  // never blocks
+        assert((fast >> v) == thread::BroadcastState::ok && v == std::to_string(i));
+    }
+    assert((slow >> v) == thread::BroadcastState::lagged);
+    assert(slow.dropped() > 0 && slow.lag() == 0);
+    assert(ch << "10");
+    assert((slow >> v) == thread::BroadcastState::ok && v == "10");
+}
+
+void test_overwrite() {
+    auto ch = thread::make_broadcast<size_t>(4, thread::BroadcastPolicy::overwrite);
+    auto r = ch.subscribe();
+    for (size_t i = 0; i < 10; i++) {
+        assert(ch << size_t(i));
+    }
+    size_t v;
+    assert((r >> v) == thread::BroadcastState::lagged);
+    auto res = r >> v;
+    assert(res == thread::BroadcastState::ok && v >= 6);  // oldest alive elements
+    size_t prev = v;
+    while ((r >> v) == thread::BroadcastState::ok) {
+        assert(v == ++prev);
+    }
+    assert(prev == 9);
+}
+
+// every subscriber receives all elements in order with producer gated by slowest one
+void test_blocking(size_t subs, size_t count) {
+    auto ch = thread::make_broadcast<size_t>(64);
+    std::vector<std::thread> ths;
+    std::atomic_size_t ok = 0;
+    for (size_t s = 0; s < subs; s++) {
+        ths.emplace_back([&, r = ch.subscribe()]() mutable {
+            r.set_blocking(true);
+            size_t v, expect = 0;
+            while ((r >> v) == thread::BroadcastState::ok) {
+                assert(v == expect);
+                expect++;
+            }
+            if (expect == count) {
+                ok++;
+            }
+        });
+    }
+    for (size_t i = 0; i < count; i++) {
+        assert(ch << size_t(i));
+    }
+    ch.close();
+    for (auto& th : ths) {
+        th.join();
+    }
+    assert(ok == subs);
+}
+
+// producer blocked by slowest subscriber resumes when it is destroyed
+void test_detach_unblocks() {
+    auto ch = thread::make_broadcast<size_t>(4);
+    auto fast = ch.subscribe();
+    std::optional<decltype(ch.subscribe())> slow;
+    slow.emplace(ch.subscribe());
+    size_t v;
+    for (size_t i = 0; i < 4; i++) {
+        assert(ch << size_t(i));
+        assert((fast >> v) == thread::BroadcastState::ok && v == i);
+    }
+    std::atomic_bool done = false;
+    std::thread producer([&] {
+        assert(ch << size_t(4));  // ring is full until slow is detached
+        done = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!done);
+    slow.reset();
+    for (auto i = 0; i < 200 && !done; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(done && "publish must return after slowest subscriber is detached");
+    producer.join();
+    assert((fast >> v) == thread::BroadcastState::ok && v == 4);
+}
+
+// lagging subscribers only lose elements, never see broken order
+void test_drop_slow_threads(size_t subs, size_t count) {
+    auto ch = thread::make_broadcast<std::string>(16, thread::BroadcastPolicy::drop_slow);
+    std::vector<std::thread> ths;
+    for (size_t s = 0; s < subs; s++) {
+        ths.emplace_back([&, s, r = ch.subscribe()]() mutable {
+            r.set_blocking(true);
+            std::string v;
+            size_t got = 0, prev = 0;
+            bool first = true;
+            for (;;) {
+                auto res = r >> v;
+                if (res == thread::BroadcastState::closed) {
+                    break;
+                }
+                if (res == thread::BroadcastState::lagged) {
+                    continue;
+                }
+                auto n = std::stoull(v);
+                assert(first || n > prev);
+                first = false;
+                prev = n;
+                got++;
+                if (s % 2 == 0) {
+                    std::this_thread::yield();  // slow consumer
+                }
+            }
+            assert(got + r.dropped() == count);
+        });
+    }
+    for (size_t i = 0; i < count; i++) {
+        assert(ch << std::to_string(i));
+    }
+    ch.close();
+    for (auto& th : ths) {
+        th.join();
+    }
+}
+
+struct Msg {
+    size_t seq = 0;
+    size_t payload[7]{};
+};
+
+// producer sends count messages to subs subscribers and all subscribers receive them
+std::chrono::microseconds bench_fork(size_t subs, size_t count) {
+    auto fork = thread::make_forkchan<Msg>();
+    fork.set_blocking(true);
+    std::vector<std::thread> ths;
+    std::vector<futils::wrap::shared_ptr<thread::Subscriber<Msg>>> keep;
+    for (size_t s = 0; s < subs; s++) {
+        auto [w, r] = thread::make_chan<Msg>(1024);
+        keep.push_back(fork.subscribe(std::move(w)));
+        ths.emplace_back([r = r, count]() mutable {
+            r.set_blocking(true);
+            Msg m;
+            size_t n = 0;
+            while (r >> m) {
+                n++;
+            }
+            assert(n == count);
+        });
+    }
+    futils::test::Timer t;
+    for (size_t i = 0; i < count; i++) {
+        fork << Msg{i};
+    }
+    fork.close();
+    for (auto& th : ths) {
+        th.join();
+    }
+    return t.next_step<std::chrono::microseconds>();
+}
+
+std::chrono::microseconds bench_broadcast(size_t subs, size_t count) {
+    auto ch = thread::make_broadcast<Msg>(1024);
+    std::vector<std::thread> ths;
+    for (size_t s = 0; s < subs; s++) {
+        ths.emplace_back([r = ch.subscribe(), count]() mutable {
+            r.set_blocking(true);
+            size_t n = 0;
+            // read in place, no copy
+            while (r.read([&](const Msg& m) { n++; }) == thread::BroadcastState::ok) {
+            }
+            assert(n == count);
+        });
+    }
+    futils::test::Timer t;
+    for (size_t i = 0; i < count; i++) {
+        ch << Msg{i};
+    }
+    ch.close();
+    for (auto& th : ths) {
+        th.join();
+    }
+    return t.next_step<std::chrono::microseconds>();
+}
+
+// usage: broadcast [max subscribers] [messages]
+int main(int argc, char** argv) {
+    test_basic();
+    test_drop_slow();
+    test_overwrite();
+    test_detach_unblocks();
+    test_blocking(8, 100000);
+    test_drop_slow_threads(8, 100000);
+    auto& cout = futils::wrap::cout_wrap();
+    const size_t max_subs = argc > 1 ? std::stoull(argv[1]) : 256;
+    const size_t count = argc > 2 ? std::stoull(argv[2]) : 20000;
+    for (size_t s = 4; s <= max_subs; s *= 4) {
+        auto fork = bench_fork(s, count);
+        auto bc = bench_broadcast(s, count);
+        cout << "subscribers: " << s << " messages: " << count << "\n";
+        cout << "  ForkChan:      " << fork.count() << "us\n";
+        cout << "  BroadcastChan: " << bc.count() << "us\n";
+    }
+}
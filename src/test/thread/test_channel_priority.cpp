@@ -0,0 +1,160 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <thread/channel.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <cassert>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace thread = futils::thread;
+
+constexpr size_t levels = 8;
+
+struct Item {
+    size_t prio = 0;
+    size_t seq = 0;
+
+    size_t level() const {
+        return prio;
+    }
+
+    // for std::priority_queue (top is the largest), level 0 is the highest
+    friend bool operator<(const Item& a, const Item& b) {
+        return a.prio > b.prio;
+    }
+};
+
+using Handler = thread::BucketHandler<levels>;
+
+void test_order() {
+    auto [w, r] = thread::make_chan<Item, thread::BucketQue, Handler>(64);
+    for (size_t i = 0; i < 32; i++) {
+        assert((w << Item{(i * 5) % levels, i}));
+    }
+    Item prev{0, 0}, v;
+    bool first = true;
+    size_t n = 0;
+    while (r >> v) {
+        if (!first) {
+            assert(prev.prio <= v.prio);
+            assert(prev.prio != v.prio || prev.seq < v.seq);  // FIFO within level
+        }
+        first = false;
+        prev = v;
+        n++;
+    }
+    assert(n == 32);
+    assert((r >> v) == thread::ChanStateValue::empty);
+    w.close();
+    assert((r >> v) == thread::ChanStateValue::closed);
+}
+
+void test_limit() {
+    auto [w, r] = thread::make_chan<Item, thread::BucketQue, Handler>(4, thread::ChanDisposePolicy::dispose_front);
+    for (size_t i = 0; i < 6; i++) {
+        assert((w << Item{1, i}));
+    }
+    assert((w << Item{2, 100}));  // other level has its own capacity
+    Item v;
+    assert(r >> v);
+    assert(v.prio == 1 && v.seq == 2);
+    r.change_policy(thread::ChanDisposePolicy::dispose_new);
+    assert((w << Item{1, 6}));
+    assert(((w << Item{1, 7}) == thread::ChanStateValue::full));
+}
+
+void test_aging() {
+    auto [w, r] = thread::make_chan<Item, thread::BucketQue, Handler>(1024);
+    r.set_handler([](Handler& h) { h.aging = 4; });
+    for (size_t i = 0; i < 100; i++) {
+        assert((w << Item{0, i}));
+    }
+    assert((w << Item{levels - 1, 0}));
+    Item v;
+    size_t pos = 0;
+    while (r >> v) {
+        if (v.prio == levels - 1) {
+            break;
+        }
+        pos++;
+    }
+    assert(v.prio == levels - 1 && pos < 4);  // not starved behind 100 high priority items
+}
+
+void test_blocking() {
+    auto [w, r] = thread::make_chan<Item, thread::BucketQue, Handler>(8);
+    r.set_blocking(true);
+    w.set_blocking(true);
+    constexpr size_t count = 100000;
+    std::thread th([w = w]() mutable {
+        for (size_t i = 0; i < count; i++) {
+            w << Item{i % levels, i};
+        }
+        w.close();
+    });
+    Item v;
+    size_t n = 0;
+    while (r >> v) {
+        n++;
+    }
+    th.join();
+    assert(n == count);
+}
+
+// producers push items of random level, one consumer pops all
+template <template <class...> class Que, class H>
+std::chrono::microseconds throughput(size_t producers, size_t per_producer) {
+    auto [w, r] = thread::make_chan<Item, Que, H>();
+    std::vector<std::thread> ths;
+    futils::test::Timer t;
+    for (size_t p = 0; p < producers; p++) {
+        ths.emplace_back([w = w, p, per_producer]() mutable {
+            size_t x = p * 7919 + 1;
+            for (size_t i = 0; i < per_producer; i++) {
+                x = x * 6364136223846793005 + 1442695040888963407;
+                while (!(w << Item{(x >> 33) % levels, i})) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    size_t got = 0;
+    Item v;
+    while (got < producers * per_producer) {
+        if (r >> v) {
+            got++;
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& th : ths) {
+        th.join();
+    }
+    return t.next_step<std::chrono::microseconds>();
+}
+
+// usage: channel_priority [max producers]
+int main(int argc, char** argv) {
+    test_order();
+    test_limit();
+    test_aging();
+    test_blocking();
+    auto& cout = futils::wrap::cout_wrap();
+    const size_t max_producer = argc > 1 ? std::stoull(argv[1]) : 8;
+    constexpr size_t per_producer = 200000;
+    for (size_t p = 1; p <= max_producer; p *= 2) {
+        auto heap = throughput<std::priority_queue, thread::PriorityHandler>(p, per_producer);
+        auto bucket = throughput<thread::BucketQue, Handler>(p, per_producer);
+        cout << "producers: " << p << " items: " << p * per_producer << "\n";
+        cout << "  priority_queue + PriorityHandler: " << heap.count() << "us\n";
+        cout << "  BucketQue:                        " << bucket.count() << "us\n";
+    }
+}
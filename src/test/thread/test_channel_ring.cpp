@@ -0,0 +1,133 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <thread/channel.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+namespace thread = futils::thread;
+
+constexpr size_t ping_count = 20000;
+constexpr size_t total_items = 1 << 20;
+
+template <template <class...> class Que>
+void test_policy() {
+    {
+        auto [w, r] = thread::make_chan<int, Que>(4);
+        for (auto i = 0; i < 4; i++) {
+            assert(w << int(i));
+        }
+        assert((w << 4) == thread::ChanStateValue::full);
+        int v;
+        assert(r >> v);
+        assert(v == 0);
+    }
+    {
+        auto [w, r] = thread::make_chan<int, Que>(4, thread::ChanDisposePolicy::dispose_front);
+        for (auto i = 0; i < 6; i++) {
+            assert(w << int(i));
+        }
+        int v;
+        assert(r >> v);
+        assert(v == 2);
+    }
+    {
+        auto [w, r] = thread::make_chan<int, Que>(8);
+        int in[5] = {1, 2, 3, 4, 5}, out[8];
+        size_t n = 0;
+        assert(w.send_batch(in, 5, n) && n == 5);
+        assert(r.recv_batch(out, 8, n) && n == 5);
+        assert(out[0] == 1 && out[4] == 5);
+        assert(r.recv_batch(out, 8, n) == thread::ChanStateValue::empty);
+        w.close();
+        assert(r.recv_batch(out, 8, n) == thread::ChanStateValue::closed);
+    }
+}
+
+template <template <class...> class Que>
+std::chrono::nanoseconds ping_pong() {
+    auto [w1, r1] = thread::make_chan<size_t, Que>(16);
+    auto [w2, r2] = thread::make_chan<size_t, Que>(16);
+    r1.set_blocking(true);
+    r2.set_blocking(true);
+    std::thread th([r = r1, w = w2]() mutable {
+        size_t v;
+        while (r >> v) {
+            w << std::move(v);
+        }
+    });
+    futils::test::Timer t;
+    for (size_t i = 0; i < ping_count; i++) {
+        size_t v = i;
+        w1 << std::move(v);
+        r2 >> v;
+        assert(v == i);
+    }
+    auto d = t.next_step<std::chrono::nanoseconds>();
+    w1.close();
+    th.join();
+    return d / ping_count;
+}
+
+template <template <class...> class Que>
+std::chrono::microseconds throughput(size_t producers, size_t batch) {
+    auto [w, r] = thread::make_chan<size_t, Que>(1024);
+    w.set_blocking(true);
+    r.set_blocking(true);
+    std::vector<std::thread> th;
+    futils::test::Timer t;
+    for (size_t p = 0; p < producers; p++) {
+        th.emplace_back([w = w, producers, batch]() mutable {
+            std::vector<size_t> buf(batch, 1);
+            for (size_t i = 0; i < total_items / producers;) {
+                auto k = std::min(batch, total_items / producers - i);
+                size_t sent = 0;
+                while (sent < k) {
+                    size_t n = 0;
+                    w.send_batch(buf.data() + sent, k - sent, n);
+                    sent += n;
+                }
+                i += k;
+            }
+        });
+    }
+    size_t sum = 0, expect = total_items / producers * producers;
+    std::vector<size_t> out(batch);
+    while (sum < expect) {
+        size_t n = 0;
+        r.recv_batch(out.data(), batch, n);
+        for (size_t i = 0; i < n; i++) {
+            sum += out[i];
+        }
+    }
+    for (auto& x : th) {
+        x.join();
+    }
+    auto d = t.next_step<std::chrono::microseconds>();
+    assert(sum == expect);
+    return d;
+}
+
+int main() {
+    auto& cout = futils::wrap::cout_wrap();
+    test_policy<futils::wrap::queue>();
+    test_policy<thread::RingQue>();
+    cout << "ping-pong round trip (avg):\n";
+    cout << "  ChanBuffer: " << ping_pong<futils::wrap::queue>().count() << "ns\n";
+    cout << "  ChanBuffer<RingQue>: " << ping_pong<thread::RingQue>().count() << "ns\n";
+    cout << "throughput (" << total_items << " items):\n";
+    for (size_t producers : {1, 4}) {
+        for (size_t batch : {1, 32}) {
+            cout << "  producers: " << producers << " batch: " << batch << "\n";
+            cout << "    ChanBuffer: " << throughput<futils::wrap::queue>(producers, batch).count() << "us\n";
+            cout << "    ChanBuffer<RingQue>: " << throughput<thread::RingQue>(producers, batch).count() << "us\n";
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <thread/executor.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+namespace poll = futils::thread::poll;
+
+// reschedule itself count times before completion
+struct Yield {
+    int count = 0;
+    int value = 0;
+
+    poll::Poll<int> poll(poll::Context& ctx) {
+        if (count-- > 0) {
+            ctx.waker.wake_by_ref();
+            return poll::Poll<int>::Pending{};
+        }
+        return poll::Poll<int>::Ready{value};
+    }
+};
+
+// spawn children on first poll and sum their results
+struct FanOut {
+    poll::Executor* exec = nullptr;
+    int width = 0;
+    int yields = 0;
+    std::vector<poll::JoinHandle<int>> children;
+    size_t done = 0;
+    int sum = 0;
+
+    poll::Poll<int> poll(poll::Context& ctx) {
+        if (children.empty()) {
+            for (int i = 0; i < width; i++) {
+                children.push_back(exec->spawn(Yield{yields, 1}));
+            }
+        }
+        while (done < children.size()) {
+            auto r = children[done].poll(ctx);
+            if (r.pending()) {
+                return poll::Poll<int>::Pending{};
+            }
+            sum += *r.ready();
+            done++;
+        }
+        return poll::Poll<int>::Ready{sum};
+    }
+};
+
+struct Stamp {
+    std::chrono::steady_clock::time_point spawned;
+
+    poll::Poll<std::int64_t> poll(poll::Context&) {
+        auto now = std::chrono::steady_clock::now();
+        return poll::Poll<std::int64_t>::Ready{std::chrono::duration_cast<std::chrono::nanoseconds>(now - spawned).count()};
+    }
+};
+
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    const size_t max_thread = argc > 1 ? std::stoull(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    for (size_t n = 1; n <= max_thread; n *= 2) {
+        poll::Executor exec(n);
+        {
+            auto h = exec.spawn(Yield{10, 42});
+            assert(h.join() == 42);
+            // lvalue poller is copied, not moved from
+            Yield y{3, 7};
+            assert(exec.spawn(y).join() == 7 && y.count == 3);
+        }
+        futils::test::Timer t;
+        constexpr int width = 10000, yields = 4;
+        auto root = exec.spawn(FanOut{.exec = &exec, .width = width, .yields = yields});
+        auto sum = root.join();
+        assert(sum == width);
+        auto fan_time = t.next_step<std::chrono::microseconds>();
+
+        constexpr int spawns = 10000;
+        std::int64_t total = 0;
+        for (int i = 0; i < spawns; i++) {
+            total += exec.spawn(Stamp{std::chrono::steady_clock::now()}).join();
+        }
+        cout << "threads: " << n << "\n";
+        cout << "  fan-out/fan-in " << width << " tasks x " << yields + 1 << " polls: " << fan_time.count() << "us\n";
+        cout << "  spawn latency (avg): " << total / spawns << "ns\n";
+    }
+}
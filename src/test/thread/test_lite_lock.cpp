@@ -0,0 +1,97 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <thread/lite_lock.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <cassert>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// previous LiteLock implementation (notify_all on every unlock)
+struct FlagLock {
+    std::atomic_flag flag;
+
+    void lock() {
+        while (!try_lock()) {
+            flag.wait(true);
+        }
+    }
+
+    bool try_lock() {
+        return flag.test_and_set(std::memory_order_acquire) == false;
+    }
+
+    void unlock() {
+        flag.clear(std::memory_order_release);
+        flag.notify_all();
+    }
+};
+
+constexpr size_t total_ops = 1 << 21;
+
+template <class Lock>
+std::chrono::microseconds bench(size_t threads, size_t work) {
+    Lock l;
+    size_t counter = 0;
+    std::vector<std::thread> th;
+    futils::test::Timer t;
+    for (size_t i = 0; i < threads; i++) {
+        th.emplace_back([&] {
+            for (size_t k = 0; k < total_ops / threads; k++) {
+                std::lock_guard g(l);
+                for (size_t w = 0; w < work; w++) {
+                    counter++;
+                }
+            }
+        });
+    }
+    for (auto& x : th) {
+        x.join();
+    }
+    auto d = t.next_step<std::chrono::microseconds>();
+    assert(counter == total_ops / threads * threads * work);
+    return d;
+}
+
+void test_basic() {
+    futils::thread::LiteLock l;
+    assert(l.try_lock());
+    assert(!l.try_lock());
+    l.unlock();
+    l.lock();
+    std::thread th([&] {
+        l.lock();  // sleep with contended state
+        l.unlock();
+    });
+    while (l.state.load() != futils::thread::LiteLock::contended) {
+        std::this_thread::yield();
+    }
+    l.unlock();
+    th.join();
+    assert(l.state.load() == futils::thread::LiteLock::unlocked);
+}
+
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    test_basic();
+    const size_t max_thread = argc > 1 ? std::stoull(argv[1]) : 16;
+    cout << "ops: " << total_ops << "\n";
+    for (size_t work : {1, 64}) {
+        for (size_t n = 1; n <= max_thread; n *= 2) {
+            auto lite = bench<futils::thread::LiteLock>(n, work);
+            auto flag = bench<FlagLock>(n, work);
+            auto mtx = bench<std::mutex>(n, work);
+            cout << "threads: " << n << " critical section: " << work << "\n";
+            cout << "  LiteLock: " << lite.count() << "us\n";
+            cout << "  atomic_flag + notify_all: " << flag.count() << "us\n";
+            cout << "  std::mutex: " << mtx.count() << "us\n";
+        }
+    }
+}
@@ -0,0 +1,126 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <thread/concurrent_queue.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace thread = futils::thread;
+
+constexpr size_t total_items = 1 << 20;
+
+void test_basic() {
+    thread::BoundedRingQueue<std::string> q(3);
+    assert(q.capacity() == 4);
+    for (int i = 0; i < 4; i++) {
+        assert(q.try_push(std::to_string(i)));
+    }
+    assert(!q.try_push(std::string("full")));
+    std::string batch[] = {"a", "b"};
+    assert(q.try_push_n(batch, 2) == 0);
+    assert(*q.try_pop() == "0");
+    assert(q.try_push_n(batch, 2) == 1);
+    std::vector<std::string> out;
+    assert(q.try_pop_n(10, [&](std::string&& s) { out.push_back(std::move(s)); }) == 4);
+    assert(out[0] == "1" && out[3] == "a");
+    assert(!q.try_pop());
+    q.close();
+    assert(!q.pop_wait());
+    assert(!q.push_wait(std::string("closed")));
+}
+
+// multi producer, consumer count given
+std::chrono::microseconds bench_ring(size_t producers, size_t consumers, size_t batch) {
+    thread::BoundedRingQueue<size_t> q(1024);
+    std::vector<std::thread> threads;
+    std::atomic_size_t sum = 0;
+    futils::test::Timer t;
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            auto n = total_items / producers;
+            std::vector<size_t> buf(batch);
+            for (size_t i = 0; i < n;) {
+                size_t k = 0;
+                for (; k < batch && i + k < n; k++) {
+                    buf[k] = 1;
+                }
+                size_t pushed = 0;
+                while (pushed < k) {
+                    pushed += q.push_n_wait(buf.data() + pushed, k - pushed);
+                }
+                i += k;
+            }
+        });
+    }
+    std::vector<std::thread> cons;
+    for (size_t c = 0; c < consumers; c++) {
+        cons.emplace_back([&] {
+            size_t local = 0;
+            while (q.pop_n_wait(batch, [&](size_t&& v) { local += v; })) {
+            }
+            sum += local;
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    q.close();
+    for (auto& th : cons) {
+        th.join();
+    }
+    auto d = t.next_step<std::chrono::microseconds>();
+    assert(sum == total_items / producers * producers);
+    return d;
+}
+
+std::chrono::microseconds bench_mpsc(size_t producers) {
+    thread::MultiProduceSingleConsumeQueue<size_t, std::allocator<size_t>> q;
+    std::vector<std::thread> threads;
+    futils::test::Timer t;
+    for (size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&] {
+            auto n = total_items / producers;
+            for (size_t i = 0; i < n; i++) {
+                q.push(size_t(1));
+            }
+        });
+    }
+    size_t sum = 0, expect = total_items / producers * producers;
+    while (sum < expect) {
+        if (auto v = q.pop()) {
+            sum += *v;
+        }
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    auto d = t.next_step<std::chrono::microseconds>();
+    assert(sum == expect);
+    return d;
+}
+
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    test_basic();
+    const size_t max_producer = argc > 1 ? std::stoull(argv[1]) : 64;
+    cout << "items: " << total_items << "\n";
+    for (size_t n = 1; n <= max_producer; n *= 2) {
+        auto mpsc = bench_mpsc(n);
+        auto ring = bench_ring(n, 1, 1);
+        auto ring_batch = bench_ring(n, 1, 32);
+        auto ring_mpmc = bench_ring(n, 4, 32);
+        cout << "producers: " << n << "\n";
+        cout << "  MultiProduceSingleConsumeQueue: " << mpsc.count() << "us\n";
+        cout << "  BoundedRingQueue (1 consumer): " << ring.count() << "us\n";
+        cout << "  BoundedRingQueue (1 consumer, batch 32): " << ring_batch.count() << "us\n";
+        cout << "  BoundedRingQueue (4 consumers, batch 32): " << ring_mpmc.count() << "us\n";
+    }
+}
@@ -0,0 +1,211 @@
+/*
+    futils - utility library
+    Copyright (c) 2021-2026 on-keyday (https://github.com/on-keyday)
+    Released under the MIT license
+    https://opensource.org/licenses/mit-license.php
+*/
+
+#include <timer/wheel.h>
+#include <testutil/timer.h>
+#include <wrap/cout.h>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace timer = futils::timer;
+
+struct Entry : timer::TimerEntry {
+    size_t id = 0;
+    std::multiset<std::pair<std::uint64_t, size_t>>::iterator ref;
+    bool in_ref = false;
+};
+
+// compare with ordered set under random schedule/cancel/advance including large jumps
+void check_random() {
+    std::mt19937_64 rng(42);
+    constexpr size_t n = 4096;
+    auto entries = std::make_unique<Entry[]>(n);
+    std::multiset<std::pair<std::uint64_t, size_t>> ref;
+    timer::TimerWheel wheel(1000);
+    std::uint64_t now = 1000;
+    for (size_t i = 0; i < n; i++) {
+        entries[i].id = i;
+    }
+    auto schedule = [&](Entry& e, std::uint64_t at) {
+        if (e.in_ref) {
+            ref.erase(e.ref);
+        }
+        e.ref = ref.emplace(at, e.id);
+        e.in_ref = true;
+        wheel.schedule(e, at);
+    };
+    for (size_t round = 0; round < 20000; round++) {
+        for (size_t k = 0; k < 8; k++) {
+            auto& e = entries[rng() % n];
+            switch (rng() % 4) {
+                case 0:
+                    assert(wheel.cancel(e) == e.in_ref);
+                    if (e.in_ref) {
+                        ref.erase(e.ref);
+                        e.in_ref = false;
+                    }
+                    break;
+                case 1:
+                    schedule(e, now - rng() % 3);  // past or now
+                    break;
+                case 2:
+                    schedule(e, now + (std::uint64_t(1) << (rng() % 40)) + rng() % 100);
+                    break;
+                default:
+                    schedule(e, now + rng() % 200);
+                    break;
+            }
+        }
+        assert(wheel.size() == ref.size());
+        if (auto next = wheel.next_expiry()) {
+            assert(!ref.empty() && *next <= std::max(ref.begin()->first, now));
+        }
+        else {
+            assert(ref.empty());
+        }
+        now += rng() % 8 == 0 ? rng() % (1 << 20) : rng() % 16;
+        std::set<size_t> expect;
+        for (auto it = ref.begin(); it != ref.end() && it->first <= now; it++) {
+            expect.insert(it->second);
+        }
+        std::set<size_t> fired;
+        wheel.advance(now, [&](timer::TimerEntry& t) {
+            auto& e = static_cast<Entry&>(t);
+            assert(e.expire() <= now && !e.active());
+            fired.insert(e.id);
+            ref.erase(e.ref);
+            e.in_ref = false;
+            if (e.id % 5 == 0) {
+                schedule(e, now + 1 + e.id % 70);  // periodic
+            }
+        });
+        assert(fired == expect);
+        assert(wheel.size() == ref.size());
+    }
+}
+
+// many threads schedule and cancel while one thread advances
+void check_locked() {
+    constexpr size_t threads = 4, per_thread = 2000;
+    timer::LockedTimerWheel<> wheel(0);
+    std::atomic_size_t fired = 0;
+    std::atomic_uint64_t now = 0;
+    std::atomic_bool stop = false;
+    auto entries = std::make_unique<timer::TimerEntry[]>(threads * per_thread);
+    std::thread ticker([&] {
+        while (!stop) {
+            wheel.advance(++now, [&](timer::TimerEntry&, timer::TimerWheel&) {
+                fired++;
+            });
+            std::this_thread::yield();
+        }
+    });
+    std::vector<std::thread> ths;
+    std::atomic_size_t canceled = 0;
+    for (size_t t = 0; t < threads; t++) {
+        ths.emplace_back([&, t] {
+            for (size_t i = 0; i < per_thread; i++) {
+                auto& e = entries[t * per_thread + i];
+                wheel.schedule(e, now + 1 + i % 50);
+                if (i % 3 == 0 && wheel.cancel(e)) {
+                    canceled++;
+                }
+            }
+        });
+    }
+    for (auto& th : ths) {
+        th.join();
+    }
+    while (wheel.size()) {
+        std::this_thread::yield();
+    }
+    stop = true;
+    ticker.join();
+    assert(fired + canceled == threads * per_thread);
+}
+
+// usage: timer_wheel [timers] [ticks]
+int main(int argc, char** argv) {
+    auto& cout = futils::wrap::cout_wrap();
+    check_random();
+    check_locked();
+
+    const size_t count = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    const size_t ticks = argc > 2 ? std::stoull(argv[2]) : 200;
+    constexpr std::uint64_t max_timeout = 30000;
+    const size_t resched_per_tick = count / 100;
+    std::vector<std::uint64_t> plan(count + ticks * resched_per_tick);
+    std::vector<std::uint32_t> pick(ticks * resched_per_tick);
+    std::mt19937_64 rng(1);
+    for (auto& p : plan) {
+        p = 1 + rng() % max_timeout;
+    }
+    for (auto& p : pick) {
+        p = rng() % count;
+    }
+
+    // timer wheel
+    auto entries = std::make_unique<timer::TimerEntry[]>(count);
+    size_t wheel_fired = 0;
+    futils::test::Timer t;
+    {
+        timer::TimerWheel wheel(0);
+        size_t k = 0, r = 0;
+        for (size_t i = 0; i < count; i++) {
+            wheel.schedule(entries[i], plan[k++]);
+        }
+        for (std::uint64_t now = 1; now <= ticks; now++) {
+            for (size_t i = 0; i < resched_per_tick; i++) {
+                wheel.schedule(entries[pick[r++]], now + plan[k++]);
+            }
+            wheel_fired += wheel.advance(now, [&](timer::TimerEntry& e) {});
+        }
+        for (size_t i = 0; i < count; i++) {
+            wheel.cancel(entries[i]);
+        }
+        assert(wheel.empty());
+    }
+    auto wheel_time = t.next_step<std::chrono::milliseconds>();
+
+    // ordered set (O(log n) schedule and cancel)
+    size_t set_fired = 0;
+    {
+        using Set = std::multiset<std::pair<std::uint64_t, size_t>>;
+        Set set;
+        std::vector<Set::iterator> where(count, set.end());
+        size_t k = 0, r = 0;
+        for (size_t i = 0; i < count; i++) {
+            where[i] = set.emplace(plan[k++], i);
+        }
+        for (std::uint64_t now = 1; now <= ticks; now++) {
+            for (size_t i = 0; i < resched_per_tick; i++) {
+                auto id = pick[r++];
+                if (where[id] != set.end()) {
+                    set.erase(where[id]);
+                }
+                where[id] = set.emplace(now + plan[k++], id);
+            }
+            while (!set.empty() && set.begin()->first <= now) {
+                where[set.begin()->second] = set.end();
+                set.erase(set.begin());
+                set_fired++;
+            }
+        }
+    }
+    auto set_time = t.next_step<std::chrono::milliseconds>();
+    assert(wheel_fired == set_fired);
+
+    const auto ops = count + ticks * resched_per_tick;
+    cout << count << " timers, " << ticks << " ticks, " << resched_per_tick << " reschedules/tick, " << wheel_fired << " expired\n";
+    cout << "  timer wheel: " << wheel_time.count() << "ms (" << wheel_time.count() * 1000000 / ops << "ns/op)\n";
+    cout << "  ordered set: " << set_time.count() << "ms (" << set_time.count() * 1000000 / ops << "ns/op)\n";
+}
@@ -18,7 +18,9 @@ struct Flags : futils::cmdline::templ::HelpOption {
     bool quic = false;
     bool prior_http3_alt_svc = false;
     bool single_thread = false;
+    bool sharded = false;
     bool memory_debug = false;
+    bool count_alloc = false;
     bool verbose = false;
     bool bind_public = false;
     bool no_input = false;
@@ -27,7 +29,9 @@ struct Flags : futils::cmdline::templ::HelpOption {
     futils::wrap::path_string libssl;
     futils::wrap::path_string libcrypto;
     std::string key_log;
+    std::string root;
     bool ssl = false;
+    bool ktls = false;
     void bind(futils::cmdline::option::Context& ctx) {
         bind_help(ctx);
         load_env();
@@ -39,16 +43,20 @@ struct Flags : futils::cmdline::templ::HelpOption {
         ctx.VarBool(&quic, "http3", "launch http3 server");
         ctx.VarBool(&prior_http3_alt_svc, "prior-http3-alt-svc", "prioritize http3 alt-svc than http2");
         ctx.VarBool(&single_thread, "single", "single thread mode");
+        ctx.VarBool(&sharded, "sharded", "SO_REUSEPORT listener and event loop per core (linux only)");
         ctx.VarBool(&memory_debug, "memory-debug", "add memory debug hook");
+        ctx.VarBool(&count_alloc, "count-alloc", "count allocation calls and report them per request by status command");
         ctx.VarBool(&verbose, "verbose", "verbose log");
         ctx.VarString(&public_key, "public-key", "public key file", "FILE");
         ctx.VarString(&private_key, "private-key", "private key file", "FILE");
         ctx.VarString(&libssl, "libssl", "libssl path", "FILE");
         ctx.VarString(&libcrypto, "libcrypto", "libcrypto path", "FILE");
         ctx.VarBool(&ssl, "ssl", "enable ssl");
+        ctx.VarBool(&ktls, "ktls", "offload TLS encryption of sending data to kernel if possible (linux only)");
         ctx.VarBool(&bind_public, "bind-public", "bind to public address (default: only localhost)");
         ctx.VarString(&key_log, "key-log", "key log file", "FILE");
         ctx.VarBool(&no_input, "no-input", "no input mode");
+        ctx.VarString(&root, "root", "serve static files under directory. symbolic links under it are followed (default: hello world page)", "DIR");
     }
 #ifdef _WIN32
 #define SUFFIX ".dll"
@@ -25,42 +25,170 @@
 #include <timer/to_string.h>
 #include "flags.h"
 #include <file/file_stream.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 
 namespace serv = futils::fnet::server;
 auto& cout = futils::wrap::cout_wrap();
 
+// for --count-alloc
+// counts operator new and fnet heap calls
+bool count_alloc = false;
+std::atomic_size_t alloc_count = 0;
+std::atomic_size_t request_count = 0;
+
+void* operator new(size_t size) {
+    if (count_alloc) {
+        alloc_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (auto p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+futils::fnet::Allocs counting_allocs() {
+    futils::fnet::Allocs a;
+    a.ctx = nullptr;
+    a.alloc_ptr = [](void*, size_t size, size_t, futils::fnet::DebugInfo*) {
+        alloc_count.fetch_add(1, std::memory_order_relaxed);
+        return std::malloc(size);
+    };
+    a.realloc_ptr = [](void*, void* p, size_t size, size_t, futils::fnet::DebugInfo*) {
+        alloc_count.fetch_add(1, std::memory_order_relaxed);
+        return std::realloc(p, size);
+    };
+    a.free_ptr = [](void*, void* p, futils::fnet::DebugInfo*) {
+        std::free(p);
+    };
+    return a;
+}
+
+// report allocations per request since last report
+void report_alloc() {
+    static size_t prev_alloc = 0, prev_request = 0;
+    auto allocs = alloc_count.load() - prev_alloc;
+    auto requests = request_count.load() - prev_request;
+    prev_alloc += allocs;
+    prev_request += requests;
+    cout << "allocations: " << allocs << " requests: " << requests;
+    if (requests) {
+        cout << " allocations per request: " << double(allocs) / requests;
+    }
+    cout << "\n";
+}
+
+// allocated from request scoped arena
 struct HttpRequest {
-    std::string method;
-    std::string path;
-    std::string host;
-    std::map<std::string, std::string> headers;
+    serv::arena_string method;
+    serv::arena_string path;
+    serv::arena_string host;
+    serv::arena_string range;
+    serv::arena_map<serv::arena_string, serv::arena_string> headers;
+
+    explicit HttpRequest(serv::ArenaAllocator<char> a)
+        : method(a), path(a), host(a), range(a), headers(a) {}
 };
 
 std::string alt_svc;
+// for --root
+std::string root;
+
+const char* content_type(std::string_view path) {
+    if (path.ends_with(".html") || path.ends_with(".htm")) {
+        return "text/html; charset=UTF-8";
+    }
+    if (path.ends_with(".txt")) {
+        return "text/plain; charset=UTF-8";
+    }
+    if (path.ends_with(".css")) {
+        return "text/css";
+    }
+    if (path.ends_with(".js")) {
+        return "text/javascript";
+    }
+    if (path.ends_with(".json")) {
+        return "application/json";
+    }
+    return "application/octet-stream";
+}
+
+// ".." as path segment escapes root. names like "a..b.txt" are allowed
+bool has_parent_segment(std::string_view path) {
+    while (path.size()) {
+        auto end = path.find_first_of("/\\");
+        if (path.substr(0, end) == "..") {
+            return true;
+        }
+        if (end == path.npos) {
+            break;
+        }
+        path = path.substr(end + 1);
+    }
+    return false;
+}
+
+// serve static file under root
+// symbolic links under root are followed even if they point outside of root
+void serve_file(serv::Requester& req, HttpRequest& r, serv::arena_map<serv::arena_string, serv::arena_string>& h) {
+    std::string_view path = r.path;
+    path = path.substr(0, path.find('?'));
+    if (!path.starts_with("/") || has_parent_segment(path)) {
+        req.respond(serv::StatusCode::http_bad_request, h, "bad path");
+        return;
+    }
+    serv::arena_string file_path{req.allocator()};
+    file_path.append(root);
+    file_path.append(path);
+    if (path.ends_with("/")) {
+        file_path.append("index.html");
+    }
+    auto file = futils::file::File::open(file_path);
+    if (!file || file->is_directory()) {
+        req.respond(serv::StatusCode::http_not_found, h, "not found");
+        return;
+    }
+    h.emplace("Content-Type", content_type(file_path));
+    req.respond_file(h, std::move(*file), r.range, r.method);
+}
 
 void http_serve(void*, std::shared_ptr<futils::fnet::server::Requester>&& req, futils::fnet::server::StateContext s) {
-    auto user_data = req->get_or_set_user_data<HttpRequest>([](auto&& ptr, auto&& setter) {
+    auto user_data = req->get_or_set_user_data<HttpRequest>([&](auto&& ptr, auto&& setter) {
         if (!ptr) {
-            ptr = std::make_shared<HttpRequest>();
+            ptr = std::allocate_shared<HttpRequest>(req->allocator<HttpRequest>(), req->allocator());
             setter(ptr);
         }
         return ptr;
     });
-    std::map<std::string, std::string> h;
+    serv::arena_map<serv::arena_string, serv::arena_string> h{req->allocator()};
     switch (req->http.state()) {
         case futils::fnet::http1::HTTPState::init:
         case futils::fnet::http1::HTTPState::first_line:
         case futils::fnet::http1::HTTPState::header: {
             if (auto err = req->http.read_request(
                     user_data->method, user_data->path,
-                    futils::fnet::http1::default_header_callback<std::string>([&](std::string&& key, std::string&& value) {
-                        if (futils::strutil::equal(key, "Host", futils::strutil::ignore_case())) {
-                            user_data->host = std::move(value);
-                        }
-                        else {
-                            user_data->headers.emplace(std::move(key), std::move(value));
-                        }
-                    }))) {
+                    futils::fnet::http1::default_header_callback<serv::arena_string>(
+                        [&](serv::arena_string&& key, serv::arena_string&& value) {
+                            if (futils::strutil::equal(key, "Host", futils::strutil::ignore_case())) {
+                                user_data->host = std::move(value);
+                            }
+                            else if (futils::strutil::equal(key, "Range", futils::strutil::ignore_case())) {
+                                user_data->range = std::move(value);
+                            }
+                            else {
+                                user_data->headers.emplace(std::move(key), std::move(value));
+                            }
+                        },
+                        req->allocator()))) {
                 if (futils::fnet::http::is_resumable(err)) {
                     // futils::fnet::server::wait_for_data(std::move(req), s);
                     return;
@@ -68,8 +196,8 @@ void http_serve(void*, std::shared_ptr<futils::fnet::server::Requester>&& req, f
                 s.log(serv::log_level::warn, req->addr, err);
                 return;
             }
-            if (user_data->method != "GET") {
-                req->respond(serv::StatusCode::http_bad_request, h, "only GET is allowed");
+            if (user_data->method != "GET" && user_data->method != "HEAD") {
+                req->respond(serv::StatusCode::http_bad_request, h, "only GET or HEAD is allowed");
                 return;
             }
             if (user_data->host.empty()) {
@@ -82,7 +210,7 @@ void http_serve(void*, std::shared_ptr<futils::fnet::server::Requester>&& req, f
                 return;
             }
             */
-            // here, must be GET so no body
+            // here, must be GET or HEAD so no body
             break;
         }
         default: {
@@ -90,11 +218,17 @@ void http_serve(void*, std::shared_ptr<futils::fnet::server::Requester>&& req, f
             return;
         }
     }
-    h["Content-Type"] = "text/html; charset=UTF-8";
     if (alt_svc.size()) {
-        h["Alt-Svc"] = alt_svc;
+        h.emplace("Alt-Svc", std::string_view(alt_svc));
     }
+    if (root.size()) {
+        serve_file(*req, *user_data, h);
+        request_count++;
+        return;
+    }
+    h.emplace("Content-Type", "text/html; charset=UTF-8");
     req->respond(serv::StatusCode::http_ok, h, "<h1>hello world</h1>\n");
+    request_count++;
 }
 
 std::mutex m;
@@ -161,6 +295,11 @@ int server_main(Flags& flag, futils::cmdline::option::Context& ctx) {
         futils::fnet::debug::allocs();
         futils::test::set_alloc_hook(true);
     }
+    else if (flag.count_alloc) {
+        futils::fnet::set_normal_allocs(counting_allocs());
+        futils::fnet::set_objpool_allocs(counting_allocs());
+        count_alloc = true;
+    }
     serv::HTTPServ serv;
     if (flag.libssl.size()) {
         futils::fnet::tls::set_libssl(flag.libssl.c_str());
@@ -205,6 +344,13 @@ int server_main(Flags& flag, futils::cmdline::option::Context& ctx) {
             if (flag.key_log.size()) {
                 serv.tls_config.set_key_log_callback(key_log, nullptr);
             }
+            if (flag.ktls) {
+                if (auto r = serv.tls_config.set_ktls_enabled(true); !r) {
+                    cout << "failed to enable kTLS " << r.error().error<std::string>() << "\n";
+                    return -1;
+                }
+                serv.ktls = true;
+            }
         }
         else {
             cout << "no cert specified\n";
@@ -213,6 +359,7 @@ int server_main(Flags& flag, futils::cmdline::option::Context& ctx) {
     }
     serv.next = http_serve;
     verbose = flag.verbose;
+    root = flag.root;
     auto s = std::make_shared<serv::State>(&serv, server_entry);
     s->set_log([](serv::log_level level, futils::fnet::NetAddrPort* addr, futils::fnet::error::Error& err) {
         if (!verbose && level < serv::log_level::info) {
@@ -314,6 +461,9 @@ int server_main(Flags& flag, futils::cmdline::option::Context& ctx) {
             str.pop_back();
             if (str == futils::utf::convert<futils::wrap::path_string>("status")) {
                 cout << serv::format_state<std::string>(servstate);
+                if (count_alloc) {
+                    report_alloc();
+                }
             }
             str.clear();
         }
@@ -353,11 +503,39 @@ int server_main(Flags& flag, futils::cmdline::option::Context& ctx) {
                  input_callback);
         return 0;
     }
-    if (server) {
-        s->add_accept_thread(std::move(server->first));
+    if (flag.sharded) {
+        serv::ShardConfig conf;
+        conf.pin_cpu = true;
+        conf.incoming_cpu = true;
+        auto add_shards = [&](decltype(server)& listener, bool ipv6only) {
+            // bind shards to port actually bound
+            auto addr = listener->first.get_local_addr();
+            if (addr) {
+                listener->second.addr = std::move(*addr);
+            }
+            listener->first = futils::fnet::Socket();  // port is reused by shards
+            conf.ipv6only = ipv6only;
+            auto res = s->add_sharded_listener(listener->second, conf);
+            if (!res) {
+                cout << "failed to create sharded listener " << res.error().error<std::string>() << "\n";
+                return false;
+            }
+            return true;
+        };
+        if (server && !add_shards(server, false)) {
+            return -1;
+        }
+        if (secure_server && !add_shards(secure_server, true)) {
+            return -1;
+        }
     }
-    if (secure_server) {
-        s->add_accept_thread(std::move(secure_server->first));
+    else {
+        if (server) {
+            s->add_accept_thread(std::move(server->first));
+        }
+        if (secure_server) {
+            s->add_accept_thread(std::move(secure_server->first));
+        }
     }
     while (input_callback()) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));